@@ -0,0 +1,185 @@
+#include "cdlod_quadtree.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+namespace noise
+{
+
+namespace
+{
+
+// A LOD's distance band has to be wider than the diagonal of its nodes, or LODs two apart could end up
+// neighbours. Bands double like the node sizes, so the first one decides.
+const float MinRangeToLeafSize = 3.0f;
+
+// Leaves the last 5% of a band to morph over
+const float MaxMorphStart = 0.95f;
+
+} // end unnamed namespace
+
+CdlodQuadtree::CdlodQuadtree(const CdlodSettings& settings)
+	: d_settings(settings)
+{
+	assert(settings.leafSize >= 2 && (settings.leafSize & (settings.leafSize - 1)) == 0);
+	assert(settings.lodLevels > 0 && settings.lodLevels < 16);
+
+	// Vertices of a LOD l node lie up to range(l) plus its 3D diagonal away, and a LOD l + 1 neighbour has to draw
+	// them unmorphed: its morph starts at range(l) + range(l) * morphStart. Ranges double with the node size but
+	// the height span stays, so LOD 0 needs the largest morphStart.
+	const float leaf = float(settings.leafSize) * settings.sampleSpacing;
+	const float heightSpan = settings.heightRange * settings.heightScale;
+	const float diagonal = std::sqrt(2.0f * leaf * leaf + heightSpan * heightSpan);
+	d_settings.firstRange = std::max({ settings.firstRange, MinRangeToLeafSize * leaf, diagonal / MaxMorphStart });
+	d_settings.morphStart = std::min(std::max(settings.morphStart, diagonal / d_settings.firstRange), MaxMorphStart);
+
+	d_ranges.resize(size_t(settings.lodLevels));
+	for (int lod = 0; lod < settings.lodLevels; ++lod)
+		d_ranges[size_t(lod)] = d_settings.firstRange * float(1 << lod);
+}
+
+void CdlodQuadtree::select(const HeightPyramid& pyramid, const glm::vec3& camPos, const VisibleCB& visible)
+{
+	d_patches.clear();
+	d_visited = 0;
+	d_culled = 0;
+	if (pyramid.levels() == 0)
+		return;
+
+	const int rootSize = d_settings.leafSize << (d_settings.lodLevels - 1);
+	for (int y = 0; y < pyramid.height(0); y += rootSize)
+	{
+		for (int x = 0; x < pyramid.width(0); x += rootSize)
+		{
+			// roots out of range are past the view distance
+			selectNode(pyramid, camPos, visible, x, y, d_settings.lodLevels - 1);
+		}
+	}
+}
+
+const CdlodSettings& CdlodQuadtree::settings() const
+{
+	return d_settings;
+}
+
+const std::vector<CdlodPatch>& CdlodQuadtree::patches() const
+{
+	return d_patches;
+}
+
+int CdlodQuadtree::patchQuads() const
+{
+	return d_settings.leafSize / 2;
+}
+
+int CdlodQuadtree::patchSize(int lod) const
+{
+	return patchQuads() << lod;
+}
+
+float CdlodQuadtree::range(int lod) const
+{
+	return d_ranges[size_t(lod)];
+}
+
+void CdlodQuadtree::morphRange(int lod, float& start, float& end) const
+{
+	const float previous = lod > 0 ? range(lod - 1) : 0.0f;
+	end = range(lod);
+	start = previous + (end - previous) * d_settings.morphStart;
+}
+
+int CdlodQuadtree::visitedNodes() const
+{
+	return d_visited;
+}
+
+int CdlodQuadtree::culledNodes() const
+{
+	return d_culled;
+}
+
+bool CdlodQuadtree::selectNode(const HeightPyramid& pyramid, const glm::vec3& camPos, const VisibleCB& visible, int x, int y, int lod)
+{
+	// nothing to draw past the map, and nothing for the parent to fill in either
+	if (x >= pyramid.width(0) || y >= pyramid.height(0))
+		return true;
+
+	d_visited++;
+	const int size = d_settings.leafSize << lod;
+	// the patch meshes reach the first sample of the next node
+	const HeightBounds bounds = pyramid.regionBounds(x, y, size + 1, size + 1);
+	const float distSq = distanceSq(camPos, x, y, size, bounds);
+	if (distSq > range(lod) * range(lod))
+		return false;
+
+	// handled, the parent must not draw it either
+	if (!isVisible(visible, x, y, size, bounds))
+	{
+		d_culled++;
+		return true;
+	}
+
+	const int half = size / 2;
+	if (lod == 0 || distSq > range(lod - 1) * range(lod - 1))
+	{
+		addQuarter(pyramid, visible, x, y, lod);
+		addQuarter(pyramid, visible, x + half, y, lod);
+		addQuarter(pyramid, visible, x, y + half, lod);
+		addQuarter(pyramid, visible, x + half, y + half, lod);
+		return true;
+	}
+
+	// children out of the finer range are drawn at this LOD
+	for (int child = 0; child < 4; ++child)
+	{
+		const int cx = x + (child & 1) * half;
+		const int cy = y + (child >> 1) * half;
+		if (!selectNode(pyramid, camPos, visible, cx, cy, lod - 1))
+			addQuarter(pyramid, visible, cx, cy, lod);
+	}
+	return true;
+}
+
+void CdlodQuadtree::addQuarter(const HeightPyramid& pyramid, const VisibleCB& visible, int x, int y, int lod)
+{
+	if (x >= pyramid.width(0) || y >= pyramid.height(0))
+		return;
+
+	const int size = patchSize(lod);
+	CdlodPatch patch;
+	patch.x = x;
+	patch.y = y;
+	patch.lod = lod;
+	patch.bounds = pyramid.regionBounds(x, y, size + 1, size + 1);
+	if (!isVisible(visible, x, y, size, patch.bounds))
+	{
+		d_culled++;
+		return;
+	}
+	d_patches.push_back(patch);
+}
+
+bool CdlodQuadtree::isVisible(const VisibleCB& visible, int x, int y, int size, const HeightBounds& bounds) const
+{
+	if (!visible)
+		return true;
+
+	const float spacing = d_settings.sampleSpacing;
+	const float scale = d_settings.heightScale;
+	const glm::vec3 min(float(x) * spacing, bounds.min * scale, float(y) * spacing);
+	const glm::vec3 max(float(x + size) * spacing, bounds.max * scale, float(y + size) * spacing);
+	return visible(min, max);
+}
+
+float CdlodQuadtree::distanceSq(const glm::vec3& camPos, int x, int y, int size, const HeightBounds& bounds) const
+{
+	const float spacing = d_settings.sampleSpacing;
+	const float scale = d_settings.heightScale;
+	const float dx = std::max(std::max(float(x) * spacing - camPos.x, camPos.x - float(x + size) * spacing), 0.0f);
+	const float dz = std::max(std::max(float(y) * spacing - camPos.z, camPos.z - float(y + size) * spacing), 0.0f);
+	const float dy = std::max(std::max(bounds.min * scale - camPos.y, camPos.y - bounds.max * scale), 0.0f);
+	return dx * dx + dy * dy + dz * dz;
+}
+
+} // end namespace noise
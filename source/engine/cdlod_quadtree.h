@@ -0,0 +1,85 @@
+#pragma once
+#include "height_pyramid.h"
+#include <glm/vec3.hpp>
+#include <functional>
+#include <vector>
+
+namespace noise
+{
+
+struct CdlodSettings
+{
+	int leafSize = 32;          // samples along a leaf node side, a power of two
+	int lodLevels = 6;          // a root node is leafSize << (lodLevels - 1) samples
+	float firstRange = 128.0f;  // world distance LOD 0 reaches, every further LOD doubles it
+	float morphStart = 0.7f;    // fraction of a LOD's distance band drawn unmorphed
+	float sampleSpacing = 1.0f; // world units between heightmap samples along x and z
+	float heightScale = 1.0f;   // world units per height unit
+	float heightRange = 2.0f;   // height units from the lowest to the highest sample, FastNoiseLite spans [-1, 1]
+};
+
+// A square of the heightmap to draw with the shared patch mesh: patchQuads() x patchQuads() quads at a spacing
+// of 2^lod samples, (x, y) being its lower corner in samples
+struct CdlodPatch
+{
+	int x = 0;
+	int y = 0;
+	int lod = 0;
+	HeightBounds bounds;
+};
+
+// CDLOD quadtree selection (Strugar 2010) over the samples of a HeightPyramid. A node of LOD l is drawn when it
+// is within the distance range of l but not entirely within that of l - 1, otherwise its children are selected,
+// and quarters of it that no child covers are drawn at l. Node bounds come from the pyramid's min and max levels,
+// so the walk only descends into nodes in range and costs O(selected nodes), not O(map size).
+//
+// Every selected node is handed out as its four quarters, which keeps a single patch mesh for whole nodes and
+// leftover quarters alike. In the outer part of each range the vertex shader morphs odd vertices onto their even
+// neighbours (see morphRange()), reaching the next LOD's grid exactly at the range end, so neighbours one LOD
+// apart meet without cracks. That takes the coarser side to start morphing only past the finer nodes' reach, the
+// constructor raises morphStart (and firstRange if need be) until it does.
+class CdlodQuadtree
+{
+public:
+	// Whether a world space box can be seen, typically a frustum test
+	using VisibleCB = std::function<bool(const glm::vec3& min, const glm::vec3& max)>;
+
+	explicit CdlodQuadtree(const CdlodSettings& settings);
+	~CdlodQuadtree() = default;
+	CdlodQuadtree(const CdlodQuadtree&) = delete;
+	CdlodQuadtree(CdlodQuadtree&&) = delete;
+	void operator=(const CdlodQuadtree&) = delete;
+	void operator=(CdlodQuadtree&&) = delete;
+
+	// camPos in world units; the map covers [0, width * sampleSpacing) x [0, height * sampleSpacing) in x and z.
+	// Nodes visible rejects are dropped with their whole subtree, so the walk only touches the visible ones.
+	void select(const HeightPyramid& pyramid, const glm::vec3& camPos, const VisibleCB& visible = {});
+
+	[[nodiscard]] const CdlodSettings& settings() const;
+	[[nodiscard]] const std::vector<CdlodPatch>& patches() const;
+	[[nodiscard]] int patchQuads() const;
+	// Samples along a patch side at a LOD
+	[[nodiscard]] int patchSize(int lod) const;
+	// Distance a LOD reaches, the last one bounds the view distance
+	[[nodiscard]] float range(int lod) const;
+	// World distances over which a LOD's vertices morph into the next coarser grid
+	void morphRange(int lod, float& start, float& end) const;
+	// Nodes the last select() looked at, and nodes or quarters it dropped as not visible
+	[[nodiscard]] int visitedNodes() const;
+	[[nodiscard]] int culledNodes() const;
+
+private:
+	CdlodSettings d_settings;
+	std::vector<float> d_ranges;
+	std::vector<CdlodPatch> d_patches;
+	int d_visited = 0;
+	int d_culled = 0;
+
+	// HELPERS
+	bool selectNode(const HeightPyramid& pyramid, const glm::vec3& camPos, const VisibleCB& visible, int x, int y, int lod);
+	void addQuarter(const HeightPyramid& pyramid, const VisibleCB& visible, int x, int y, int lod);
+	bool isVisible(const VisibleCB& visible, int x, int y, int size, const HeightBounds& bounds) const;
+	float distanceSq(const glm::vec3& camPos, int x, int y, int size, const HeightBounds& bounds) const;
+};
+
+} // end namespace noise
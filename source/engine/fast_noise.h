@@ -51,9 +51,16 @@
 #define FASTNOISELITE_H
 
 #include <cmath>
+#include <cstddef>
+#include <vector>
+
+namespace noise { namespace detail { struct FastNoiseLiteAccess; } }
 
 class FastNoiseLite
 {
+    // Lets the engine's vectorized generators read settings and lookup tables
+    friend struct noise::detail::FastNoiseLiteAccess;
+
 public:
     enum NoiseType
     {
@@ -393,6 +400,531 @@ public:
         }
     }
 
+
+    /// <summary>
+    /// 2D noise over a uniform grid using current settings
+    /// </summary>
+    /// <remarks>
+    /// Writes xSize * ySize values to noiseOut, x major.
+    /// Value (x, y) equals GetNoise((xStart + x) * step, (yStart + y) * step).
+    /// Runs the Specialized pipeline matching the current settings
+    /// </remarks>
+    void GenUniformGrid2D(float* noiseOut, int xStart, int yStart, int xSize, int ySize, float step = 1.0f)
+    {
+        GetSpecializedPipeline().UniformGrid2D(*this, noiseOut, xStart, yStart, xSize, ySize, step);
+    }
+
+    /// <summary>
+    /// 2D noise over a uniform grid using current settings, lattice points hashed once per octave
+    /// </summary>
+    /// <remarks>
+    /// Same output as GenUniformGrid2D. For OpenSimplex2, Perlin and ValueCubic the gradients (values) of every
+    /// lattice point the grid touches are gathered into a small table per octave first, samples then index it
+    /// instead of hashing their corners. Meant for tiles at low frequency where many samples share a cell.
+    /// Octaves whose table would hold more points than the grid has samples, and other noise types, hash per sample
+    /// </remarks>
+    void GenUniformGrid2DLattice(float* noiseOut, int xStart, int yStart, int xSize, int ySize, float step = 1.0f)
+    {
+        if (!HasLatticeTables() || xSize <= 0 || ySize <= 0)
+        {
+            GenUniformGrid2D(noiseOut, xStart, yStart, xSize, ySize, step);
+            return;
+        }
+
+        int octaves = GetOctaveLayerCount();
+        std::vector<LatticeTable> tables(octaves > 0 ? octaves : 1);
+        std::vector<float> values;
+        BuildLatticeTables(tables, values, xStart, yStart, xSize, ySize, step);
+
+        switch (mNoiseType)
+        {
+        case NoiseType_OpenSimplex2:
+            LatticeGrid2D<NoiseType_OpenSimplex2>(noiseOut, tables.data(), values.data(), xStart, yStart, xSize, ySize, step);
+            break;
+        case NoiseType_Perlin:
+            LatticeGrid2D<NoiseType_Perlin>(noiseOut, tables.data(), values.data(), xStart, yStart, xSize, ySize, step);
+            break;
+        default:
+            LatticeGrid2D<NoiseType_ValueCubic>(noiseOut, tables.data(), values.data(), xStart, yStart, xSize, ySize, step);
+            break;
+        }
+    }
+
+    /// <summary>
+    /// 3D noise over a uniform grid using current settings
+    /// </summary>
+    /// <remarks>
+    /// Writes xSize * ySize * zSize values to noiseOut, x major then y.
+    /// Value (x, y, z) equals GetNoise((xStart + x) * step, (yStart + y) * step, (zStart + z) * step).
+    /// Runs the Specialized pipeline matching the current settings
+    /// </remarks>
+    void GenUniformGrid3D(float* noiseOut, int xStart, int yStart, int zStart, int xSize, int ySize, int zSize, float step = 1.0f)
+    {
+        GetSpecializedPipeline().UniformGrid3D(*this, noiseOut, xStart, yStart, zStart, xSize, ySize, zSize, step);
+    }
+
+
+    /// <summary>
+    /// 2D noise and its partial derivatives at given position using current settings
+    /// </summary>
+    /// <remarks>
+    /// Derivatives are with respect to x and y as passed in, frequency and fractal octaves included.
+    /// Analytic for OpenSimplex2, Perlin and Value noise, where the returned value equals GetNoise(x, y).
+    /// Other noise types fall back to central differences of GetNoise
+    /// </remarks>
+    /// <returns>
+    /// Noise output bounded between -1...1
+    /// </returns>
+    template <typename FNfloat>
+    float GetNoiseWithDerivatives(FNfloat x, FNfloat y, float* dx, float* dy)
+    {
+        Arguments_must_be_floating_point_values<FNfloat>();
+
+        float ddx, ddy;
+        float noise = HasAnalyticDerivatives() ?
+            GenNoiseWithDerivatives(x, y, ddx, ddy) :
+            GenNoiseWithCentralDifferences(x, y, ddx, ddy);
+
+        if (dx) *dx = ddx;
+        if (dy) *dy = ddy;
+        return noise;
+    }
+
+    /// <summary>
+    /// 2D noise with surface normals over a uniform grid using current settings
+    /// </summary>
+    /// <remarks>
+    /// Writes 4 floats per sample to noiseOut, x major: height, then the normal of the surface
+    /// (x, height * heightScale, y) as nx, ny, nz, with y up.
+    /// heightScale is the world height of one noise unit over the world distance of one input unit.
+    /// Height (x, y) equals GetNoise((xStart + x) * step, (yStart + y) * step) for noise types with analytic derivatives
+    /// </remarks>
+    void GenUniformGrid2DWithNormals(float* noiseOut, int xStart, int yStart, int xSize, int ySize, float step = 1.0f, float heightScale = 1.0f)
+    {
+        const bool analytic = HasAnalyticDerivatives();
+
+        for (int yi = 0; yi < ySize; yi++)
+        {
+            float y = (float)(yStart + yi) * step;
+
+            for (int xi = 0; xi < xSize; xi++)
+            {
+                float x = (float)(xStart + xi) * step;
+
+                float dx, dy;
+                float noise = analytic ?
+                    GenNoiseWithDerivatives(x, y, dx, dy) :
+                    GenNoiseWithCentralDifferences(x, y, dx, dy);
+
+                float nx = -dx * heightScale;
+                float nz = -dy * heightScale;
+                float invLength = 1 / FastSqrt(nx * nx + 1 + nz * nz);
+
+                *noiseOut++ = noise;
+                *noiseOut++ = nx * invLength;
+                *noiseOut++ = invLength;
+                *noiseOut++ = nz * invLength;
+            }
+        }
+    }
+
+
+    /// <summary>
+    /// Number of octave layers GetNoise combines with the current fractal settings
+    /// </summary>
+    /// <returns>
+    /// Octave count for FBm, Ridged and PingPong, 1 otherwise
+    /// </returns>
+    int GetOctaveLayerCount() const
+    {
+        switch (mFractalType)
+        {
+        case FractalType_FBm:
+        case FractalType_Ridged:
+        case FractalType_PingPong:
+            return mOctaves;
+        default:
+            return 1;
+        }
+    }
+
+    /// <summary>
+    /// 2D octave layers over a uniform grid, the unweighted single noise each fractal octave samples
+    /// </summary>
+    /// <remarks>
+    /// Writes octaves firstOctave...firstOctave + octaveCount - 1, layer o at layersOut + (o - firstOctave) * layerStride,
+    /// each xSize * ySize values, x major, same grid as GenUniformGrid2D.
+    /// Layers only depend on seed, frequency, lacunarity and the noise type settings,
+    /// CombineOctaveLayers turns them into GetNoise output for any fractal type, gain or weighted strength
+    /// </remarks>
+    void GenOctaveLayers2D(float* layersOut, size_t layerStride, int firstOctave, int octaveCount,
+                           int xStart, int yStart, int xSize, int ySize, float step = 1.0f)
+    {
+        const bool skew = mNoiseType == NoiseType_OpenSimplex2 || mNoiseType == NoiseType_OpenSimplex2S;
+        const float frequency = mFrequency;
+        const float SQRT3 = 1.7320508075688772935274463415059f;
+        const float F2 = 0.5f * (SQRT3 - 1);
+
+        for (int yi = 0; yi < ySize; yi++)
+        {
+            float yCoord = (float)(yStart + yi) * step * frequency;
+
+            for (int xi = 0; xi < xSize; xi++)
+            {
+                float x = (float)(xStart + xi) * step * frequency;
+                float y = yCoord;
+
+                if (skew)
+                {
+                    float t = (x + y) * F2;
+                    x += t;
+                    y += t;
+                }
+
+                // Lacunarity is applied once per octave like the fractal loops, so the coordinates match bit for bit
+                size_t index = (size_t)yi * xSize + xi;
+                for (int o = 0; o < firstOctave + octaveCount; o++)
+                {
+                    if (o >= firstOctave)
+                        layersOut[(size_t)(o - firstOctave) * layerStride + index] = GenNoiseSingle(mSeed + o, x, y);
+
+                    x *= mLacunarity;
+                    y *= mLacunarity;
+                }
+            }
+        }
+    }
+
+    /// <summary>
+    /// Weights octave layers from GenOctaveLayers2D with the current fractal settings
+    /// </summary>
+    /// <remarks>
+    /// layers holds GetOctaveLayerCount() layers layerStride floats apart, starting at octave 0.
+    /// Writes count values to noiseOut, equal to GetNoise at the sampled positions
+    /// </remarks>
+    void CombineOctaveLayers(const float* layers, size_t layerStride, float* noiseOut, size_t count) const
+    {
+        if (mFractalType != FractalType_FBm && mFractalType != FractalType_Ridged && mFractalType != FractalType_PingPong)
+        {
+            for (size_t i = 0; i < count; i++)
+                noiseOut[i] = layers[i];
+            return;
+        }
+
+        for (size_t i = 0; i < count; i++)
+        {
+            float sum = 0;
+            float amp = mFractalBounding;
+
+            for (int o = 0; o < mOctaves; o++)
+            {
+                float single = layers[(size_t)o * layerStride + i];
+                float noise;
+
+                // Same operation order as GenFractalFBm/Ridged/PingPong in 2D
+                switch (mFractalType)
+                {
+                default:
+                    noise = single;
+                    sum += noise * amp;
+                    amp *= Lerp(1.0f, FastMin(noise + 1, 2) * 0.5f, mWeightedStrength);
+                    break;
+                case FractalType_Ridged:
+                    noise = FastAbs(single);
+                    sum += (noise * -2 + 1) * amp;
+                    amp *= Lerp(1.0f, 1 - noise, mWeightedStrength);
+                    break;
+                case FractalType_PingPong:
+                    noise = PingPong((single + 1) * mPingPongStength);
+                    sum += (noise - 0.5f) * 2 * amp;
+                    amp *= Lerp(1.0f, noise, mWeightedStrength);
+                    break;
+                }
+
+                amp *= mGain;
+            }
+
+            noiseOut[i] = sum;
+        }
+    }
+
+    /// <summary>
+    /// Noise pipeline with the noise type, fractal type and optionally the octave count fixed at compile time
+    /// </summary>
+    /// <remarks>
+    /// Removes the per octave noise type switch so the basis function inlines into the octave loop,
+    /// with Octaves > 0 the loop has a constant trip count and can be unrolled (Octaves = 0 reads it from the settings).
+    /// Everything else, including the fractal bounding, is read from the FastNoiseLite the functor is created from.
+    /// Output equals GetNoise as long as those settings match the template arguments
+    /// </remarks>
+    /// <example>
+    /// <code>FastNoiseLite::Specialized&lt;FastNoiseLite::NoiseType_OpenSimplex2, FastNoiseLite::FractalType_FBm, 5&gt; fbm(noise);
+    /// float height = fbm(x, y);</code>
+    /// </example>
+    template <NoiseType Noise, FractalType Fractal, int Octaves = 0>
+    class Specialized
+    {
+    public:
+        explicit Specialized(FastNoiseLite& noise) :
+            mNoise(noise),
+            mSeed(noise.mSeed),
+            mOctaves(Octaves > 0 ? Octaves : noise.mOctaves),
+            mLacunarity(noise.mLacunarity),
+            mGain(noise.mGain),
+            mWeightedStrength(noise.mWeightedStrength),
+            mPingPongStrength(noise.mPingPongStength),
+            mFractalBounding(noise.mFractalBounding)
+        { }
+
+        /// <summary>
+        /// 2D noise at given position, same as GetNoise(x, y)
+        /// </summary>
+        float operator()(float x, float y) const
+        {
+            x *= mNoise.mFrequency;
+            y *= mNoise.mFrequency;
+
+            if (Skew2D)
+            {
+                const float SQRT3 = 1.7320508075688772935274463415059f;
+                const float F2 = 0.5f * (SQRT3 - 1);
+                float t = (x + y) * F2;
+                x += t;
+                y += t;
+            }
+
+            return Transformed(x, y);
+        }
+
+        /// <summary>
+        /// 3D noise at given position, same as GetNoise(x, y, z)
+        /// </summary>
+        float operator()(float x, float y, float z) const
+        {
+            mNoise.TransformNoiseCoordinate(x, y, z);
+
+            return Transformed(x, y, z);
+        }
+
+        /// <summary>
+        /// Same as FastNoiseLite::GenUniformGrid2D
+        /// </summary>
+        void GenUniformGrid2D(float* noiseOut, int xStart, int yStart, int xSize, int ySize, float step = 1.0f) const
+        {
+            mNoise.UniformGridLoop2D<Skew2D>(noiseOut, xStart, yStart, xSize, ySize, step, [this](float x, float y)
+            {
+                return Transformed(x, y);
+            });
+        }
+
+        /// <summary>
+        /// Same as FastNoiseLite::GenUniformGrid3D
+        /// </summary>
+        void GenUniformGrid3D(float* noiseOut, int xStart, int yStart, int zStart, int xSize, int ySize, int zSize, float step = 1.0f) const
+        {
+            mNoise.UniformGridLoop3D(noiseOut, xStart, yStart, zStart, xSize, ySize, zSize, step, [this](float x, float y, float z)
+            {
+                return Transformed(x, y, z);
+            });
+        }
+
+        // Free function entry points, see SpecializedPipeline
+
+        static float Noise2D(FastNoiseLite& noise, float x, float y)
+        {
+            return Specialized(noise)(x, y);
+        }
+
+        static float Noise3D(FastNoiseLite& noise, float x, float y, float z)
+        {
+            return Specialized(noise)(x, y, z);
+        }
+
+        static void UniformGrid2D(FastNoiseLite& noise, float* noiseOut, int xStart, int yStart, int xSize, int ySize, float step)
+        {
+            Specialized(noise).GenUniformGrid2D(noiseOut, xStart, yStart, xSize, ySize, step);
+        }
+
+        static void UniformGrid3D(FastNoiseLite& noise, float* noiseOut, int xStart, int yStart, int zStart, int xSize, int ySize, int zSize, float step)
+        {
+            Specialized(noise).GenUniformGrid3D(noiseOut, xStart, yStart, zStart, xSize, ySize, zSize, step);
+        }
+
+    private:
+        static const bool Skew2D = Noise == NoiseType_OpenSimplex2 || Noise == NoiseType_OpenSimplex2S;
+
+        FastNoiseLite& mNoise;
+        const int mSeed;
+        const int mOctaves;
+        const float mLacunarity;
+        const float mGain;
+        const float mWeightedStrength;
+        const float mPingPongStrength;
+        const float mFractalBounding;
+
+        // Switches on template arguments only, folded at compile time
+
+        float Single(int seed, float x, float y) const
+        {
+            switch (Noise)
+            {
+            case NoiseType_OpenSimplex2:
+                return mNoise.SingleSimplex(seed, x, y);
+            case NoiseType_OpenSimplex2S:
+                return mNoise.SingleOpenSimplex2S(seed, x, y);
+            case NoiseType_Cellular:
+                return mNoise.SingleCellular(seed, x, y);
+            case NoiseType_Perlin:
+                return mNoise.SinglePerlin(seed, x, y);
+            case NoiseType_ValueCubic:
+                return mNoise.SingleValueCubic(seed, x, y);
+            case NoiseType_Value:
+                return mNoise.SingleValue(seed, x, y);
+            default:
+                return 0;
+            }
+        }
+
+        float Single(int seed, float x, float y, float z) const
+        {
+            switch (Noise)
+            {
+            case NoiseType_OpenSimplex2:
+                return mNoise.SingleOpenSimplex2(seed, x, y, z);
+            case NoiseType_OpenSimplex2S:
+                return mNoise.SingleOpenSimplex2S(seed, x, y, z);
+            case NoiseType_Cellular:
+                return mNoise.SingleCellular(seed, x, y, z);
+            case NoiseType_Perlin:
+                return mNoise.SinglePerlin(seed, x, y, z);
+            case NoiseType_ValueCubic:
+                return mNoise.SingleValueCubic(seed, x, y, z);
+            case NoiseType_Value:
+                return mNoise.SingleValue(seed, x, y, z);
+            default:
+                return 0;
+            }
+        }
+
+        // Same operation order as GenFractalFBm/Ridged/PingPong
+
+        float Transformed(float x, float y) const
+        {
+            if (Fractal != FractalType_FBm && Fractal != FractalType_Ridged && Fractal != FractalType_PingPong)
+                return Single(mSeed, x, y);
+
+            int seed = mSeed;
+            float sum = 0;
+            float amp = mFractalBounding;
+
+            for (int i = 0; i < (Octaves > 0 ? Octaves : mOctaves); i++)
+            {
+                float noise;
+                switch (Fractal)
+                {
+                default:
+                    noise = Single(seed++, x, y);
+                    sum += noise * amp;
+                    amp *= Lerp(1.0f, FastMin(noise + 1, 2) * 0.5f, mWeightedStrength);
+                    break;
+                case FractalType_Ridged:
+                    noise = FastAbs(Single(seed++, x, y));
+                    sum += (noise * -2 + 1) * amp;
+                    amp *= Lerp(1.0f, 1 - noise, mWeightedStrength);
+                    break;
+                case FractalType_PingPong:
+                    noise = PingPong((Single(seed++, x, y) + 1) * mPingPongStrength);
+                    sum += (noise - 0.5f) * 2 * amp;
+                    amp *= Lerp(1.0f, noise, mWeightedStrength);
+                    break;
+                }
+
+                x *= mLacunarity;
+                y *= mLacunarity;
+                amp *= mGain;
+            }
+
+            return sum;
+        }
+
+        float Transformed(float x, float y, float z) const
+        {
+            if (Fractal != FractalType_FBm && Fractal != FractalType_Ridged && Fractal != FractalType_PingPong)
+                return Single(mSeed, x, y, z);
+
+            int seed = mSeed;
+            float sum = 0;
+            float amp = mFractalBounding;
+
+            for (int i = 0; i < (Octaves > 0 ? Octaves : mOctaves); i++)
+            {
+                float noise;
+                switch (Fractal)
+                {
+                default:
+                    noise = Single(seed++, x, y, z);
+                    sum += noise * amp;
+                    amp *= Lerp(1.0f, (noise + 1) * 0.5f, mWeightedStrength);
+                    break;
+                case FractalType_Ridged:
+                    noise = FastAbs(Single(seed++, x, y, z));
+                    sum += (noise * -2 + 1) * amp;
+                    amp *= Lerp(1.0f, 1 - noise, mWeightedStrength);
+                    break;
+                case FractalType_PingPong:
+                    noise = PingPong((Single(seed++, x, y, z) + 1) * mPingPongStrength);
+                    sum += (noise - 0.5f) * 2 * amp;
+                    amp *= Lerp(1.0f, noise, mWeightedStrength);
+                    break;
+                }
+
+                x *= mLacunarity;
+                y *= mLacunarity;
+                z *= mLacunarity;
+                amp *= mGain;
+            }
+
+            return sum;
+        }
+    };
+
+    /// <summary>
+    /// Specialized entry points for one combination of noise type, fractal type and octave count
+    /// </summary>
+    struct SpecializedPipeline
+    {
+        float (*Noise2D)(FastNoiseLite& noise, float x, float y);
+        float (*Noise3D)(FastNoiseLite& noise, float x, float y, float z);
+        void (*UniformGrid2D)(FastNoiseLite& noise, float* noiseOut, int xStart, int yStart, int xSize, int ySize, float step);
+        void (*UniformGrid3D)(FastNoiseLite& noise, float* noiseOut, int xStart, int yStart, int zStart, int xSize, int ySize, int zSize, float step);
+    };
+
+    /// <summary>
+    /// Maps the current noise type, fractal type and octave count to the matching Specialized instantiation
+    /// </summary>
+    /// <remarks>
+    /// FBm with 1 to 8 octaves gets an unrolled pipeline, everything else uses the runtime octave count.
+    /// The pipeline reads settings when called, resolve it again after changing noise type, fractal type or octaves
+    /// </remarks>
+    SpecializedPipeline GetSpecializedPipeline() const
+    {
+        switch (mNoiseType)
+        {
+        default:
+            return SelectSpecializedFractal<NoiseType_OpenSimplex2>();
+        case NoiseType_OpenSimplex2S:
+            return SelectSpecializedFractal<NoiseType_OpenSimplex2S>();
+        case NoiseType_Cellular:
+            return SelectSpecializedFractal<NoiseType_Cellular>();
+        case NoiseType_Perlin:
+            return SelectSpecializedFractal<NoiseType_Perlin>();
+        case NoiseType_ValueCubic:
+            return SelectSpecializedFractal<NoiseType_ValueCubic>();
+        case NoiseType_Value:
+            return SelectSpecializedFractal<NoiseType_Value>();
+        }
+    }
+
 private:
     template <typename T>
     struct Arguments_must_be_floating_point_values;
@@ -458,6 +990,10 @@ private:
 
     static float InterpQuintic(float t) { return t * t * t * (t * (t * 6 - 15) + 10); }
 
+    static float InterpHermiteDerivative(float t) { return 6 * t * (1 - t); }
+
+    static float InterpQuinticDerivative(float t) { return 30 * t * t * (t * (t - 2) + 1); }
+
     static float CubicLerp(float a, float b, float c, float d, float t)
     {
         float p = (d - c) - (a - b);
@@ -726,6 +1262,46 @@ private:
         }
     }
 
+    // Same as the 3D TransformNoiseCoordinate minus frequency, with the transform fixed at compile time
+    template <TransformType3D Transform>
+    static void TransformNoiseCoordinateFixed(float& x, float& y, float& z)
+    {
+        switch (Transform)
+        {
+        case TransformType3D_ImproveXYPlanes:
+        {
+            float xy = x + y;
+            float s2 = xy * -(float)0.211324865405187;
+            z *= (float)0.577350269189626;
+            x += s2 - z;
+            y = y + s2 - z;
+            z += xy * (float)0.577350269189626;
+        }
+        break;
+        case TransformType3D_ImproveXZPlanes:
+        {
+            float xz = x + z;
+            float s2 = xz * -(float)0.211324865405187;
+            y *= (float)0.577350269189626;
+            x += s2 - y;
+            z += s2 - y;
+            y += xz * (float)0.577350269189626;
+        }
+        break;
+        case TransformType3D_DefaultOpenSimplex2:
+        {
+            const float R3 = (float)(2.0 / 3.0);
+            float r = (x + y + z) * R3; // Rotation, not skew
+            x = r - x;
+            y = r - y;
+            z = r - z;
+        }
+        break;
+        default:
+            break;
+        }
+    }
+
     void UpdateTransformType3D()
     {
         switch (mRotationType3D)
@@ -977,6 +1553,752 @@ private:
     }
 
 
+    // Lattice Tables
+
+    // Gradients (2 floats) or values (1 float) of the lattice points x0...x0 + width - 1, y0...y0 + height - 1, row major
+    struct LatticeTable
+    {
+        int x0 = 0;
+        int y0 = 0;
+        int width = 0;
+        int height = 0;
+        size_t offset = 0;
+        bool hashed = true; // no table, hash per sample
+    };
+
+    bool HasLatticeTables() const
+    {
+        return mNoiseType == NoiseType_OpenSimplex2 || mNoiseType == NoiseType_Perlin || mNoiseType == NoiseType_ValueCubic;
+    }
+
+    void BuildLatticeTables(std::vector<LatticeTable>& tables, std::vector<float>& values, int xStart, int yStart, int xSize, int ySize, float step)
+    {
+        const float SQRT3 = 1.7320508075688772935274463415059f;
+        const float F2 = 0.5f * (SQRT3 - 1);
+        const bool cubic = mNoiseType == NoiseType_ValueCubic;
+        const int stride = cubic ? 1 : 2;
+        const long long samples = (long long)xSize * ySize;
+
+        // Every coordinate step is monotonic in the grid index, so the grid corners bound the cells of all samples
+        float cx[4], cy[4];
+        for (int c = 0; c < 4; c++)
+        {
+            cx[c] = (float)(xStart + ((c & 1) ? xSize - 1 : 0)) * step * mFrequency;
+            cy[c] = (float)(yStart + ((c & 2) ? ySize - 1 : 0)) * step * mFrequency;
+
+            if (mNoiseType == NoiseType_OpenSimplex2)
+            {
+                float t = (cx[c] + cy[c]) * F2;
+                cx[c] += t;
+                cy[c] += t;
+            }
+        }
+
+        for (size_t o = 0; o < tables.size(); o++)
+        {
+            int xMin = FastFloor(cx[0]), xMax = xMin;
+            int yMin = FastFloor(cy[0]), yMax = yMin;
+            for (int c = 1; c < 4; c++)
+            {
+                int xc = FastFloor(cx[c]);
+                int yc = FastFloor(cy[c]);
+                xMin = xc < xMin ? xc : xMin;
+                xMax = xc > xMax ? xc : xMax;
+                yMin = yc < yMin ? yc : yMin;
+                yMax = yc > yMax ? yc : yMax;
+            }
+
+            // Cubic reads cells -1...+2 around the sample, the gradient noises 0...+1
+            LatticeTable& table = tables[o];
+            long long width = (long long)xMax - xMin + (cubic ? 4 : 2);
+            long long height = (long long)yMax - yMin + (cubic ? 4 : 2);
+
+            table.hashed = width * height > samples;
+            if (!table.hashed)
+            {
+                table.x0 = xMin - (cubic ? 1 : 0);
+                table.y0 = yMin - (cubic ? 1 : 0);
+                table.width = (int)width;
+                table.height = (int)height;
+                table.offset = values.size();
+                values.resize(values.size() + (size_t)(width * height) * stride);
+                FillLatticeTable(table, mSeed + (int)o, values.data() + table.offset);
+            }
+
+            for (int c = 0; c < 4; c++)
+            {
+                cx[c] *= mLacunarity;
+                cy[c] *= mLacunarity;
+            }
+        }
+    }
+
+    void FillLatticeTable(const LatticeTable& table, int seed, float* out) const
+    {
+        int yPrimed = table.y0 * PrimeY;
+        for (int y = 0; y < table.height; y++, yPrimed += PrimeY)
+        {
+            int xPrimed = table.x0 * PrimeX;
+            for (int x = 0; x < table.width; x++, xPrimed += PrimeX)
+            {
+                if (mNoiseType == NoiseType_ValueCubic)
+                {
+                    *out++ = ValCoord(seed, xPrimed, yPrimed);
+                }
+                else
+                {
+                    // Same gradient GradCoord picks
+                    int hash = Hash(seed, xPrimed, yPrimed);
+                    hash ^= hash >> 15;
+                    hash &= 127 << 1;
+
+                    *out++ = Lookup<float>::Gradients2D[hash];
+                    *out++ = Lookup<float>::Gradients2D[hash | 1];
+                }
+            }
+        }
+    }
+
+    // First entry of lattice point (i, j)
+    static const float* LatticeAt(const LatticeTable& table, const float* values, int i, int j, int stride)
+    {
+        return values + table.offset + ((size_t)(j - table.y0) * table.width + (i - table.x0)) * stride;
+    }
+
+    static float LatticeGrad(const float* g, float xd, float yd)
+    {
+        return xd * g[0] + yd * g[1];
+    }
+
+    // SingleSimplex, SinglePerlin and SingleValueCubic with GradCoord/ValCoord read from the table
+
+    static float LatticeSimplex(const LatticeTable& table, const float* values, float x, float y)
+    {
+        const float SQRT3 = 1.7320508075688772935274463415059f;
+        const float G2 = (3 - SQRT3) / 6;
+
+        int i = FastFloor(x);
+        int j = FastFloor(y);
+        float xi = (float)(x - i);
+        float yi = (float)(y - j);
+
+        float t = (xi + yi) * G2;
+        float x0 = (float)(xi - t);
+        float y0 = (float)(yi - t);
+
+        const float* g = LatticeAt(table, values, i, j, 2);
+        const int row = table.width * 2;
+
+        float n0, n1, n2;
+
+        float a = 0.5f - x0 * x0 - y0 * y0;
+        if (a <= 0) n0 = 0;
+        else
+        {
+            n0 = (a * a) * (a * a) * LatticeGrad(g, x0, y0);
+        }
+
+        float c = (float)(2 * (1 - 2 * G2) * (1 / G2 - 2)) * t + ((float)(-2 * (1 - 2 * G2) * (1 - 2 * G2)) + a);
+        if (c <= 0) n2 = 0;
+        else
+        {
+            float x2 = x0 + (2 * (float)G2 - 1);
+            float y2 = y0 + (2 * (float)G2 - 1);
+            n2 = (c * c) * (c * c) * LatticeGrad(g + row + 2, x2, y2);
+        }
+
+        if (y0 > x0)
+        {
+            float x1 = x0 + (float)G2;
+            float y1 = y0 + ((float)G2 - 1);
+            float b = 0.5f - x1 * x1 - y1 * y1;
+            if (b <= 0) n1 = 0;
+            else
+            {
+                n1 = (b * b) * (b * b) * LatticeGrad(g + row, x1, y1);
+            }
+        }
+        else
+        {
+            float x1 = x0 + ((float)G2 - 1);
+            float y1 = y0 + (float)G2;
+            float b = 0.5f - x1 * x1 - y1 * y1;
+            if (b <= 0) n1 = 0;
+            else
+            {
+                n1 = (b * b) * (b * b) * LatticeGrad(g + 2, x1, y1);
+            }
+        }
+
+        return (n0 + n1 + n2) * 99.83685446303647f;
+    }
+
+    static float LatticePerlin(const LatticeTable& table, const float* values, float x, float y)
+    {
+        int x0 = FastFloor(x);
+        int y0 = FastFloor(y);
+
+        float xd0 = (float)(x - x0);
+        float yd0 = (float)(y - y0);
+        float xd1 = xd0 - 1;
+        float yd1 = yd0 - 1;
+
+        float xs = InterpQuintic(xd0);
+        float ys = InterpQuintic(yd0);
+
+        const float* g0 = LatticeAt(table, values, x0, y0, 2);
+        const float* g1 = g0 + table.width * 2;
+
+        float xf0 = Lerp(LatticeGrad(g0, xd0, yd0), LatticeGrad(g0 + 2, xd1, yd0), xs);
+        float xf1 = Lerp(LatticeGrad(g1, xd0, yd1), LatticeGrad(g1 + 2, xd1, yd1), xs);
+
+        return Lerp(xf0, xf1, ys) * 1.4247691104677813f;
+    }
+
+    static float LatticeValueCubic(const LatticeTable& table, const float* values, float x, float y)
+    {
+        int x1 = FastFloor(x);
+        int y1 = FastFloor(y);
+
+        float xs = (float)(x - x1);
+        float ys = (float)(y - y1);
+
+        const float* row[4];
+        row[0] = LatticeAt(table, values, x1 - 1, y1 - 1, 1);
+        for (int r = 1; r < 4; r++)
+            row[r] = row[r - 1] + table.width;
+
+        return CubicLerp(
+            CubicLerp(row[0][0], row[0][1], row[0][2], row[0][3], xs),
+            CubicLerp(row[1][0], row[1][1], row[1][2], row[1][3], xs),
+            CubicLerp(row[2][0], row[2][1], row[2][2], row[2][3], xs),
+            CubicLerp(row[3][0], row[3][1], row[3][2], row[3][3], xs),
+            ys) * (1 / (1.5f * 1.5f));
+    }
+
+    // Noise is resolved at compile time like in Specialized
+    template <NoiseType Noise>
+    float LatticeSingle(const LatticeTable& table, const float* values, int seed, float x, float y)
+    {
+        switch (Noise)
+        {
+        case NoiseType_OpenSimplex2:
+            return table.hashed ? SingleSimplex(seed, x, y) : LatticeSimplex(table, values, x, y);
+        case NoiseType_Perlin:
+            return table.hashed ? SinglePerlin(seed, x, y) : LatticePerlin(table, values, x, y);
+        default:
+            return table.hashed ? SingleValueCubic(seed, x, y) : LatticeValueCubic(table, values, x, y);
+        }
+    }
+
+    // Same operation order as GenFractalFBm/Ridged/PingPong, octave o reads tables[o]
+    template <NoiseType Noise, FractalType Fractal>
+    float LatticeFractal(const LatticeTable* tables, const float* values, float x, float y)
+    {
+        if (Fractal != FractalType_FBm && Fractal != FractalType_Ridged && Fractal != FractalType_PingPong)
+            return LatticeSingle<Noise>(tables[0], values, mSeed, x, y);
+
+        int seed = mSeed;
+        float sum = 0;
+        float amp = mFractalBounding;
+
+        for (int i = 0; i < mOctaves; i++)
+        {
+            float noise;
+            switch (Fractal)
+            {
+            default:
+                noise = LatticeSingle<Noise>(tables[i], values, seed++, x, y);
+                sum += noise * amp;
+                amp *= Lerp(1.0f, FastMin(noise + 1, 2) * 0.5f, mWeightedStrength);
+                break;
+            case FractalType_Ridged:
+                noise = FastAbs(LatticeSingle<Noise>(tables[i], values, seed++, x, y));
+                sum += (noise * -2 + 1) * amp;
+                amp *= Lerp(1.0f, 1 - noise, mWeightedStrength);
+                break;
+            case FractalType_PingPong:
+                noise = PingPong((LatticeSingle<Noise>(tables[i], values, seed++, x, y) + 1) * mPingPongStength);
+                sum += (noise - 0.5f) * 2 * amp;
+                amp *= Lerp(1.0f, noise, mWeightedStrength);
+                break;
+            }
+
+            x *= mLacunarity;
+            y *= mLacunarity;
+            amp *= mGain;
+        }
+
+        return sum;
+    }
+
+    template <NoiseType Noise, FractalType Fractal>
+    void LatticeGrid2DFixed(float* noiseOut, const LatticeTable* tables, const float* values, int xStart, int yStart, int xSize, int ySize, float step)
+    {
+        UniformGridLoop2D<Noise == NoiseType_OpenSimplex2>(noiseOut, xStart, yStart, xSize, ySize, step, [this, tables, values](float x, float y)
+        {
+            return LatticeFractal<Noise, Fractal>(tables, values, x, y);
+        });
+    }
+
+    template <NoiseType Noise>
+    void LatticeGrid2D(float* noiseOut, const LatticeTable* tables, const float* values, int xStart, int yStart, int xSize, int ySize, float step)
+    {
+        switch (mFractalType)
+        {
+        case FractalType_FBm:
+            LatticeGrid2DFixed<Noise, FractalType_FBm>(noiseOut, tables, values, xStart, yStart, xSize, ySize, step);
+            break;
+        case FractalType_Ridged:
+            LatticeGrid2DFixed<Noise, FractalType_Ridged>(noiseOut, tables, values, xStart, yStart, xSize, ySize, step);
+            break;
+        case FractalType_PingPong:
+            LatticeGrid2DFixed<Noise, FractalType_PingPong>(noiseOut, tables, values, xStart, yStart, xSize, ySize, step);
+            break;
+        default:
+            LatticeGrid2DFixed<Noise, FractalType_None>(noiseOut, tables, values, xStart, yStart, xSize, ySize, step);
+            break;
+        }
+    }
+
+
+    // Uniform Grid
+
+    template <bool Skew, typename Sampler>
+    void UniformGridLoop2D(float* noiseOut, int xStart, int yStart, int xSize, int ySize, float step, Sampler sampler)
+    {
+        const float frequency = mFrequency;
+        const float SQRT3 = 1.7320508075688772935274463415059f;
+        const float F2 = 0.5f * (SQRT3 - 1);
+
+        for (int yi = 0; yi < ySize; yi++)
+        {
+            float yCoord = (float)(yStart + yi) * step * frequency;
+
+            for (int xi = 0; xi < xSize; xi++)
+            {
+                float x = (float)(xStart + xi) * step * frequency;
+                float y = yCoord;
+
+                if (Skew)
+                {
+                    float t = (x + y) * F2;
+                    x += t;
+                    y += t;
+                }
+
+                *noiseOut++ = sampler(x, y);
+            }
+        }
+    }
+
+    template <TransformType3D Transform, typename Sampler>
+    void UniformGridLoop3D(float* noiseOut, int xStart, int yStart, int zStart, int xSize, int ySize, int zSize, float step, Sampler sampler)
+    {
+        const float frequency = mFrequency;
+
+        for (int zi = 0; zi < zSize; zi++)
+        {
+            float zCoord = (float)(zStart + zi) * step * frequency;
+
+            for (int yi = 0; yi < ySize; yi++)
+            {
+                float yCoord = (float)(yStart + yi) * step * frequency;
+
+                for (int xi = 0; xi < xSize; xi++)
+                {
+                    float x = (float)(xStart + xi) * step * frequency;
+                    float y = yCoord;
+                    float z = zCoord;
+
+                    TransformNoiseCoordinateFixed<Transform>(x, y, z);
+
+                    *noiseOut++ = sampler(x, y, z);
+                }
+            }
+        }
+    }
+
+    // Resolves the 3D transform once, outside the loops
+    template <typename Sampler>
+    void UniformGridLoop3D(float* noiseOut, int xStart, int yStart, int zStart, int xSize, int ySize, int zSize, float step, Sampler sampler)
+    {
+        switch (mTransformType3D)
+        {
+        case TransformType3D_ImproveXYPlanes:
+            UniformGridLoop3D<TransformType3D_ImproveXYPlanes>(noiseOut, xStart, yStart, zStart, xSize, ySize, zSize, step, sampler);
+            break;
+        case TransformType3D_ImproveXZPlanes:
+            UniformGridLoop3D<TransformType3D_ImproveXZPlanes>(noiseOut, xStart, yStart, zStart, xSize, ySize, zSize, step, sampler);
+            break;
+        case TransformType3D_DefaultOpenSimplex2:
+            UniformGridLoop3D<TransformType3D_DefaultOpenSimplex2>(noiseOut, xStart, yStart, zStart, xSize, ySize, zSize, step, sampler);
+            break;
+        default:
+            UniformGridLoop3D<TransformType3D_None>(noiseOut, xStart, yStart, zStart, xSize, ySize, zSize, step, sampler);
+            break;
+        }
+    }
+
+    // Specialized pipeline factory
+
+    template <NoiseType Noise, FractalType Fractal, int Octaves>
+    static SpecializedPipeline MakeSpecializedPipeline()
+    {
+        typedef Specialized<Noise, Fractal, Octaves> Pipeline;
+
+        SpecializedPipeline pipeline;
+        pipeline.Noise2D = &Pipeline::Noise2D;
+        pipeline.Noise3D = &Pipeline::Noise3D;
+        pipeline.UniformGrid2D = &Pipeline::UniformGrid2D;
+        pipeline.UniformGrid3D = &Pipeline::UniformGrid3D;
+        return pipeline;
+    }
+
+    template <NoiseType Noise, FractalType Fractal>
+    SpecializedPipeline SelectSpecializedOctaves() const
+    {
+        switch (mOctaves)
+        {
+        case 1: return MakeSpecializedPipeline<Noise, Fractal, 1>();
+        case 2: return MakeSpecializedPipeline<Noise, Fractal, 2>();
+        case 3: return MakeSpecializedPipeline<Noise, Fractal, 3>();
+        case 4: return MakeSpecializedPipeline<Noise, Fractal, 4>();
+        case 5: return MakeSpecializedPipeline<Noise, Fractal, 5>();
+        case 6: return MakeSpecializedPipeline<Noise, Fractal, 6>();
+        case 7: return MakeSpecializedPipeline<Noise, Fractal, 7>();
+        case 8: return MakeSpecializedPipeline<Noise, Fractal, 8>();
+        default: return MakeSpecializedPipeline<Noise, Fractal, 0>();
+        }
+    }
+
+    template <NoiseType Noise>
+    SpecializedPipeline SelectSpecializedFractal() const
+    {
+        switch (mFractalType)
+        {
+        case FractalType_FBm:
+            return SelectSpecializedOctaves<Noise, FractalType_FBm>();
+        // Only FBm gets unrolled octave counts, every count is a full copy of the basis function
+        case FractalType_Ridged:
+            return MakeSpecializedPipeline<Noise, FractalType_Ridged, 0>();
+        case FractalType_PingPong:
+            return MakeSpecializedPipeline<Noise, FractalType_PingPong, 0>();
+        default:
+            return MakeSpecializedPipeline<Noise, FractalType_None, 0>();
+        }
+    }
+
+
+    // Derivatives
+
+    bool HasAnalyticDerivatives() const
+    {
+        return mNoiseType == NoiseType_OpenSimplex2 || mNoiseType == NoiseType_Perlin || mNoiseType == NoiseType_Value;
+    }
+
+    // Value and derivatives in input space, mirrors GetNoise step for step so the value is identical
+    template <typename FNfloat>
+    float GenNoiseWithDerivatives(FNfloat x, FNfloat y, float& dx, float& dy)
+    {
+        TransformNoiseCoordinate(x, y);
+
+        // The simplex kernel works on unskewed offsets, so its derivatives are already
+        // relative to the frequency scaled coordinate and the skew needs no chain rule
+        float sum;
+        switch (mFractalType)
+        {
+        default:
+            sum = GenNoiseSingleWithDerivatives(mSeed, x, y, dx, dy);
+            break;
+        case FractalType_FBm:
+        case FractalType_Ridged:
+        case FractalType_PingPong:
+            sum = GenFractalWithDerivatives(x, y, dx, dy);
+            break;
+        }
+
+        dx *= mFrequency;
+        dy *= mFrequency;
+        return sum;
+    }
+
+    template <typename FNfloat>
+    float GenNoiseSingleWithDerivatives(int seed, FNfloat x, FNfloat y, float& dx, float& dy)
+    {
+        switch (mNoiseType)
+        {
+        case NoiseType_OpenSimplex2:
+            return SingleSimplexWithDerivatives(seed, x, y, dx, dy);
+        case NoiseType_Perlin:
+            return SinglePerlinWithDerivatives(seed, x, y, dx, dy);
+        case NoiseType_Value:
+            return SingleValueWithDerivatives(seed, x, y, dx, dy);
+        default:
+            dx = dy = 0;
+            return 0;
+        }
+    }
+
+    // GenFractalFBm/Ridged/PingPong with the product rule applied to the weighted amplitude
+    template <typename FNfloat>
+    float GenFractalWithDerivatives(FNfloat x, FNfloat y, float& dx, float& dy)
+    {
+        int seed = mSeed;
+        float sum = 0;
+        float amp = mFractalBounding;
+        float ampDx = 0, ampDy = 0;
+        float sumDx = 0, sumDy = 0;
+        float octaveScale = 1;
+
+        for (int i = 0; i < mOctaves; i++)
+        {
+            float ndx, ndy;
+            float noise = GenNoiseSingleWithDerivatives(seed++, x, y, ndx, ndy);
+            ndx *= octaveScale;
+            ndy *= octaveScale;
+
+            // weight is the Lerp factor applied to amp, weightDn its derivative over the noise derivative
+            float weight, weightDn;
+            switch (mFractalType)
+            {
+            default:
+            {
+                sum += noise * amp;
+                sumDx += ndx * amp + noise * ampDx;
+                sumDy += ndy * amp + noise * ampDy;
+                weight = Lerp(1.0f, FastMin(noise + 1, 2) * 0.5f, mWeightedStrength);
+                weightDn = noise + 1 < 2 ? 0.5f * mWeightedStrength : 0;
+            }
+            break;
+            case FractalType_Ridged:
+            {
+                float sign = noise < 0 ? -1.0f : 1.0f;
+                noise = FastAbs(noise);
+                ndx *= sign;
+                ndy *= sign;
+                float ridge = noise * -2 + 1;
+                sum += ridge * amp;
+                sumDx += -2 * ndx * amp + ridge * ampDx;
+                sumDy += -2 * ndy * amp + ridge * ampDy;
+                weight = Lerp(1.0f, 1 - noise, mWeightedStrength);
+                weightDn = -mWeightedStrength;
+            }
+            break;
+            case FractalType_PingPong:
+            {
+                float t = (noise + 1) * mPingPongStength;
+                noise = PingPong(t);
+                // PingPong is a triangle wave, rising while its folded argument is below 1
+                float slope = (t - (int)(t * 0.5f) * 2) < 1 ? mPingPongStength : -mPingPongStength;
+                ndx *= slope;
+                ndy *= slope;
+                sum += (noise - 0.5f) * 2 * amp;
+                sumDx += 2 * ndx * amp + (noise - 0.5f) * 2 * ampDx;
+                sumDy += 2 * ndy * amp + (noise - 0.5f) * 2 * ampDy;
+                weight = Lerp(1.0f, noise, mWeightedStrength);
+                weightDn = mWeightedStrength;
+            }
+            break;
+            }
+
+            ampDx = (ampDx * weight + amp * weightDn * ndx) * mGain;
+            ampDy = (ampDy * weight + amp * weightDn * ndy) * mGain;
+            amp *= weight;
+
+            x *= mLacunarity;
+            y *= mLacunarity;
+            amp *= mGain;
+            octaveScale *= mLacunarity;
+        }
+
+        dx = sumDx;
+        dy = sumDy;
+        return sum;
+    }
+
+    template <typename FNfloat>
+    float GenNoiseWithCentralDifferences(FNfloat x, FNfloat y, float& dx, float& dy)
+    {
+        // A thousandth of the base feature size, well below the highest octave at common lacunarity
+        const FNfloat h = (FNfloat)(1e-3f / mFrequency);
+
+        float noise = GetNoise(x, y);
+        dx = (GetNoise(x + h, y) - GetNoise(x - h, y)) / (float)(2 * h);
+        dy = (GetNoise(x, y + h) - GetNoise(x, y - h)) / (float)(2 * h);
+        return noise;
+    }
+
+    void GradCoordVector(int seed, int xPrimed, int yPrimed, float& xg, float& yg)
+    {
+        int hash = Hash(seed, xPrimed, yPrimed);
+        hash ^= hash >> 15;
+        hash &= 127 << 1;
+
+        xg = Lookup<float>::Gradients2D[hash];
+        yg = Lookup<float>::Gradients2D[hash | 1];
+    }
+
+    template <typename FNfloat>
+    float SingleSimplexWithDerivatives(int seed, FNfloat x, FNfloat y, float& dx, float& dy)
+    {
+        // SingleSimplex plus d/dx of each corner's (a^4 * dot(g, d)) = a^4 * g - 8 * a^3 * dot(g, d) * d
+
+        const float SQRT3 = 1.7320508075688772935274463415059f;
+        const float G2 = (3 - SQRT3) / 6;
+
+        int i = FastFloor(x);
+        int j = FastFloor(y);
+        float xi = (float)(x - i);
+        float yi = (float)(y - j);
+
+        float t = (xi + yi) * G2;
+        float x0 = (float)(xi - t);
+        float y0 = (float)(yi - t);
+
+        i *= PrimeX;
+        j *= PrimeY;
+
+        float n0, n1, n2;
+        float xg, yg;
+        dx = 0;
+        dy = 0;
+
+        float a = 0.5f - x0 * x0 - y0 * y0;
+        if (a <= 0) n0 = 0;
+        else
+        {
+            GradCoordVector(seed, i, j, xg, yg);
+            float g = x0 * xg + y0 * yg;
+            float a2 = a * a;
+            n0 = a2 * a2 * g;
+            dx += a2 * a2 * xg - 8 * a2 * a * g * x0;
+            dy += a2 * a2 * yg - 8 * a2 * a * g * y0;
+        }
+
+        float c = (float)(2 * (1 - 2 * G2) * (1 / G2 - 2)) * t + ((float)(-2 * (1 - 2 * G2) * (1 - 2 * G2)) + a);
+        if (c <= 0) n2 = 0;
+        else
+        {
+            float x2 = x0 + (2 * (float)G2 - 1);
+            float y2 = y0 + (2 * (float)G2 - 1);
+            GradCoordVector(seed, i + PrimeX, j + PrimeY, xg, yg);
+            float g = x2 * xg + y2 * yg;
+            float c2 = c * c;
+            n2 = c2 * c2 * g;
+            dx += c2 * c2 * xg - 8 * c2 * c * g * x2;
+            dy += c2 * c2 * yg - 8 * c2 * c * g * y2;
+        }
+
+        float x1, y1;
+        int i1 = i, j1 = j;
+        if (y0 > x0)
+        {
+            x1 = x0 + (float)G2;
+            y1 = y0 + ((float)G2 - 1);
+            j1 += PrimeY;
+        }
+        else
+        {
+            x1 = x0 + ((float)G2 - 1);
+            y1 = y0 + (float)G2;
+            i1 += PrimeX;
+        }
+
+        float b = 0.5f - x1 * x1 - y1 * y1;
+        if (b <= 0) n1 = 0;
+        else
+        {
+            GradCoordVector(seed, i1, j1, xg, yg);
+            float g = x1 * xg + y1 * yg;
+            float b2 = b * b;
+            n1 = b2 * b2 * g;
+            dx += b2 * b2 * xg - 8 * b2 * b * g * x1;
+            dy += b2 * b2 * yg - 8 * b2 * b * g * y1;
+        }
+
+        dx *= 99.83685446303647f;
+        dy *= 99.83685446303647f;
+        return (n0 + n1 + n2) * 99.83685446303647f;
+    }
+
+    template <typename FNfloat>
+    float SinglePerlinWithDerivatives(int seed, FNfloat x, FNfloat y, float& dx, float& dy)
+    {
+        int x0 = FastFloor(x);
+        int y0 = FastFloor(y);
+
+        float xd0 = (float)(x - x0);
+        float yd0 = (float)(y - y0);
+        float xd1 = xd0 - 1;
+        float yd1 = yd0 - 1;
+
+        float xs = InterpQuintic(xd0);
+        float ys = InterpQuintic(yd0);
+        float xsd = InterpQuinticDerivative(xd0);
+        float ysd = InterpQuinticDerivative(yd0);
+
+        x0 *= PrimeX;
+        y0 *= PrimeY;
+        int x1 = x0 + PrimeX;
+        int y1 = y0 + PrimeY;
+
+        float gx00, gy00, gx10, gy10, gx01, gy01, gx11, gy11;
+        GradCoordVector(seed, x0, y0, gx00, gy00);
+        GradCoordVector(seed, x1, y0, gx10, gy10);
+        GradCoordVector(seed, x0, y1, gx01, gy01);
+        GradCoordVector(seed, x1, y1, gx11, gy11);
+
+        float v00 = xd0 * gx00 + yd0 * gy00;
+        float v10 = xd1 * gx10 + yd0 * gy10;
+        float v01 = xd0 * gx01 + yd1 * gy01;
+        float v11 = xd1 * gx11 + yd1 * gy11;
+
+        float xf0 = Lerp(v00, v10, xs);
+        float xf1 = Lerp(v01, v11, xs);
+
+        float xf0dx = Lerp(gx00, gx10, xs) + xsd * (v10 - v00);
+        float xf1dx = Lerp(gx01, gx11, xs) + xsd * (v11 - v01);
+        float xf0dy = Lerp(gy00, gy10, xs);
+        float xf1dy = Lerp(gy01, gy11, xs);
+
+        dx = Lerp(xf0dx, xf1dx, ys) * 1.4247691104677813f;
+        dy = (Lerp(xf0dy, xf1dy, ys) + ysd * (xf1 - xf0)) * 1.4247691104677813f;
+        return Lerp(xf0, xf1, ys) * 1.4247691104677813f;
+    }
+
+    template <typename FNfloat>
+    float SingleValueWithDerivatives(int seed, FNfloat x, FNfloat y, float& dx, float& dy)
+    {
+        int x0 = FastFloor(x);
+        int y0 = FastFloor(y);
+
+        float xd = (float)(x - x0);
+        float yd = (float)(y - y0);
+        float xs = InterpHermite(xd);
+        float ys = InterpHermite(yd);
+        float xsd = InterpHermiteDerivative(xd);
+        float ysd = InterpHermiteDerivative(yd);
+
+        x0 *= PrimeX;
+        y0 *= PrimeY;
+        int x1 = x0 + PrimeX;
+        int y1 = y0 + PrimeY;
+
+        float v00 = ValCoord(seed, x0, y0);
+        float v10 = ValCoord(seed, x1, y0);
+        float v01 = ValCoord(seed, x0, y1);
+        float v11 = ValCoord(seed, x1, y1);
+
+        float xf0 = Lerp(v00, v10, xs);
+        float xf1 = Lerp(v01, v11, xs);
+
+        dx = Lerp(xsd * (v10 - v00), xsd * (v11 - v01), ys);
+        dy = ysd * (xf1 - xf0);
+        return Lerp(xf0, xf1, ys);
+    }
+
+
     // Simplex/OpenSimplex2 Noise
 
     template <typename FNfloat>
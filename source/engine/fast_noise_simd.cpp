@@ -0,0 +1,661 @@
+#include "fast_noise_simd.h"
+#include "fast_noise_simd_internal.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#if FNL_SIMD_X86
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+namespace noise
+{
+namespace detail
+{
+
+struct FastNoiseLiteAccess
+{
+	static NoiseParams params(const FastNoiseLite& noise)
+	{
+		NoiseParams p;
+		p.seed = noise.mSeed;
+		p.frequency = noise.mFrequency;
+
+		switch (noise.mNoiseType)
+		{
+		case FastNoiseLite::NoiseType_OpenSimplex2S: p.basis = Basis::OpenSimplex2S; break;
+		case FastNoiseLite::NoiseType_Cellular: p.basis = Basis::Cellular; break;
+		case FastNoiseLite::NoiseType_Perlin: p.basis = Basis::Perlin; break;
+		case FastNoiseLite::NoiseType_ValueCubic: p.basis = Basis::ValueCubic; break;
+		case FastNoiseLite::NoiseType_Value: p.basis = Basis::Value; break;
+		default: p.basis = Basis::OpenSimplex2; break;
+		}
+
+		switch (noise.mTransformType3D)
+		{
+		case FastNoiseLite::TransformType3D_ImproveXYPlanes: p.transform3D = Transform3D::ImproveXYPlanes; break;
+		case FastNoiseLite::TransformType3D_ImproveXZPlanes: p.transform3D = Transform3D::ImproveXZPlanes; break;
+		case FastNoiseLite::TransformType3D_DefaultOpenSimplex2: p.transform3D = Transform3D::DefaultOpenSimplex2; break;
+		default: p.transform3D = Transform3D::None; break;
+		}
+
+		// Domain warp fractal types only affect DomainWarp(...), GetNoise treats them as none
+		switch (noise.mFractalType)
+		{
+		case FastNoiseLite::FractalType_FBm: p.fractal = Fractal::FBm; break;
+		case FastNoiseLite::FractalType_Ridged: p.fractal = Fractal::Ridged; break;
+		case FastNoiseLite::FractalType_PingPong: p.fractal = Fractal::PingPong; break;
+		default: p.fractal = Fractal::None; break;
+		}
+
+		p.octaves = noise.mOctaves;
+		p.lacunarity = noise.mLacunarity;
+		p.gain = noise.mGain;
+		p.weightedStrength = noise.mWeightedStrength;
+		p.pingPongStrength = noise.mPingPongStength;
+		p.fractalBounding = noise.mFractalBounding;
+
+		switch (noise.mCellularDistanceFunction)
+		{
+		case FastNoiseLite::CellularDistanceFunction_Euclidean: p.cellularDistance = CellularDistance::Euclidean; break;
+		case FastNoiseLite::CellularDistanceFunction_Manhattan: p.cellularDistance = CellularDistance::Manhattan; break;
+		case FastNoiseLite::CellularDistanceFunction_Hybrid: p.cellularDistance = CellularDistance::Hybrid; break;
+		default: p.cellularDistance = CellularDistance::EuclideanSq; break;
+		}
+
+		switch (noise.mCellularReturnType)
+		{
+		case FastNoiseLite::CellularReturnType_CellValue: p.cellularReturn = CellularReturn::CellValue; break;
+		case FastNoiseLite::CellularReturnType_Distance2: p.cellularReturn = CellularReturn::Distance2; break;
+		case FastNoiseLite::CellularReturnType_Distance2Add: p.cellularReturn = CellularReturn::Distance2Add; break;
+		case FastNoiseLite::CellularReturnType_Distance2Sub: p.cellularReturn = CellularReturn::Distance2Sub; break;
+		case FastNoiseLite::CellularReturnType_Distance2Mul: p.cellularReturn = CellularReturn::Distance2Mul; break;
+		case FastNoiseLite::CellularReturnType_Distance2Div: p.cellularReturn = CellularReturn::Distance2Div; break;
+		default: p.cellularReturn = CellularReturn::Distance; break;
+		}
+		p.cellularJitter = noise.mCellularJitterModifier;
+
+		switch (noise.mDomainWarpType)
+		{
+		case FastNoiseLite::DomainWarpType_OpenSimplex2Reduced: p.warpType = DomainWarp::OpenSimplex2Reduced; break;
+		case FastNoiseLite::DomainWarpType_BasicGrid: p.warpType = DomainWarp::BasicGrid; break;
+		default: p.warpType = DomainWarp::OpenSimplex2; break;
+		}
+
+		switch (noise.mFractalType)
+		{
+		case FastNoiseLite::FractalType_DomainWarpProgressive: p.warpFractal = WarpFractal::Progressive; break;
+		case FastNoiseLite::FractalType_DomainWarpIndependent: p.warpFractal = WarpFractal::Independent; break;
+		default: p.warpFractal = WarpFractal::None; break;
+		}
+		p.warpAmp = noise.mDomainWarpAmp;
+
+		p.gradients2D = FastNoiseLite::Lookup<float>::Gradients2D;
+		p.gradients3D = FastNoiseLite::Lookup<float>::Gradients3D;
+		p.randVecs2D = FastNoiseLite::Lookup<float>::RandVecs2D;
+		p.randVecs3D = FastNoiseLite::Lookup<float>::RandVecs3D;
+		return p;
+	}
+};
+
+} // end namespace detail
+
+namespace
+{
+
+#if FNL_SIMD_X86
+void cpuid(int leaf, int subleaf, unsigned int regs[4])
+{
+#if defined(_MSC_VER)
+	int r[4];
+	__cpuidex(r, leaf, subleaf);
+	for (int i = 0; i < 4; i++)
+		regs[i] = (unsigned int)r[i];
+#else
+	__cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+}
+
+unsigned long long xgetbv0()
+{
+#if defined(_MSC_VER)
+	return _xgetbv(0);
+#else
+	unsigned int eax, edx;
+	__asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+	return ((unsigned long long)edx << 32) | eax;
+#endif
+}
+
+SimdLevel detectCpu()
+{
+	unsigned int regs[4];
+	cpuid(0, 0, regs);
+	unsigned int maxLeaf = regs[0];
+	if (maxLeaf < 1)
+		return SimdLevel::Scalar;
+
+	cpuid(1, 0, regs);
+	bool sse41 = (regs[2] & (1u << 19)) != 0;
+	bool osxsave = (regs[2] & (1u << 27)) != 0;
+	bool avx = (regs[2] & (1u << 28)) != 0;
+
+	bool avx2 = false;
+	// AVX state has to be enabled by the OS, XMM and YMM bits of XCR0
+	if (osxsave && avx && (xgetbv0() & 0x6) == 0x6 && maxLeaf >= 7)
+	{
+		cpuid(7, 0, regs);
+		avx2 = (regs[1] & (1u << 5)) != 0;
+	}
+
+	if (avx2)
+		return SimdLevel::AVX2;
+	if (sse41)
+		return SimdLevel::SSE41;
+	return SimdLevel::Scalar;
+}
+#endif
+
+const detail::KernelTable* kernelTable(SimdLevel level)
+{
+	switch (level)
+	{
+	case SimdLevel::AVX2:
+		return detail::kernelTableAVX2();
+	case SimdLevel::SSE41:
+		return detail::kernelTableSSE41();
+	default:
+		return nullptr;
+	}
+}
+
+const detail::KernelTable* clampedTable(SimdLevel level)
+{
+	if (level > detectSimdLevel())
+		level = detectSimdLevel();
+	return kernelTable(level);
+}
+
+// Tile grids have no FastNoiseLite equivalent, Scalar runs the one lane kernels
+const detail::KernelTable* tileTable(SimdLevel level)
+{
+	const detail::KernelTable* table = clampedTable(level);
+	return table ? table : detail::kernelTableScalar();
+}
+
+// Integer lattice cell of a noise space coordinate, primed with wrap around like the hash, and the remainder
+void splitOrigin(double coord, int prime, int& primed, float& remainder)
+{
+	const double cell = std::floor(coord);
+	primed = int(uint32_t(uint64_t(int64_t(cell))) * uint32_t(prime));
+	remainder = float(coord - cell);
+}
+
+// The origin goes through the same linear maps as the tile relative coordinates, in double and with the
+// kernels' float constants: frequency, the coordinate transform, then lacunarity once per octave
+std::vector<detail::OctaveOrigin> octaveOrigins(const detail::NoiseParams& p, double x, double y)
+{
+	x *= double(p.frequency);
+	y *= double(p.frequency);
+
+	if (p.basis == detail::Basis::OpenSimplex2 || p.basis == detail::Basis::OpenSimplex2S)
+	{
+		const float F2 = 0.5f * (1.7320508075688772935274463415059f - 1);
+		const double t = (x + y) * double(F2);
+		x += t;
+		y += t;
+	}
+
+	std::vector<detail::OctaveOrigin> origins(size_t(std::max(1, p.octaves)));
+	for (detail::OctaveOrigin& origin : origins)
+	{
+		splitOrigin(x, detail::PrimeX, origin.xPrimed, origin.x);
+		splitOrigin(y, detail::PrimeY, origin.yPrimed, origin.y);
+		x *= double(p.lacunarity);
+		y *= double(p.lacunarity);
+	}
+	return origins;
+}
+
+std::vector<detail::OctaveOrigin> octaveOrigins(const detail::NoiseParams& p, double x, double y, double z)
+{
+	x *= double(p.frequency);
+	y *= double(p.frequency);
+	z *= double(p.frequency);
+
+	switch (p.transform3D)
+	{
+	case detail::Transform3D::ImproveXYPlanes:
+	{
+		const double xy = x + y;
+		const double s2 = xy * double(-(float)0.211324865405187);
+		z *= double((float)0.577350269189626);
+		x += s2 - z;
+		y = y + s2 - z;
+		z += xy * double((float)0.577350269189626);
+	}
+	break;
+	case detail::Transform3D::ImproveXZPlanes:
+	{
+		const double xz = x + z;
+		const double s2 = xz * double(-(float)0.211324865405187);
+		y *= double((float)0.577350269189626);
+		x += s2 - y;
+		z += s2 - y;
+		y += xz * double((float)0.577350269189626);
+	}
+	break;
+	case detail::Transform3D::DefaultOpenSimplex2:
+	{
+		const double r = (x + y + z) * double((float)(2.0 / 3.0));
+		x = r - x;
+		y = r - y;
+		z = r - z;
+	}
+	break;
+	default:
+		break;
+	}
+
+	std::vector<detail::OctaveOrigin> origins(size_t(std::max(1, p.octaves)));
+	for (detail::OctaveOrigin& origin : origins)
+	{
+		splitOrigin(x, detail::PrimeX, origin.xPrimed, origin.x);
+		splitOrigin(y, detail::PrimeY, origin.yPrimed, origin.y);
+		splitOrigin(z, detail::PrimeZ, origin.zPrimed, origin.z);
+		x *= double(p.lacunarity);
+		y *= double(p.lacunarity);
+		z *= double(p.lacunarity);
+	}
+	return origins;
+}
+
+// Largest coarse stride is 1 << MaxLodShift samples
+const int MaxLodShift = 6;
+
+// Worst Catmull-Rom upsampling error per unit noise amplitude at sample spacing h (frequency applied),
+// measured over 10^5 samples per basis and rounded up. Cellular has creases and never gets coarser.
+float lodError(detail::Basis basis, float h)
+{
+	switch (basis)
+	{
+	case detail::Basis::OpenSimplex2: return 24.0f * h * h * h;
+	case detail::Basis::OpenSimplex2S: return 12.0f * h * h * h;
+	case detail::Basis::Perlin: return 4.0f * h * h * h;
+	case detail::Basis::ValueCubic: return 2.0f * h * h * h;
+	case detail::Basis::Value: return 1.0f * h * h;
+	default: return INFINITY;
+	}
+}
+
+// Coarsest power of two stride for an octave whose upsampling error stays within budget
+int lodStride(const detail::NoiseParams& p, int octave, float step, float budget)
+{
+	// Amplitude before weighting, weighted strength in 0...1 only lowers it; Ridged and PingPong scale the noise
+	float amp = 1.0f;
+	float scale = 1.0f;
+	if (p.fractal != detail::Fractal::None)
+	{
+		amp = p.fractalBounding * std::pow(std::fabs(p.gain), float(octave));
+		scale = p.fractal == detail::Fractal::Ridged ? 2.0f : p.fractal == detail::Fractal::PingPong ? 2.0f * std::fabs(p.pingPongStrength) : 1.0f;
+	}
+
+	const float spacing = std::fabs(step * p.frequency * std::pow(p.lacunarity, float(octave)));
+
+	int shift = 0;
+	while (shift < MaxLodShift && amp * scale * lodError(p.basis, spacing * float(2 << shift)) <= budget)
+		shift++;
+	return 1 << shift;
+}
+
+// Catmull-Rom taps for the phases 0...stride - 1, phase 0 is (0, 1, 0, 0) so coarse samples come through unchanged
+std::vector<float> bicubicWeights(int stride)
+{
+	std::vector<float> weights(size_t(stride) * 4);
+	for (int i = 0; i < stride; i++)
+	{
+		float t = float(i) / float(stride);
+		float t2 = t * t;
+		float t3 = t2 * t;
+		weights[i * 4 + 0] = 0.5f * (-t3 + 2 * t2 - t);
+		weights[i * 4 + 1] = 0.5f * (3 * t3 - 5 * t2 + 2);
+		weights[i * 4 + 2] = 0.5f * (-3 * t3 + 4 * t2 + t);
+		weights[i * 4 + 3] = 0.5f * (t3 - t2);
+	}
+	return weights;
+}
+
+// Same contract and operation order as Kernels::upsampleBicubic
+void upsampleBicubicScalar(const float* coarse, int coarseWidth, int coarseHeight, const float* weights, int shift, int xPhase, int yPhase,
+						   float* out, int xSize, int ySize, float* rows)
+{
+	const int mask = (1 << shift) - 1;
+
+	for (int j = 0; j < coarseHeight; j++)
+	{
+		const float* src = coarse + size_t(j) * size_t(coarseWidth);
+		float* dst = rows + size_t(j) * size_t(xSize);
+
+		for (int x = 0; x < xSize; x++)
+		{
+			const int gx = x + xPhase;
+			const float* c = src + (gx >> shift);
+			const float* t = weights + (gx & mask) * 4;
+			dst[x] = c[0] * t[0] + c[1] * t[1] + c[2] * t[2] + c[3] * t[3];
+		}
+	}
+
+	for (int y = 0; y < ySize; y++)
+	{
+		const int gy = y + yPhase;
+		const float* w = weights + (gy & mask) * 4;
+		const float* r = rows + size_t(gy >> shift) * size_t(xSize);
+
+		for (int x = 0; x < xSize; x++)
+			out[x] = r[x] * w[0] + r[x + xSize] * w[1] + r[x + 2 * xSize] * w[2] + r[x + 3 * xSize] * w[3];
+		out += xSize;
+	}
+}
+
+// Same contract and operation order as Kernels::reduceMinMaxAvg
+void reduceMinMaxAvgScalar(const float* srcMin, const float* srcMax, const float* srcAvg, int srcWidth, int srcHeight,
+						   float* dstMin, float* dstMax, float* dstAvg, int yBegin, int yEnd)
+{
+	const int dstWidth = srcWidth > 1 ? srcWidth / 2 : 1;
+	const int dstHeight = srcHeight > 1 ? srcHeight / 2 : 1;
+
+	for (int y = yBegin; y < yEnd; y++)
+	{
+		const size_t first = size_t(2 * y) * size_t(srcWidth);
+		const int rows = y == dstHeight - 1 ? srcHeight - 2 * y : 2;
+
+		for (int x = 0; x < dstWidth; x++)
+		{
+			const int columns = x == dstWidth - 1 ? srcWidth - 2 * x : 2;
+			float lo = INFINITY;
+			float hi = -INFINITY;
+			float sum = 0.0f;
+
+			for (int c = 0; c < columns; c++)
+			{
+				const size_t column = first + size_t(2 * x + c);
+				float columnMin = srcMin[column];
+				float columnMax = srcMax[column];
+				float columnSum = srcAvg[column];
+				for (int r = 1; r < rows; r++)
+				{
+					const size_t offset = column + size_t(r) * size_t(srcWidth);
+					columnMin = std::min(columnMin, srcMin[offset]);
+					columnMax = std::max(columnMax, srcMax[offset]);
+					columnSum += srcAvg[offset];
+				}
+				lo = std::min(lo, columnMin);
+				hi = std::max(hi, columnMax);
+				sum = c == 0 ? columnSum : sum + columnSum;
+			}
+
+			const size_t out = size_t(y) * size_t(dstWidth) + size_t(x);
+			dstMin[out] = lo;
+			dstMax[out] = hi;
+			dstAvg[out] = sum * (1.0f / float(columns * rows));
+		}
+	}
+}
+
+} // end unnamed namespace
+
+SimdLevel detectSimdLevel()
+{
+	static const SimdLevel level = []
+	{
+#if FNL_SIMD_X86
+		SimdLevel cpu = detectCpu();
+		// Tables are only queried once the CPU is known to run their instruction set
+		if (cpu >= SimdLevel::AVX2 && detail::kernelTableAVX2())
+			return SimdLevel::AVX2;
+		if (cpu >= SimdLevel::SSE41 && detail::kernelTableSSE41())
+			return SimdLevel::SSE41;
+#endif
+		return SimdLevel::Scalar;
+	}();
+	return level;
+}
+
+const char* simdLevelName(SimdLevel level)
+{
+	switch (level)
+	{
+	case SimdLevel::AVX2:
+		return "AVX2";
+	case SimdLevel::SSE41:
+		return "SSE4.1";
+	default:
+		return "Scalar";
+	}
+}
+
+int simdLaneCount(SimdLevel level)
+{
+	switch (level)
+	{
+	case SimdLevel::AVX2:
+		return 8;
+	case SimdLevel::SSE41:
+		return 4;
+	default:
+		return 1;
+	}
+}
+
+bool hasSimdLevel(SimdLevel level)
+{
+	return clampedTable(level) != nullptr;
+}
+
+void genUniformGrid2D(FastNoiseLite& noise, float* noiseOut, int xStart, int yStart, int xSize, int ySize, float step, SimdLevel level)
+{
+	detail::NoiseParams p = detail::FastNoiseLiteAccess::params(noise);
+
+	if (const detail::KernelTable* table = clampedTable(level))
+		table->uniformGrid2D(p, nullptr, noiseOut, xStart, yStart, xSize, ySize, step);
+	else
+		noise.GenUniformGrid2DLattice(noiseOut, xStart, yStart, xSize, ySize, step);
+}
+
+void genUniformGrid3D(FastNoiseLite& noise, float* noiseOut, int xStart, int yStart, int zStart, int xSize, int ySize, int zSize, float step, SimdLevel level)
+{
+	detail::NoiseParams p = detail::FastNoiseLiteAccess::params(noise);
+
+	if (const detail::KernelTable* table = clampedTable(level))
+		table->uniformGrid3D(p, nullptr, noiseOut, xStart, yStart, zStart, xSize, ySize, zSize, step);
+	else
+		noise.GenUniformGrid3D(noiseOut, xStart, yStart, zStart, xSize, ySize, zSize, step);
+}
+
+void genTileGrid2D(FastNoiseLite& noise, float* noiseOut, int64_t xTile, int64_t yTile, int tileSize, int xSize, int ySize, float step,
+				   SimdLevel level)
+{
+	detail::NoiseParams p = detail::FastNoiseLiteAccess::params(noise);
+
+	// sample positions are exact in double up to 2^53 / step
+	const std::vector<detail::OctaveOrigin> origins = octaveOrigins(p, double(xTile * tileSize) * double(step), double(yTile * tileSize) * double(step));
+	tileTable(level)->uniformGrid2D(p, origins.data(), noiseOut, 0, 0, xSize, ySize, step);
+}
+
+void genTileGrid3D(FastNoiseLite& noise, float* noiseOut, int64_t xTile, int64_t yTile, int64_t zTile, int tileSize, int xSize, int ySize, int zSize,
+				   float step, SimdLevel level)
+{
+	detail::NoiseParams p = detail::FastNoiseLiteAccess::params(noise);
+
+	const std::vector<detail::OctaveOrigin> origins = octaveOrigins(p, double(xTile * tileSize) * double(step), double(yTile * tileSize) * double(step),
+																	double(zTile * tileSize) * double(step));
+	tileTable(level)->uniformGrid3D(p, origins.data(), noiseOut, 0, 0, 0, xSize, ySize, zSize, step);
+}
+
+void domainWarpNoise2D(FastNoiseLite& warp, FastNoiseLite& noise, const float* xIn, const float* yIn, float* noiseOut, int count, SimdLevel level)
+{
+	detail::NoiseParams w = detail::FastNoiseLiteAccess::params(warp);
+	detail::NoiseParams p = detail::FastNoiseLiteAccess::params(noise);
+
+	if (const detail::KernelTable* table = clampedTable(level))
+	{
+		table->warpNoise2D(&w, p, xIn, yIn, noiseOut, count);
+		return;
+	}
+
+	for (int i = 0; i < count; i++)
+	{
+		float x = xIn[i];
+		float y = yIn[i];
+		warp.DomainWarp(x, y);
+		noiseOut[i] = noise.GetNoise(x, y);
+	}
+}
+
+void genNoise2D(FastNoiseLite& noise, const float* xIn, const float* yIn, float* noiseOut, int count, SimdLevel level)
+{
+	detail::NoiseParams p = detail::FastNoiseLiteAccess::params(noise);
+
+	if (const detail::KernelTable* table = clampedTable(level))
+	{
+		table->warpNoise2D(nullptr, p, xIn, yIn, noiseOut, count);
+		return;
+	}
+
+	for (int i = 0; i < count; i++)
+		noiseOut[i] = noise.GetNoise(xIn[i], yIn[i]);
+}
+
+void domainWarp2D(FastNoiseLite& warp, float* x, float* y, int count, SimdLevel level)
+{
+	detail::NoiseParams w = detail::FastNoiseLiteAccess::params(warp);
+
+	if (const detail::KernelTable* table = clampedTable(level))
+	{
+		table->domainWarp2D(w, x, y, count);
+		return;
+	}
+
+	for (int i = 0; i < count; i++)
+		warp.DomainWarp(x[i], y[i]);
+}
+
+void genOctaveLayers2D(FastNoiseLite& noise, float* layersOut, size_t layerStride, int firstOctave, int octaveCount,
+					   int xStart, int yStart, int xSize, int ySize, float step, SimdLevel level)
+{
+	detail::NoiseParams p = detail::FastNoiseLiteAccess::params(noise);
+
+	if (const detail::KernelTable* table = clampedTable(level))
+		table->octaveLayers2D(p, layersOut, layerStride, firstOctave, octaveCount, xStart, yStart, xSize, ySize, step);
+	else
+		noise.GenOctaveLayers2D(layersOut, layerStride, firstOctave, octaveCount, xStart, yStart, xSize, ySize, step);
+}
+
+void combineOctaveLayers(const FastNoiseLite& noise, const float* layers, size_t layerStride, float* noiseOut, int count, SimdLevel level)
+{
+	detail::NoiseParams p = detail::FastNoiseLiteAccess::params(noise);
+
+	if (const detail::KernelTable* table = clampedTable(level))
+		table->combineOctaves(p, layers, layerStride, noiseOut, count);
+	else
+		noise.CombineOctaveLayers(layers, layerStride, noiseOut, size_t(count));
+}
+
+bool sameOctaveLayers(const FastNoiseLite& a, const FastNoiseLite& b)
+{
+	detail::NoiseParams pa = detail::FastNoiseLiteAccess::params(a);
+	detail::NoiseParams pb = detail::FastNoiseLiteAccess::params(b);
+
+	return pa.seed == pb.seed && pa.frequency == pb.frequency && pa.basis == pb.basis && pa.lacunarity == pb.lacunarity &&
+		pa.cellularDistance == pb.cellularDistance && pa.cellularReturn == pb.cellularReturn && pa.cellularJitter == pb.cellularJitter;
+}
+
+int octaveLodStride(const FastNoiseLite& noise, int octave, float step, float maxError)
+{
+	detail::NoiseParams p = detail::FastNoiseLiteAccess::params(noise);
+	const int octaves = p.fractal != detail::Fractal::None ? p.octaves : 1;
+
+	// The error budget is split among the coarse octaves only, they are a prefix since strides shrink with
+	// rising frequency. Take the longest prefix whose last octave still gets a stride of 2 with its share.
+	int coarse = 0;
+	while (coarse < octaves && lodStride(p, coarse, step, maxError / float(coarse + 1)) > 1)
+		coarse++;
+
+	if (octave >= coarse)
+		return 1;
+	return lodStride(p, octave, step, maxError / float(coarse));
+}
+
+void genUniformGrid2DLod(FastNoiseLite& noise, float* noiseOut, int xStart, int yStart, int xSize, int ySize, float step, float maxError,
+						 SimdLevel level)
+{
+	const int octaves = noise.GetOctaveLayerCount();
+	const size_t layerSize = size_t(xSize) * size_t(ySize);
+	if (octaves <= 0 || layerSize == 0)
+	{
+		genUniformGrid2D(noise, noiseOut, xStart, yStart, xSize, ySize, step, level);
+		return;
+	}
+
+	const detail::KernelTable* table = clampedTable(level);
+	std::vector<float> layers(layerSize * size_t(octaves));
+	std::vector<float> coarse;
+	std::vector<float> rows;
+
+	int o = 0;
+	for (; o < octaves; o++)
+	{
+		// strides only shrink with rising frequency, the full resolution octaves are a suffix
+		const int stride = octaveLodStride(noise, o, step, maxError);
+		if (stride == 1)
+			break;
+
+		// Coarse samples sit on multiples of stride in grid space, neighbouring tiles share them and meet without seams
+		int shift = 0;
+		while ((1 << shift) < stride)
+			shift++;
+
+		// arithmetic shifts floor negative starts as well
+		const int xBase = xStart >> shift;
+		const int yBase = yStart >> shift;
+		const int xPhase = xStart - (xBase << shift);
+		const int yPhase = yStart - (yBase << shift);
+		const int coarseWidth = ((xPhase + xSize - 1) >> shift) + 4;
+		const int coarseHeight = ((yPhase + ySize - 1) >> shift) + 4;
+
+		// plus the padding the vector upsampler reads past the last row
+		coarse.resize(size_t(coarseWidth) * size_t(coarseHeight) + 8);
+		genOctaveLayers2D(noise, coarse.data(), 0, o, 1, xBase - 1, yBase - 1, coarseWidth, coarseHeight, step * float(stride), level);
+
+		rows.resize(size_t(xSize) * size_t(coarseHeight));
+		const std::vector<float> weights = bicubicWeights(stride);
+		float* layer = layers.data() + layerSize * size_t(o);
+
+		if (table)
+			table->upsampleBicubic(coarse.data(), coarseWidth, coarseHeight, weights.data(), shift, xPhase, yPhase, layer, xSize, ySize, rows.data());
+		else
+			upsampleBicubicScalar(coarse.data(), coarseWidth, coarseHeight, weights.data(), shift, xPhase, yPhase, layer, xSize, ySize, rows.data());
+	}
+
+	if (o < octaves)
+		genOctaveLayers2D(noise, layers.data() + layerSize * size_t(o), layerSize, o, octaves - o, xStart, yStart, xSize, ySize, step, level);
+
+	combineOctaveLayers(noise, layers.data(), layerSize, noiseOut, int(layerSize), level);
+}
+
+void reduceMinMaxAvg(const float* srcMin, const float* srcMax, const float* srcAvg, int srcWidth, int srcHeight,
+					 float* dstMin, float* dstMax, float* dstAvg, int yBegin, int yEnd, SimdLevel level)
+{
+	const detail::KernelTable* table = clampedTable(level);
+	if (table)
+		table->reduceMinMaxAvg(srcMin, srcMax, srcAvg, srcWidth, srcHeight, dstMin, dstMax, dstAvg, yBegin, yEnd);
+	else
+		reduceMinMaxAvgScalar(srcMin, srcMax, srcAvg, srcWidth, srcHeight, dstMin, dstMax, dstAvg, yBegin, yEnd);
+}
+
+} // end namespace noise
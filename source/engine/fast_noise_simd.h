@@ -0,0 +1,93 @@
+#pragma once
+#include "fast_noise.h"
+#include <cstdint>
+
+namespace noise
+{
+
+// Vectorized FastNoiseLite generation with runtime CPU dispatch.
+//
+// Vector kernels exist for every noise type (Cellular with every distance function and return
+// type) in 2D and 3D, single or any fractal type. SimdLevel::Scalar falls back to the scalar
+// FastNoiseLite::GenUniformGrid path, in 2D through GenUniformGrid2DLattice, which hashes Perlin
+// and ValueCubic lattice points once per tile.
+//
+// Accuracy: the kernels repeat the scalar operation order without FMA, so output is
+// bit-identical to FastNoiseLite when the scalar code is compiled without FMA contraction
+// (the default on x86). Builds that contract the scalar path (-mfma, /arch:AVX2 with
+// /fp:fast) differ by at most SimdMaxUlpError per basis evaluation.
+
+enum class SimdLevel
+{
+	Scalar,
+	SSE41,
+	AVX2
+};
+
+constexpr int SimdMaxUlpError = 4;
+
+// Highest level supported by both the build and the running CPU, detected once via cpuid
+SimdLevel detectSimdLevel();
+const char* simdLevelName(SimdLevel level);
+int simdLaneCount(SimdLevel level);
+
+// Whether level resolves to a vector instruction set on this CPU, every noise type has kernels for each one
+bool hasSimdLevel(SimdLevel level);
+
+// Same contract as FastNoiseLite::GenUniformGrid2D/3D; level is clamped to detectSimdLevel()
+void genUniformGrid2D(FastNoiseLite& noise, float* noiseOut, int xStart, int yStart, int xSize, int ySize,
+					  float step = 1.0f, SimdLevel level = detectSimdLevel());
+void genUniformGrid3D(FastNoiseLite& noise, float* noiseOut, int xStart, int yStart, int zStart, int xSize, int ySize, int zSize,
+					  float step = 1.0f, SimdLevel level = detectSimdLevel());
+
+// Large worlds. Sample (x, y) lies at ((xTile * tileSize + x) * step, (yTile * tileSize + y) * step) like
+// genUniformGrid2D, evaluated relative to the integer tile so precision does not degrade with distance. A tile
+// regenerates bit-identical on every SimdLevel; samples shared along tile borders agree to about 1e-7 of the
+// tile extent. xSize and ySize may exceed tileSize for borders. Noise space positions have to stay below 2^63.
+void genTileGrid2D(FastNoiseLite& noise, float* noiseOut, int64_t xTile, int64_t yTile, int tileSize, int xSize, int ySize,
+				   float step = 1.0f, SimdLevel level = detectSimdLevel());
+void genTileGrid3D(FastNoiseLite& noise, float* noiseOut, int64_t xTile, int64_t yTile, int64_t zTile, int tileSize, int xSize, int ySize,
+				   int zSize, float step = 1.0f, SimdLevel level = detectSimdLevel());
+
+// noiseOut[i] = noise.GetNoise(x, y) after warp.DomainWarp(x, y) moved (xIn[i], yIn[i]), for every
+// DomainWarpType and warp fractal. The warp runs in the same lanes as the sampling, so the warped
+// coordinates never leave registers. At SimdLevel::Scalar the whole batch runs the scalar calls.
+void domainWarpNoise2D(FastNoiseLite& warp, FastNoiseLite& noise, const float* xIn, const float* yIn, float* noiseOut, int count,
+					   SimdLevel level = detectSimdLevel());
+
+// Batches of FastNoiseLite::GetNoise(x, y) and FastNoiseLite::DomainWarp(x, y) at arbitrary positions, the
+// latter in place. Same kernels and accuracy contract as the grids.
+void genNoise2D(FastNoiseLite& noise, const float* xIn, const float* yIn, float* noiseOut, int count, SimdLevel level = detectSimdLevel());
+void domainWarp2D(FastNoiseLite& warp, float* x, float* y, int count, SimdLevel level = detectSimdLevel());
+
+// Octave layers (see FastNoiseLite::GenOctaveLayers2D) keep the unweighted noise of every fractal octave, so
+// fractal type, gain, weighted strength, ping pong strength and a lower octave count only need a
+// recombine. Layers and recombine are vectorized like genUniformGrid2D.
+// Both are bit-identical to the scalar FastNoiseLite calls under the accuracy contract above.
+void genOctaveLayers2D(FastNoiseLite& noise, float* layersOut, size_t layerStride, int firstOctave, int octaveCount,
+					   int xStart, int yStart, int xSize, int ySize, float step = 1.0f, SimdLevel level = detectSimdLevel());
+// layers holds noise.GetOctaveLayerCount() layers, noiseOut gets count values matching genUniformGrid2D
+void combineOctaveLayers(const FastNoiseLite& noise, const float* layers, size_t layerStride, float* noiseOut, int count,
+						 SimdLevel level = detectSimdLevel());
+// Whether layers generated with a are valid for b: equal seed, frequency, lacunarity and noise type settings
+bool sameOctaveLayers(const FastNoiseLite& a, const FastNoiseLite& b);
+
+// Octave LOD: low octaves are evaluated on the coarsest power of two subgrid (up to 64) whose Catmull-Rom
+// upsampling error, from a measured per noise type model, fits their share of maxError. The budget is split
+// among the octaves that can be coarsened at all, the rest and Cellular noise are evaluated exactly. Pays off
+// for large maxError, low frequencies and the scalar path; the vector kernels are cheap enough that a stride
+// of 2 on a single octave saves little. Not bit-identical to genUniformGrid2D: the difference stays below
+// maxError with weighted strength 0, higher weighted strengths add a second order term.
+// Coarse samples lie on grid positions that are multiples of the stride, so adjacent tiles match at the seams.
+void genUniformGrid2DLod(FastNoiseLite& noise, float* noiseOut, int xStart, int yStart, int xSize, int ySize, float step, float maxError,
+						 SimdLevel level = detectSimdLevel());
+// Subgrid stride genUniformGrid2DLod picks for an octave, 1 for full resolution
+int octaveLodStride(const FastNoiseLite& noise, int octave, float step, float maxError);
+
+// One level of a min / max / average pyramid (see HeightPyramid), the three channels from a single read of the
+// source. dst is max(1, srcWidth / 2) x max(1, srcHeight / 2) and each texel reduces a 2x2 source block, widened to 3
+// at the last column or row of an odd size so min and max stay conservative. Writes dst rows [yBegin, yEnd).
+void reduceMinMaxAvg(const float* srcMin, const float* srcMax, const float* srcAvg, int srcWidth, int srcHeight,
+					 float* dstMin, float* dstMax, float* dstAvg, int yBegin, int yEnd, SimdLevel level = detectSimdLevel());
+
+} // end namespace noise
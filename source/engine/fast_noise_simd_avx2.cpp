@@ -0,0 +1,140 @@
+#include "fast_noise_simd_internal.h"
+
+#if FNL_SIMD_X86 && defined(__AVX2__)
+
+#include <immintrin.h>
+
+namespace noise
+{
+namespace detail
+{
+namespace
+{
+
+struct Float8
+{
+	__m256 v;
+	Float8() = default;
+	Float8(__m256 v) : v(v) {}
+	Float8(float f) : v(_mm256_set1_ps(f)) {}
+};
+
+struct Int8
+{
+	__m256i v;
+	Int8() = default;
+	Int8(__m256i v) : v(v) {}
+	Int8(int i) : v(_mm256_set1_epi32(i)) {}
+};
+
+struct Mask8
+{
+	__m256 v;
+	Mask8(__m256 v) : v(v) {}
+};
+
+inline Float8 operator+(Float8 a, Float8 b) { return _mm256_add_ps(a.v, b.v); }
+inline Float8 operator-(Float8 a, Float8 b) { return _mm256_sub_ps(a.v, b.v); }
+inline Float8 operator*(Float8 a, Float8 b) { return _mm256_mul_ps(a.v, b.v); }
+inline Float8 operator/(Float8 a, Float8 b) { return _mm256_div_ps(a.v, b.v); }
+inline Float8 operator-(Float8 a) { return _mm256_xor_ps(a.v, _mm256_set1_ps(-0.0f)); }
+
+inline Mask8 operator<(Float8 a, Float8 b) { return _mm256_cmp_ps(a.v, b.v, _CMP_LT_OQ); }
+inline Mask8 operator<=(Float8 a, Float8 b) { return _mm256_cmp_ps(a.v, b.v, _CMP_LE_OQ); }
+inline Mask8 operator>(Float8 a, Float8 b) { return _mm256_cmp_ps(a.v, b.v, _CMP_GT_OQ); }
+inline Mask8 operator>=(Float8 a, Float8 b) { return _mm256_cmp_ps(a.v, b.v, _CMP_GE_OQ); }
+
+inline Int8 operator+(Int8 a, Int8 b) { return _mm256_add_epi32(a.v, b.v); }
+inline Int8 operator-(Int8 a, Int8 b) { return _mm256_sub_epi32(a.v, b.v); }
+inline Int8 operator*(Int8 a, Int8 b) { return _mm256_mullo_epi32(a.v, b.v); }
+inline Int8 operator&(Int8 a, Int8 b) { return _mm256_and_si256(a.v, b.v); }
+inline Int8 operator|(Int8 a, Int8 b) { return _mm256_or_si256(a.v, b.v); }
+inline Int8 operator^(Int8 a, Int8 b) { return _mm256_xor_si256(a.v, b.v); }
+inline Int8 operator~(Int8 a) { return _mm256_xor_si256(a.v, _mm256_set1_epi32(-1)); }
+inline Int8 operator>>(Int8 a, int n) { return _mm256_srai_epi32(a.v, n); }
+inline Int8 operator<<(Int8 a, int n) { return _mm256_slli_epi32(a.v, n); }
+
+inline Mask8 operator&(Mask8 a, Mask8 b) { return _mm256_and_ps(a.v, b.v); }
+inline Mask8 operator|(Mask8 a, Mask8 b) { return _mm256_or_ps(a.v, b.v); }
+inline Mask8 andNot(Mask8 a, Mask8 b) { return _mm256_andnot_ps(a.v, b.v); }
+inline bool any(Mask8 m) { return _mm256_movemask_ps(m.v) != 0; }
+
+inline Float8 select(Mask8 m, Float8 a, Float8 b) { return _mm256_blendv_ps(b.v, a.v, m.v); }
+inline Mask8 select(Mask8 m, Mask8 a, Mask8 b) { return _mm256_blendv_ps(b.v, a.v, m.v); }
+inline Int8 select(Mask8 m, Int8 a, Int8 b) { return _mm256_castps_si256(_mm256_blendv_ps(_mm256_castsi256_ps(b.v), _mm256_castsi256_ps(a.v), m.v)); }
+
+inline Float8 min(Float8 a, Float8 b) { return _mm256_min_ps(a.v, b.v); }
+inline Float8 max(Float8 a, Float8 b) { return _mm256_max_ps(a.v, b.v); }
+inline Float8 sqrt(Float8 f) { return _mm256_sqrt_ps(f.v); }
+inline Float8 toFloat(Int8 i) { return _mm256_cvtepi32_ps(i.v); }
+inline Int8 truncate(Float8 f) { return _mm256_cvttps_epi32(f.v); }
+inline Int8 maskToInt(Mask8 m) { return _mm256_castps_si256(m.v); }
+
+inline Float8 gather(const float* table, Int8 index) { return _mm256_i32gather_ps(table, index.v, 4); }
+
+// the in-lane shuffle leaves 64 bit pairs as a, b, a, b, the permute puts the a pairs first
+inline Float8 evens(Float8 a, Float8 b) { return _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(_mm256_shuffle_ps(a.v, b.v, _MM_SHUFFLE(2, 0, 2, 0))), _MM_SHUFFLE(3, 1, 2, 0))); }
+inline Float8 odds(Float8 a, Float8 b) { return _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(_mm256_shuffle_ps(a.v, b.v, _MM_SHUFFLE(3, 1, 3, 1))), _MM_SHUFFLE(3, 1, 2, 0))); }
+
+inline Float8 load(const float* in) { return _mm256_loadu_ps(in); }
+inline void store(float* out, Float8 f) { _mm256_storeu_ps(out, f.v); }
+
+struct AVX2
+{
+	typedef Float8 F;
+	typedef Int8 I;
+	typedef Mask8 M;
+	enum { Lanes = 8 };
+
+	static Int8 iota() { return _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7); }
+};
+
+} // end unnamed namespace
+} // end namespace detail
+} // end namespace noise
+
+#include "fast_noise_simd_kernels.h"
+
+namespace noise
+{
+namespace detail
+{
+
+static const KernelTable s_tableAVX2 =
+{
+	"AVX2",
+	AVX2::Lanes,
+	&Kernels<AVX2>::uniformGrid2D,
+	&Kernels<AVX2>::uniformGrid3D,
+	&Kernels<AVX2>::warpNoise2D,
+	&Kernels<AVX2>::domainWarp2D,
+	&Kernels<AVX2>::octaveLayers2D,
+	&Kernels<AVX2>::combineOctaves,
+	&Kernels<AVX2>::upsampleBicubic,
+	&Kernels<AVX2>::reduceMinMaxAvg
+};
+
+const KernelTable* kernelTableAVX2()
+{
+	return &s_tableAVX2;
+}
+
+} // end namespace detail
+} // end namespace noise
+
+#else
+
+namespace noise
+{
+namespace detail
+{
+
+const KernelTable* kernelTableAVX2()
+{
+	return nullptr;
+}
+
+} // end namespace detail
+} // end namespace noise
+
+#endif
@@ -0,0 +1,159 @@
+#pragma once
+
+// Shared between the SIMD dispatcher and the per instruction set translation units.
+// Must not include fast_noise.h: the instruction set units are compiled with wider
+// -m flags, and inline FastNoiseLite code instantiated there could be picked by the
+// linker for the whole program.
+
+#include <cstddef>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define FNL_SIMD_X86 1
+#else
+#define FNL_SIMD_X86 0
+#endif
+
+namespace noise
+{
+namespace detail
+{
+
+// FastNoiseLite's lattice hash primes
+const int PrimeX = 501125321;
+const int PrimeY = 1136930381;
+const int PrimeZ = 1720413743;
+
+// Mirrors of the FastNoiseLite enums, mapped explicitly by FastNoiseLiteAccess
+enum class Basis
+{
+	OpenSimplex2,
+	OpenSimplex2S,
+	Cellular,
+	Perlin,
+	ValueCubic,
+	Value
+};
+
+enum class Fractal
+{
+	None,
+	FBm,
+	Ridged,
+	PingPong
+};
+
+enum class CellularDistance
+{
+	Euclidean,
+	EuclideanSq,
+	Manhattan,
+	Hybrid
+};
+
+enum class CellularReturn
+{
+	CellValue,
+	Distance,
+	Distance2,
+	Distance2Add,
+	Distance2Sub,
+	Distance2Mul,
+	Distance2Div
+};
+
+enum class DomainWarp
+{
+	OpenSimplex2,
+	OpenSimplex2Reduced,
+	BasicGrid
+};
+
+// FractalType_DomainWarp*, only read when the params describe a warp
+enum class WarpFractal
+{
+	None,
+	Progressive,
+	Independent
+};
+
+enum class Transform3D
+{
+	None,
+	ImproveXYPlanes,
+	ImproveXZPlanes,
+	DefaultOpenSimplex2
+};
+
+// Snapshot of FastNoiseLite settings taken once per generation call
+struct NoiseParams
+{
+	int seed = 1337;
+	float frequency = 0.01f;
+	Basis basis = Basis::OpenSimplex2;
+	Transform3D transform3D = Transform3D::DefaultOpenSimplex2;
+
+	Fractal fractal = Fractal::None;
+	int octaves = 3;
+	float lacunarity = 2.0f;
+	float gain = 0.5f;
+	float weightedStrength = 0.0f;
+	float pingPongStrength = 2.0f;
+	float fractalBounding = 1 / 1.75f;
+
+	CellularDistance cellularDistance = CellularDistance::EuclideanSq;
+	CellularReturn cellularReturn = CellularReturn::Distance;
+	float cellularJitter = 1.0f;
+
+	DomainWarp warpType = DomainWarp::OpenSimplex2;
+	WarpFractal warpFractal = WarpFractal::None;
+	float warpAmp = 1.0f;
+
+	const float* gradients2D = nullptr;
+	const float* gradients3D = nullptr;
+	const float* randVecs2D = nullptr;
+	const float* randVecs3D = nullptr;
+};
+
+// Tile origin of a large world grid in the noise space of one octave (frequency, coordinate transform and
+// lacunarity applied), split in double precision: the integer lattice cell, multiplied by the primes so it adds
+// straight onto the primed cells the hash takes, and the float remainder in [0, 1) added to the tile relative
+// coordinates. Noise only sees small floats however far the tile is from the world origin.
+struct OctaveOrigin
+{
+	int xPrimed = 0;
+	int yPrimed = 0;
+	int zPrimed = 0;
+	float x = 0.0f;
+	float y = 0.0f;
+	float z = 0.0f;
+};
+
+struct KernelTable
+{
+	const char* name;
+	int lanes;
+
+	// origin is nullptr or holds one entry per octave, the grid positions are then relative to it
+	void (*uniformGrid2D)(const NoiseParams& params, const OctaveOrigin* origin, float* noiseOut, int xStart, int yStart, int xSize, int ySize, float step);
+	void (*uniformGrid3D)(const NoiseParams& params, const OctaveOrigin* origin, float* noiseOut, int xStart, int yStart, int zStart,
+						  int xSize, int ySize, int zSize, float step);
+	// warp is nullptr for plain sampling at the positions
+	void (*warpNoise2D)(const NoiseParams* warp, const NoiseParams& params, const float* xIn, const float* yIn, float* noiseOut, int count);
+	void (*domainWarp2D)(const NoiseParams& warp, float* x, float* y, int count);
+	void (*octaveLayers2D)(const NoiseParams& params, float* layersOut, size_t layerStride, int firstOctave, int octaveCount,
+						   int xStart, int yStart, int xSize, int ySize, float step);
+	void (*combineOctaves)(const NoiseParams& params, const float* layers, size_t layerStride, float* noiseOut, int count);
+	void (*upsampleBicubic)(const float* coarse, int coarseWidth, int coarseHeight, const float* weights, int shift, int xPhase, int yPhase,
+							float* out, int xSize, int ySize, float* rows);
+	void (*reduceMinMaxAvg)(const float* srcMin, const float* srcMax, const float* srcAvg, int srcWidth, int srcHeight,
+							float* dstMin, float* dstMax, float* dstAvg, int yBegin, int yEnd);
+};
+
+// One lane instantiation of the kernels, always available. Only used where FastNoiseLite has no equivalent.
+const KernelTable* kernelTableScalar();
+// nullptr when the instruction set was not enabled for this build
+const KernelTable* kernelTableSSE41();
+const KernelTable* kernelTableAVX2();
+
+} // end namespace detail
+} // end namespace noise
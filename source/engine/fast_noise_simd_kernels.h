@@ -0,0 +1,1843 @@
+#pragma once
+
+// Vector ports of the FastNoiseLite kernels, templated on an instruction set wrapper V.
+//
+// Only included by the per instruction set translation units, after the wrapper has
+// been declared. Everything lives in an unnamed namespace so every unit keeps its own
+// copy compiled with its own flags.
+//
+// V provides the vector types F (float), I (int32) and M (lane mask), the lane count
+// Lanes and iota() = { 0, 1, 2, ... }. F and I convert implicitly from scalars. The
+// following free functions are found through ADL:
+//   arithmetic, bitwise and shift operators, comparisons returning M,
+//   select(M, a, b) for F, I and M, andNot(M, M), any(M), toFloat(I), truncate(F), maskToInt(M),
+//   min(F, F), max(F, F), sqrt(F), gather(const float* table, I), load(const float*), store(float*, F),
+//   evens(F a, F b) / odds(F a, F b) = lanes 0, 2, 4, ... / 1, 3, 5, ... of a followed by b
+//
+// The ports follow the scalar operation order exactly and avoid FMA, so results only
+// differ from FastNoiseLite where the compiler contracts the scalar code.
+//
+// No std:: templates either, scalar tails use plain comparisons: see
+// fast_noise_simd_internal.h for why.
+
+#include "fast_noise_simd_internal.h"
+#include <cmath>
+
+namespace noise
+{
+namespace detail
+{
+namespace
+{
+
+// PrimeY << 1 and PrimeZ << 1 wrap in the scalar code
+const int PrimeX2 = (int)((unsigned)PrimeX << 1);
+const int PrimeY2 = (int)((unsigned)PrimeY << 1);
+const int PrimeZ2 = (int)((unsigned)PrimeZ << 1);
+
+template <typename V>
+struct Kernels
+{
+	typedef typename V::F F;
+	typedef typename V::I I;
+	typedef typename V::M M;
+
+	// Helpers
+
+	static I fastFloor(F f)
+	{
+		// (int)f - 1 for negative values, including negative integers, as in the scalar code
+		return truncate(f) + maskToInt(f < F(0.0f));
+	}
+
+	static I fastRound(F f)
+	{
+		return truncate(f + select(f >= F(0.0f), F(0.5f), F(-0.5f)));
+	}
+
+	static F fastAbs(F f)
+	{
+		// keeps -0.0f like the scalar f < 0 ? -f : f
+		return select(f < F(0.0f), -f, f);
+	}
+
+	static F lerp(F a, F b, F t)
+	{
+		return a + t * (b - a);
+	}
+
+	static F interpHermite(F t)
+	{
+		return t * t * (F(3.0f) - F(2.0f) * t);
+	}
+
+	static F interpQuintic(F t)
+	{
+		return t * t * t * (t * (t * 6.0f - 15.0f) + 10.0f);
+	}
+
+	static F pingPong(F t)
+	{
+		t = t - toFloat(truncate(t * 0.5f) * I(2));
+		return select(t < F(1.0f), t, 2.0f - t);
+	}
+
+	static F loadPartial(const float* in, int count)
+	{
+		float lanes[V::Lanes] = {};
+		for (int i = 0; i < count; i++)
+			lanes[i] = in[i];
+		return load(lanes);
+	}
+
+	static void storePartial(float* out, F v, int count)
+	{
+		float lanes[V::Lanes];
+		store(lanes, v);
+		for (int i = 0; i < count; i++)
+			out[i] = lanes[i];
+	}
+
+	// Hashing
+
+	static I hash(int seed, I xPrimed, I yPrimed)
+	{
+		I h = I(seed) ^ xPrimed ^ yPrimed;
+		return h * I(0x27d4eb2d);
+	}
+
+	static I hash(int seed, I xPrimed, I yPrimed, I zPrimed)
+	{
+		I h = I(seed) ^ xPrimed ^ yPrimed ^ zPrimed;
+		return h * I(0x27d4eb2d);
+	}
+
+	static F gradCoord(const NoiseParams& p, int seed, I xPrimed, I yPrimed, F xd, F yd)
+	{
+		I h = hash(seed, xPrimed, yPrimed);
+		h = h ^ (h >> 15);
+		h = h & I(127 << 1);
+
+		F xg = gather(p.gradients2D, h);
+		F yg = gather(p.gradients2D, h | I(1));
+
+		return xd * xg + yd * yg;
+	}
+
+	static F gradCoord(const NoiseParams& p, int seed, I xPrimed, I yPrimed, I zPrimed, F xd, F yd, F zd)
+	{
+		I h = hash(seed, xPrimed, yPrimed, zPrimed);
+		h = h ^ (h >> 15);
+		h = h & I(63 << 2);
+
+		F xg = gather(p.gradients3D, h);
+		F yg = gather(p.gradients3D, h | I(1));
+		F zg = gather(p.gradients3D, h | I(2));
+
+		return xd * xg + yd * yg + zd * zg;
+	}
+
+	// Value noise lattice values come straight from the hash, integer multiplies only, no table lookups
+
+	static F valCoord(int seed, I xPrimed, I yPrimed)
+	{
+		I h = hash(seed, xPrimed, yPrimed);
+		h = h * h;
+		h = h ^ (h << 19);
+		return toFloat(h) * F(1 / 2147483648.0f);
+	}
+
+	static F valCoord(int seed, I xPrimed, I yPrimed, I zPrimed)
+	{
+		I h = hash(seed, xPrimed, yPrimed, zPrimed);
+		h = h * h;
+		h = h ^ (h << 19);
+		return toFloat(h) * F(1 / 2147483648.0f);
+	}
+
+	// Contribution (a^4 * gradient) of a lattice point, zero where the kernel radius is exceeded
+	static F falloff(F a, F gradient)
+	{
+		return select(a > F(0.0f), (a * a) * (a * a) * gradient, F(0.0f));
+	}
+
+	// Simplex/OpenSimplex2 Noise
+
+	static F singleSimplex(const NoiseParams& p, int seed, F x, F y, int xOrigin, int yOrigin)
+	{
+		const float SQRT3 = 1.7320508075688772935274463415059f;
+		const float G2 = (3 - SQRT3) / 6;
+
+		I i = fastFloor(x);
+		I j = fastFloor(y);
+		F xi = x - toFloat(i);
+		F yi = y - toFloat(j);
+
+		F t = (xi + yi) * G2;
+		F x0 = xi - t;
+		F y0 = yi - t;
+
+		i = i * I(PrimeX) + I(xOrigin);
+		j = j * I(PrimeY) + I(yOrigin);
+
+		F a = F(0.5f) - x0 * x0 - y0 * y0;
+		F n0 = falloff(a, gradCoord(p, seed, i, j, x0, y0));
+
+		F c = F((float)(2 * (1 - 2 * G2) * (1 / G2 - 2))) * t + (F((float)(-2 * (1 - 2 * G2) * (1 - 2 * G2))) + a);
+		F x2 = x0 + (2 * (float)G2 - 1);
+		F y2 = y0 + (2 * (float)G2 - 1);
+		F n2 = falloff(c, gradCoord(p, seed, i + I(PrimeX), j + I(PrimeY), x2, y2));
+
+		M upper = y0 > x0;
+		F x1 = x0 + select(upper, F((float)G2), F((float)G2 - 1));
+		F y1 = y0 + select(upper, F((float)G2 - 1), F((float)G2));
+		I i1 = select(upper, i, i + I(PrimeX));
+		I j1 = select(upper, j + I(PrimeY), j);
+		F b = F(0.5f) - x1 * x1 - y1 * y1;
+		F n1 = falloff(b, gradCoord(p, seed, i1, j1, x1, y1));
+
+		return (n0 + n1 + n2) * 99.83685446303647f;
+	}
+
+	static F singleOpenSimplex2(const NoiseParams& p, int seed, F x, F y, F z, int xOrigin, int yOrigin, int zOrigin)
+	{
+		I i = fastRound(x);
+		I j = fastRound(y);
+		I k = fastRound(z);
+		F x0 = x - toFloat(i);
+		F y0 = y - toFloat(j);
+		F z0 = z - toFloat(k);
+
+		I xNSign = truncate(F(-1.0f) - x0) | I(1);
+		I yNSign = truncate(F(-1.0f) - y0) | I(1);
+		I zNSign = truncate(F(-1.0f) - z0) | I(1);
+
+		F ax0 = toFloat(xNSign) * -x0;
+		F ay0 = toFloat(yNSign) * -y0;
+		F az0 = toFloat(zNSign) * -z0;
+
+		i = i * I(PrimeX) + I(xOrigin);
+		j = j * I(PrimeY) + I(yOrigin);
+		k = k * I(PrimeZ) + I(zOrigin);
+
+		F value = 0.0f;
+
+		F a = (F(0.6f) - x0 * x0) - (y0 * y0 + z0 * z0);
+		for (int l = 0; l < 2; l++)
+		{
+			value = value + falloff(a, gradCoord(p, seed, i, j, k, x0, y0, z0));
+
+			M useX = (ax0 >= ay0) & (ax0 >= az0);
+			M useY = andNot(useX, (ay0 > ax0) & (ay0 >= az0));
+			M useXY = useX | useY;
+
+			F x1 = select(useX, x0 + toFloat(xNSign), x0);
+			F y1 = select(useY, y0 + toFloat(yNSign), y0);
+			F z1 = select(useXY, z0, z0 + toFloat(zNSign));
+
+			F b = (a + 1.0f) - select(useX, toFloat(xNSign * I(2)) * x1,
+									  select(useY, toFloat(yNSign * I(2)) * y1, toFloat(zNSign * I(2)) * z1));
+
+			I i1 = select(useX, i - xNSign * I(PrimeX), i);
+			I j1 = select(useY, j - yNSign * I(PrimeY), j);
+			I k1 = select(useXY, k, k - zNSign * I(PrimeZ));
+
+			value = value + falloff(b, gradCoord(p, seed, i1, j1, k1, x1, y1, z1));
+
+			if (l == 1) break;
+
+			ax0 = F(0.5f) - ax0;
+			ay0 = F(0.5f) - ay0;
+			az0 = F(0.5f) - az0;
+
+			x0 = toFloat(xNSign) * ax0;
+			y0 = toFloat(yNSign) * ay0;
+			z0 = toFloat(zNSign) * az0;
+
+			a = a + ((F(0.75f) - ax0) - (ay0 + az0));
+
+			i = i + ((xNSign >> 1) & I(PrimeX));
+			j = j + ((yNSign >> 1) & I(PrimeY));
+			k = k + ((zNSign >> 1) & I(PrimeZ));
+
+			xNSign = I(0) - xNSign;
+			yNSign = I(0) - yNSign;
+			zNSign = I(0) - zNSign;
+
+			seed += 1293373;
+		}
+
+		return value * 32.69428253173828125f;
+	}
+
+	// OpenSimplex2S Noise
+
+	static F singleOpenSimplex2S(const NoiseParams& p, int seed, F x, F y, int xOrigin, int yOrigin)
+	{
+		const float SQRT3 = (float)1.7320508075688772935274463415059;
+		const float G2 = (3 - SQRT3) / 6;
+
+		I i = fastFloor(x);
+		I j = fastFloor(y);
+		F xi = x - toFloat(i);
+		F yi = y - toFloat(j);
+
+		i = i * I(PrimeX) + I(xOrigin);
+		j = j * I(PrimeY) + I(yOrigin);
+		I i1 = i + I(PrimeX);
+		I j1 = j + I(PrimeY);
+
+		F t = (xi + yi) * (float)G2;
+		F x0 = xi - t;
+		F y0 = yi - t;
+
+		F a0 = F(2.0f / 3.0f) - x0 * x0 - y0 * y0;
+		F value = (a0 * a0) * (a0 * a0) * gradCoord(p, seed, i, j, x0, y0);
+
+		F a1 = F((float)(2 * (1 - 2 * G2) * (1 / G2 - 2))) * t + (F((float)(-2 * (1 - 2 * G2) * (1 - 2 * G2))) + a0);
+		F x1 = x0 - (float)(1 - 2 * G2);
+		F y1 = y0 - (float)(1 - 2 * G2);
+		value = value + (a1 * a1) * (a1 * a1) * gradCoord(p, seed, i1, j1, x1, y1);
+
+		// The scalar nested conditionals pick two more points out of four candidates each
+		F xmyi = xi - yi;
+		M upper = t > F(G2);
+
+		M far2 = select(upper, xi + xmyi > F(1.0f), xi + xmyi < F(0.0f));
+		F x2 = x0 + select(upper,
+						   select(far2, F((float)(3 * G2 - 2)), F((float)G2)),
+						   select(far2, F((float)(1 - G2)), F((float)(G2 - 1))));
+		F y2 = y0 + select(upper,
+						   select(far2, F((float)(3 * G2 - 1)), F((float)(G2 - 1))),
+						   select(far2, -F((float)G2), F((float)G2)));
+		I i2 = i + select(upper, select(far2, I(PrimeX2), I(0)), select(far2, I(-PrimeX), I(PrimeX)));
+		I j2 = j + select(upper, I(PrimeY), I(0));
+		F a2 = F(2.0f / 3.0f) - x2 * x2 - y2 * y2;
+		value = value + falloff(a2, gradCoord(p, seed, i2, j2, x2, y2));
+
+		M far3 = select(upper, yi - xmyi > F(1.0f), yi < xmyi);
+		F x3 = x0 + select(upper,
+						   select(far3, F((float)(3 * G2 - 1)), F((float)(G2 - 1))),
+						   select(far3, -F((float)G2), F((float)G2)));
+		F y3 = y0 + select(upper,
+						   select(far3, F((float)(3 * G2 - 2)), F((float)G2)),
+						   select(far3, -F((float)(G2 - 1)), F((float)(G2 - 1))));
+		I i3 = i + select(upper, I(PrimeX), I(0));
+		I j3 = j + select(upper, select(far3, I(PrimeY2), I(0)), select(far3, I(-PrimeY), I(PrimeY)));
+		F a3 = F(2.0f / 3.0f) - x3 * x3 - y3 * y3;
+		value = value + falloff(a3, gradCoord(p, seed, i3, j3, x3, y3));
+
+		return value * 18.24196194486065f;
+	}
+
+	static F singleOpenSimplex2S(const NoiseParams& p, int seed, F x, F y, F z, int xOrigin, int yOrigin, int zOrigin)
+	{
+		I i = fastFloor(x);
+		I j = fastFloor(y);
+		I k = fastFloor(z);
+		F xi = x - toFloat(i);
+		F yi = y - toFloat(j);
+		F zi = z - toFloat(k);
+
+		i = i * I(PrimeX) + I(xOrigin);
+		j = j * I(PrimeY) + I(yOrigin);
+		k = k * I(PrimeZ) + I(zOrigin);
+		int seed2 = seed + 1293373;
+
+		I xNMask = truncate(F(-0.5f) - xi);
+		I yNMask = truncate(F(-0.5f) - yi);
+		I zNMask = truncate(F(-0.5f) - zi);
+
+		I xSign = xNMask | I(1);
+		I ySign = yNMask | I(1);
+		I zSign = zNMask | I(1);
+		F xSignF = toFloat(xSign);
+		F ySignF = toFloat(ySign);
+		F zSignF = toFloat(zSign);
+
+		// Primed offsets of the near (NMask) and far (~NMask) corners of the first cube
+		I iNear = i + (xNMask & I(PrimeX));
+		I jNear = j + (yNMask & I(PrimeY));
+		I kNear = k + (zNMask & I(PrimeZ));
+		I iFar = i + (~xNMask & I(PrimeX));
+		I jFar = j + (~yNMask & I(PrimeY));
+		I kFar = k + (~zNMask & I(PrimeZ));
+
+		F x0 = xi + toFloat(xNMask);
+		F y0 = yi + toFloat(yNMask);
+		F z0 = zi + toFloat(zNMask);
+		F a0 = F(0.75f) - x0 * x0 - y0 * y0 - z0 * z0;
+		F value = (a0 * a0) * (a0 * a0) * gradCoord(p, seed, iNear, jNear, kNear, x0, y0, z0);
+
+		F x1 = xi - 0.5f;
+		F y1 = yi - 0.5f;
+		F z1 = zi - 0.5f;
+		F a1 = F(0.75f) - x1 * x1 - y1 * y1 - z1 * z1;
+		value = value + (a1 * a1) * (a1 * a1) * gradCoord(p, seed2, i + I(PrimeX), j + I(PrimeY), k + I(PrimeZ), x1, y1, z1);
+
+		F xAFlipMask0 = toFloat(xSign << 1) * x1;
+		F yAFlipMask0 = toFloat(ySign << 1) * y1;
+		F zAFlipMask0 = toFloat(zSign << 1) * z1;
+		F xAFlipMask1 = toFloat(I(-2) - (xNMask << 2)) * x1 - 1.0f;
+		F yAFlipMask1 = toFloat(I(-2) - (yNMask << 2)) * y1 - 1.0f;
+		F zAFlipMask1 = toFloat(I(-2) - (zNMask << 2)) * z1 - 1.0f;
+
+		// Second cube offsets, doubled primes only where the mask is set
+		I iSecond = i + (xNMask & I(PrimeX2));
+		I jSecond = j + (yNMask & I(PrimeY2));
+		I kSecond = k + (zNMask & I(PrimeZ2));
+
+		F x0Flip = x0 - xSignF;
+		F y0Flip = y0 - ySignF;
+		F z0Flip = z0 - zSignF;
+		F x1Flip = xSignF + x1;
+		F y1Flip = ySignF + y1;
+		F z1Flip = zSignF + z1;
+
+		F a2 = xAFlipMask0 + a0;
+		M use2 = a2 > F(0.0f);
+		value = value + falloff(a2, gradCoord(p, seed, iFar, jNear, kNear, x0Flip, y0, z0));
+
+		F a3 = yAFlipMask0 + zAFlipMask0 + a0;
+		value = value + select(use2, F(0.0f), falloff(a3, gradCoord(p, seed, iNear, jFar, kFar, x0, y0Flip, z0Flip)));
+
+		F a4 = xAFlipMask1 + a1;
+		M skip5 = andNot(use2, a4 > F(0.0f));
+		value = value + select(skip5, (a4 * a4) * (a4 * a4) * gradCoord(p, seed2, iSecond, j + I(PrimeY), k + I(PrimeZ), x1Flip, y1, z1), F(0.0f));
+
+		F a6 = yAFlipMask0 + a0;
+		M use6 = a6 > F(0.0f);
+		value = value + falloff(a6, gradCoord(p, seed, iNear, jFar, kNear, x0, y0Flip, z0));
+
+		F a7 = xAFlipMask0 + zAFlipMask0 + a0;
+		value = value + select(use6, F(0.0f), falloff(a7, gradCoord(p, seed, iFar, jNear, kFar, x0Flip, y0, z0Flip)));
+
+		F a8 = yAFlipMask1 + a1;
+		M skip9 = andNot(use6, a8 > F(0.0f));
+		value = value + select(skip9, (a8 * a8) * (a8 * a8) * gradCoord(p, seed2, i + I(PrimeX), jSecond, k + I(PrimeZ), x1, y1Flip, z1), F(0.0f));
+
+		F aA = zAFlipMask0 + a0;
+		M useA = aA > F(0.0f);
+		value = value + falloff(aA, gradCoord(p, seed, iNear, jNear, kFar, x0, y0, z0Flip));
+
+		F aB = xAFlipMask0 + yAFlipMask0 + a0;
+		value = value + select(useA, F(0.0f), falloff(aB, gradCoord(p, seed, iFar, jFar, kNear, x0Flip, y0Flip, z0)));
+
+		F aC = zAFlipMask1 + a1;
+		M skipD = andNot(useA, aC > F(0.0f));
+		value = value + select(skipD, (aC * aC) * (aC * aC) * gradCoord(p, seed2, i + I(PrimeX), j + I(PrimeY), kSecond, x1, y1, z1Flip), F(0.0f));
+
+		F a5 = yAFlipMask1 + zAFlipMask1 + a1;
+		value = value + select(skip5, F(0.0f), falloff(a5, gradCoord(p, seed2, i + I(PrimeX), jSecond, kSecond, x1, y1Flip, z1Flip)));
+
+		F a9 = xAFlipMask1 + zAFlipMask1 + a1;
+		value = value + select(skip9, F(0.0f), falloff(a9, gradCoord(p, seed2, iSecond, j + I(PrimeY), kSecond, x1Flip, y1, z1Flip)));
+
+		F aD = xAFlipMask1 + yAFlipMask1 + a1;
+		value = value + select(skipD, F(0.0f), falloff(aD, gradCoord(p, seed2, iSecond, jSecond, k + I(PrimeZ), x1Flip, y1Flip, z1)));
+
+		return value * 9.046026385208288f;
+	}
+
+	// Cellular Noise
+	//
+	// Lanes are samples. The centre cell is searched first so its feature point bounds the rest of
+	// the 3x3(x3) neighbourhood, which then follows the scalar order. For the CellValue and
+	// Distance returns a cell is skipped when no lane can get as close to it as distance0, it
+	// could change neither distance0 nor the closest hash. The Distance2 returns would have to
+	// bound against distance1, which skips too few cells to pay for the extra branches.
+	//
+	// distance0 and distance1 are the two smallest distances whatever the order. The closest hash
+	// on a tie goes to the cell scanned first by the scalar code, which only differs from our
+	// order for cells before the centre, hence centreClosest.
+
+	template <CellularDistance D>
+	static F cellularDistance(F vecX, F vecY)
+	{
+		switch (D)
+		{
+		case CellularDistance::Manhattan:
+			return fastAbs(vecX) + fastAbs(vecY);
+		case CellularDistance::Hybrid:
+			return (fastAbs(vecX) + fastAbs(vecY)) + (vecX * vecX + vecY * vecY);
+		default:
+			return vecX * vecX + vecY * vecY;
+		}
+	}
+
+	template <CellularDistance D>
+	static F cellularDistance(F vecX, F vecY, F vecZ)
+	{
+		switch (D)
+		{
+		case CellularDistance::Manhattan:
+			return fastAbs(vecX) + fastAbs(vecY) + fastAbs(vecZ);
+		case CellularDistance::Hybrid:
+			return (fastAbs(vecX) + fastAbs(vecY) + fastAbs(vecZ)) + (vecX * vecX + vecY * vecY + vecZ * vecZ);
+		default:
+			return vecX * vecX + vecY * vecY + vecZ * vecZ;
+		}
+	}
+
+	// How far a feature point can move from its cell corner along one axis. RandVecs are unit
+	// vectors; the margin covers the rounding of the scalar vec computation.
+	static float cellularReach(float cellularJitter)
+	{
+		return (cellularJitter < 0.0f ? -cellularJitter : cellularJitter) + 1e-5f;
+	}
+
+	// Closest any feature point of the cell at cellCoord can get to x along that axis
+	static F cellularBound(F cellCoord, F x, float reach)
+	{
+		return max(fastAbs(cellCoord - x) - reach, F(0.0f));
+	}
+
+	static F cellularReturn(const NoiseParams& p, F distance0, F distance1, I closestHash)
+	{
+		if (p.cellularDistance == CellularDistance::Euclidean && p.cellularReturn >= CellularReturn::Distance)
+		{
+			distance0 = sqrt(distance0);
+
+			if (p.cellularReturn >= CellularReturn::Distance2)
+			{
+				distance1 = sqrt(distance1);
+			}
+		}
+
+		switch (p.cellularReturn)
+		{
+		case CellularReturn::CellValue:
+			return toFloat(closestHash) * (1 / 2147483648.0f);
+		case CellularReturn::Distance:
+			return distance0 - 1.0f;
+		case CellularReturn::Distance2:
+			return distance1 - 1.0f;
+		case CellularReturn::Distance2Add:
+			return (distance1 + distance0) * 0.5f - 1.0f;
+		case CellularReturn::Distance2Sub:
+			return distance1 - distance0 - 1.0f;
+		case CellularReturn::Distance2Mul:
+			return distance1 * distance0 * 0.5f - 1.0f;
+		case CellularReturn::Distance2Div:
+			return distance0 / distance1 - 1.0f;
+		default:
+			return F(0.0f);
+		}
+	}
+
+	template <CellularDistance D>
+	static F singleCellular(const NoiseParams& p, int seed, F x, F y, int xOrigin, int yOrigin)
+	{
+		I xr = fastRound(x);
+		I yr = fastRound(y);
+
+		F distance0 = 1e10f;
+		F distance1 = 1e10f;
+		I closestHash = 0;
+		M centreClosest = F(0.0f) < F(0.0f);
+
+		const float cellularJitter = 0.43701595f * p.cellularJitter;
+		const float reach = cellularReach(cellularJitter);
+		const bool skipCells = p.cellularReturn <= CellularReturn::Distance;
+
+		I xPrimed = xr * I(PrimeX) + I(xOrigin);
+		I yPrimed = yr * I(PrimeY) + I(yOrigin);
+
+		auto visit = [&](int xo, int yo)
+		{
+			F xCell = toFloat(xr + I(xo));
+			F yCell = toFloat(yr + I(yo));
+
+			if (skipCells && !any(cellularDistance<D>(cellularBound(xCell, x, reach), cellularBound(yCell, y, reach)) <= distance0))
+				return;
+
+			I h = hash(seed, xPrimed + I(xo * PrimeX), yPrimed + I(yo * PrimeY));
+			I idx = h & I(255 << 1);
+
+			F vecX = (xCell - x) + gather(p.randVecs2D, idx) * cellularJitter;
+			F vecY = (yCell - y) + gather(p.randVecs2D, idx | I(1)) * cellularJitter;
+
+			F newDistance = cellularDistance<D>(vecX, vecY);
+
+			distance1 = max(min(distance1, newDistance), distance0);
+			M closer = newDistance < distance0;
+			if (xo < 0 || (xo == 0 && yo < 0))
+				closer = closer | ((newDistance <= distance0) & centreClosest);
+			distance0 = select(closer, newDistance, distance0);
+			closestHash = select(closer, h, closestHash);
+			centreClosest = (xo == 0 && yo == 0) ? closer : andNot(closer, centreClosest);
+		};
+
+		visit(0, 0);
+		for (int xo = -1; xo <= 1; xo++)
+		{
+			for (int yo = -1; yo <= 1; yo++)
+			{
+				if (xo != 0 || yo != 0)
+					visit(xo, yo);
+			}
+		}
+
+		return cellularReturn(p, distance0, distance1, closestHash);
+	}
+
+	template <CellularDistance D>
+	static F singleCellular(const NoiseParams& p, int seed, F x, F y, F z, int xOrigin, int yOrigin, int zOrigin)
+	{
+		I xr = fastRound(x);
+		I yr = fastRound(y);
+		I zr = fastRound(z);
+
+		F distance0 = 1e10f;
+		F distance1 = 1e10f;
+		I closestHash = 0;
+		M centreClosest = F(0.0f) < F(0.0f);
+
+		const float cellularJitter = 0.39614353f * p.cellularJitter;
+		const float reach = cellularReach(cellularJitter);
+		const bool skipCells = p.cellularReturn <= CellularReturn::Distance;
+
+		I xPrimed = xr * I(PrimeX) + I(xOrigin);
+		I yPrimed = yr * I(PrimeY) + I(yOrigin);
+		I zPrimed = zr * I(PrimeZ) + I(zOrigin);
+
+		auto visit = [&](int xo, int yo, int zo)
+		{
+			F xCell = toFloat(xr + I(xo));
+			F yCell = toFloat(yr + I(yo));
+			F zCell = toFloat(zr + I(zo));
+
+			if (skipCells && !any(cellularDistance<D>(cellularBound(xCell, x, reach), cellularBound(yCell, y, reach), cellularBound(zCell, z, reach)) <= distance0))
+				return;
+
+			I h = hash(seed, xPrimed + I(xo * PrimeX), yPrimed + I(yo * PrimeY), zPrimed + I(zo * PrimeZ));
+			I idx = h & I(255 << 2);
+
+			F vecX = (xCell - x) + gather(p.randVecs3D, idx) * cellularJitter;
+			F vecY = (yCell - y) + gather(p.randVecs3D, idx | I(1)) * cellularJitter;
+			F vecZ = (zCell - z) + gather(p.randVecs3D, idx | I(2)) * cellularJitter;
+
+			F newDistance = cellularDistance<D>(vecX, vecY, vecZ);
+
+			distance1 = max(min(distance1, newDistance), distance0);
+			M closer = newDistance < distance0;
+			if (xo < 0 || (xo == 0 && (yo < 0 || (yo == 0 && zo < 0))))
+				closer = closer | ((newDistance <= distance0) & centreClosest);
+			distance0 = select(closer, newDistance, distance0);
+			closestHash = select(closer, h, closestHash);
+			centreClosest = (xo == 0 && yo == 0 && zo == 0) ? closer : andNot(closer, centreClosest);
+		};
+
+		visit(0, 0, 0);
+		for (int xo = -1; xo <= 1; xo++)
+		{
+			for (int yo = -1; yo <= 1; yo++)
+			{
+				for (int zo = -1; zo <= 1; zo++)
+				{
+					if (xo != 0 || yo != 0 || zo != 0)
+						visit(xo, yo, zo);
+				}
+			}
+		}
+
+		return cellularReturn(p, distance0, distance1, closestHash);
+	}
+
+	static F singleCellular(const NoiseParams& p, int seed, F x, F y, int xOrigin, int yOrigin)
+	{
+		switch (p.cellularDistance)
+		{
+		case CellularDistance::Manhattan:
+			return singleCellular<CellularDistance::Manhattan>(p, seed, x, y, xOrigin, yOrigin);
+		case CellularDistance::Hybrid:
+			return singleCellular<CellularDistance::Hybrid>(p, seed, x, y, xOrigin, yOrigin);
+		default:
+			return singleCellular<CellularDistance::EuclideanSq>(p, seed, x, y, xOrigin, yOrigin);
+		}
+	}
+
+	static F singleCellular(const NoiseParams& p, int seed, F x, F y, F z, int xOrigin, int yOrigin, int zOrigin)
+	{
+		switch (p.cellularDistance)
+		{
+		case CellularDistance::Manhattan:
+			return singleCellular<CellularDistance::Manhattan>(p, seed, x, y, z, xOrigin, yOrigin, zOrigin);
+		case CellularDistance::Hybrid:
+			return singleCellular<CellularDistance::Hybrid>(p, seed, x, y, z, xOrigin, yOrigin, zOrigin);
+		default:
+			return singleCellular<CellularDistance::EuclideanSq>(p, seed, x, y, z, xOrigin, yOrigin, zOrigin);
+		}
+	}
+
+	// Perlin Noise
+
+	static F singlePerlin(const NoiseParams& p, int seed, F x, F y, int xOrigin, int yOrigin)
+	{
+		I x0 = fastFloor(x);
+		I y0 = fastFloor(y);
+
+		F xd0 = x - toFloat(x0);
+		F yd0 = y - toFloat(y0);
+		F xd1 = xd0 - 1.0f;
+		F yd1 = yd0 - 1.0f;
+
+		F xs = interpQuintic(xd0);
+		F ys = interpQuintic(yd0);
+
+		x0 = x0 * I(PrimeX) + I(xOrigin);
+		y0 = y0 * I(PrimeY) + I(yOrigin);
+		I x1 = x0 + I(PrimeX);
+		I y1 = y0 + I(PrimeY);
+
+		F xf0 = lerp(gradCoord(p, seed, x0, y0, xd0, yd0), gradCoord(p, seed, x1, y0, xd1, yd0), xs);
+		F xf1 = lerp(gradCoord(p, seed, x0, y1, xd0, yd1), gradCoord(p, seed, x1, y1, xd1, yd1), xs);
+
+		return lerp(xf0, xf1, ys) * 1.4247691104677813f;
+	}
+
+	static F singlePerlin(const NoiseParams& p, int seed, F x, F y, F z, int xOrigin, int yOrigin, int zOrigin)
+	{
+		I x0 = fastFloor(x);
+		I y0 = fastFloor(y);
+		I z0 = fastFloor(z);
+
+		F xd0 = x - toFloat(x0);
+		F yd0 = y - toFloat(y0);
+		F zd0 = z - toFloat(z0);
+		F xd1 = xd0 - 1.0f;
+		F yd1 = yd0 - 1.0f;
+		F zd1 = zd0 - 1.0f;
+
+		F xs = interpQuintic(xd0);
+		F ys = interpQuintic(yd0);
+		F zs = interpQuintic(zd0);
+
+		x0 = x0 * I(PrimeX) + I(xOrigin);
+		y0 = y0 * I(PrimeY) + I(yOrigin);
+		z0 = z0 * I(PrimeZ) + I(zOrigin);
+		I x1 = x0 + I(PrimeX);
+		I y1 = y0 + I(PrimeY);
+		I z1 = z0 + I(PrimeZ);
+
+		F xf00 = lerp(gradCoord(p, seed, x0, y0, z0, xd0, yd0, zd0), gradCoord(p, seed, x1, y0, z0, xd1, yd0, zd0), xs);
+		F xf10 = lerp(gradCoord(p, seed, x0, y1, z0, xd0, yd1, zd0), gradCoord(p, seed, x1, y1, z0, xd1, yd1, zd0), xs);
+		F xf01 = lerp(gradCoord(p, seed, x0, y0, z1, xd0, yd0, zd1), gradCoord(p, seed, x1, y0, z1, xd1, yd0, zd1), xs);
+		F xf11 = lerp(gradCoord(p, seed, x0, y1, z1, xd0, yd1, zd1), gradCoord(p, seed, x1, y1, z1, xd1, yd1, zd1), xs);
+
+		F yf0 = lerp(xf00, xf10, ys);
+		F yf1 = lerp(xf01, xf11, ys);
+
+		return lerp(yf0, yf1, zs) * 0.964921414852142333984375f;
+	}
+
+	// Value Cubic Noise
+
+	static F cubicLerp(F a, F b, F c, F d, F t)
+	{
+		F p = (d - c) - (a - b);
+		return t * t * t * p + t * t * ((a - b) - p) + t * (c - a) + b;
+	}
+
+	static F singleValueCubic(int seed, F x, F y, int xOrigin, int yOrigin)
+	{
+		I x1 = fastFloor(x);
+		I y1 = fastFloor(y);
+
+		F xs = x - toFloat(x1);
+		F ys = y - toFloat(y1);
+
+		x1 = x1 * I(PrimeX) + I(xOrigin);
+		y1 = y1 * I(PrimeY) + I(yOrigin);
+		I x0 = x1 - I(PrimeX);
+		I y0 = y1 - I(PrimeY);
+		I x2 = x1 + I(PrimeX);
+		I y2 = y1 + I(PrimeY);
+		I x3 = x1 + I(PrimeX2);
+		I y3 = y1 + I(PrimeY2);
+
+		return cubicLerp(
+			cubicLerp(valCoord(seed, x0, y0), valCoord(seed, x1, y0), valCoord(seed, x2, y0), valCoord(seed, x3, y0), xs),
+			cubicLerp(valCoord(seed, x0, y1), valCoord(seed, x1, y1), valCoord(seed, x2, y1), valCoord(seed, x3, y1), xs),
+			cubicLerp(valCoord(seed, x0, y2), valCoord(seed, x1, y2), valCoord(seed, x2, y2), valCoord(seed, x3, y2), xs),
+			cubicLerp(valCoord(seed, x0, y3), valCoord(seed, x1, y3), valCoord(seed, x2, y3), valCoord(seed, x3, y3), xs),
+			ys) * F(1 / (1.5f * 1.5f));
+	}
+
+	// One xy plane of the 3D kernel, before the z interpolation
+	static F valueCubicPlane(int seed, const I (&xp)[4], const I (&yp)[4], I zPrimed, F xs, F ys)
+	{
+		F rows[4];
+		for (int j = 0; j < 4; j++)
+		{
+			rows[j] = cubicLerp(valCoord(seed, xp[0], yp[j], zPrimed), valCoord(seed, xp[1], yp[j], zPrimed),
+								valCoord(seed, xp[2], yp[j], zPrimed), valCoord(seed, xp[3], yp[j], zPrimed), xs);
+		}
+		return cubicLerp(rows[0], rows[1], rows[2], rows[3], ys);
+	}
+
+	static F singleValueCubic(int seed, F x, F y, F z, int xOrigin, int yOrigin, int zOrigin)
+	{
+		I x1 = fastFloor(x);
+		I y1 = fastFloor(y);
+		I z1 = fastFloor(z);
+
+		F xs = x - toFloat(x1);
+		F ys = y - toFloat(y1);
+		F zs = z - toFloat(z1);
+
+		x1 = x1 * I(PrimeX) + I(xOrigin);
+		y1 = y1 * I(PrimeY) + I(yOrigin);
+		z1 = z1 * I(PrimeZ) + I(zOrigin);
+
+		const I xp[4] = { x1 - I(PrimeX), x1, x1 + I(PrimeX), x1 + I(PrimeX2) };
+		const I yp[4] = { y1 - I(PrimeY), y1, y1 + I(PrimeY), y1 + I(PrimeY2) };
+
+		return cubicLerp(
+			valueCubicPlane(seed, xp, yp, z1 - I(PrimeZ), xs, ys),
+			valueCubicPlane(seed, xp, yp, z1, xs, ys),
+			valueCubicPlane(seed, xp, yp, z1 + I(PrimeZ), xs, ys),
+			valueCubicPlane(seed, xp, yp, z1 + I(PrimeZ2), xs, ys),
+			zs) * F(1 / (1.5f * 1.5f * 1.5f));
+	}
+
+	// Value Noise
+
+	static F singleValue(int seed, F x, F y, int xOrigin, int yOrigin)
+	{
+		I x0 = fastFloor(x);
+		I y0 = fastFloor(y);
+
+		F xs = interpHermite(x - toFloat(x0));
+		F ys = interpHermite(y - toFloat(y0));
+
+		x0 = x0 * I(PrimeX) + I(xOrigin);
+		y0 = y0 * I(PrimeY) + I(yOrigin);
+		I x1 = x0 + I(PrimeX);
+		I y1 = y0 + I(PrimeY);
+
+		F xf0 = lerp(valCoord(seed, x0, y0), valCoord(seed, x1, y0), xs);
+		F xf1 = lerp(valCoord(seed, x0, y1), valCoord(seed, x1, y1), xs);
+
+		return lerp(xf0, xf1, ys);
+	}
+
+	static F singleValue(int seed, F x, F y, F z, int xOrigin, int yOrigin, int zOrigin)
+	{
+		I x0 = fastFloor(x);
+		I y0 = fastFloor(y);
+		I z0 = fastFloor(z);
+
+		F xs = interpHermite(x - toFloat(x0));
+		F ys = interpHermite(y - toFloat(y0));
+		F zs = interpHermite(z - toFloat(z0));
+
+		x0 = x0 * I(PrimeX) + I(xOrigin);
+		y0 = y0 * I(PrimeY) + I(yOrigin);
+		z0 = z0 * I(PrimeZ) + I(zOrigin);
+		I x1 = x0 + I(PrimeX);
+		I y1 = y0 + I(PrimeY);
+		I z1 = z0 + I(PrimeZ);
+
+		F xf00 = lerp(valCoord(seed, x0, y0, z0), valCoord(seed, x1, y0, z0), xs);
+		F xf10 = lerp(valCoord(seed, x0, y1, z0), valCoord(seed, x1, y1, z0), xs);
+		F xf01 = lerp(valCoord(seed, x0, y0, z1), valCoord(seed, x1, y0, z1), xs);
+		F xf11 = lerp(valCoord(seed, x0, y1, z1), valCoord(seed, x1, y1, z1), xs);
+
+		F yf0 = lerp(xf00, xf10, ys);
+		F yf1 = lerp(xf01, xf11, ys);
+
+		return lerp(yf0, yf1, zs);
+	}
+
+	// Generic noise gen, resolved at compile time
+
+	// xOrigin, yOrigin and zOrigin are added to the primed lattice coordinates, see OctaveOrigin
+
+	template <Basis B>
+	static F single2D(const NoiseParams& p, int seed, F x, F y, int xOrigin = 0, int yOrigin = 0)
+	{
+		switch (B)
+		{
+		case Basis::OpenSimplex2:
+			return singleSimplex(p, seed, x, y, xOrigin, yOrigin);
+		case Basis::OpenSimplex2S:
+			return singleOpenSimplex2S(p, seed, x, y, xOrigin, yOrigin);
+		case Basis::Cellular:
+			return singleCellular(p, seed, x, y, xOrigin, yOrigin);
+		case Basis::Perlin:
+			return singlePerlin(p, seed, x, y, xOrigin, yOrigin);
+		case Basis::ValueCubic:
+			return singleValueCubic(seed, x, y, xOrigin, yOrigin);
+		case Basis::Value:
+			return singleValue(seed, x, y, xOrigin, yOrigin);
+		default:
+			return F(0.0f);
+		}
+	}
+
+	template <Basis B>
+	static F single3D(const NoiseParams& p, int seed, F x, F y, F z, int xOrigin = 0, int yOrigin = 0, int zOrigin = 0)
+	{
+		switch (B)
+		{
+		case Basis::OpenSimplex2:
+			return singleOpenSimplex2(p, seed, x, y, z, xOrigin, yOrigin, zOrigin);
+		case Basis::OpenSimplex2S:
+			return singleOpenSimplex2S(p, seed, x, y, z, xOrigin, yOrigin, zOrigin);
+		case Basis::Cellular:
+			return singleCellular(p, seed, x, y, z, xOrigin, yOrigin, zOrigin);
+		case Basis::Perlin:
+			return singlePerlin(p, seed, x, y, z, xOrigin, yOrigin, zOrigin);
+		case Basis::ValueCubic:
+			return singleValueCubic(seed, x, y, z, xOrigin, yOrigin, zOrigin);
+		case Basis::Value:
+			return singleValue(seed, x, y, z, xOrigin, yOrigin, zOrigin);
+		default:
+			return F(0.0f);
+		}
+	}
+
+	// Single noise of octave o; with a tile origin the coordinates are tile relative and the origin's
+	// remainder and lattice cell of that octave are added back
+
+	template <Basis B>
+	static F octave2D(const NoiseParams& p, const OctaveOrigin* origin, int o, int seed, F x, F y)
+	{
+		if (!origin)
+			return single2D<B>(p, seed, x, y);
+		return single2D<B>(p, seed, x + origin[o].x, y + origin[o].y, origin[o].xPrimed, origin[o].yPrimed);
+	}
+
+	template <Basis B>
+	static F octave3D(const NoiseParams& p, const OctaveOrigin* origin, int o, int seed, F x, F y, F z)
+	{
+		if (!origin)
+			return single3D<B>(p, seed, x, y, z);
+		return single3D<B>(p, seed, x + origin[o].x, y + origin[o].y, z + origin[o].z, origin[o].xPrimed, origin[o].yPrimed, origin[o].zPrimed);
+	}
+
+	// Fractal FBm
+
+	template <Basis B>
+	static F fractalFBm2D(const NoiseParams& p, F x, F y, const OctaveOrigin* origin)
+	{
+		int seed = p.seed;
+		F sum = 0.0f;
+		F amp = p.fractalBounding;
+
+		for (int o = 0; o < p.octaves; o++)
+		{
+			F noise = octave2D<B>(p, origin, o, seed++, x, y);
+			sum = sum + noise * amp;
+			amp = amp * lerp(F(1.0f), min(noise + 1.0f, F(2.0f)) * 0.5f, F(p.weightedStrength));
+
+			x = x * p.lacunarity;
+			y = y * p.lacunarity;
+			amp = amp * p.gain;
+		}
+
+		return sum;
+	}
+
+	template <Basis B>
+	static F fractalFBm3D(const NoiseParams& p, F x, F y, F z, const OctaveOrigin* origin)
+	{
+		int seed = p.seed;
+		F sum = 0.0f;
+		F amp = p.fractalBounding;
+
+		for (int o = 0; o < p.octaves; o++)
+		{
+			F noise = octave3D<B>(p, origin, o, seed++, x, y, z);
+			sum = sum + noise * amp;
+			amp = amp * lerp(F(1.0f), (noise + 1.0f) * 0.5f, F(p.weightedStrength));
+
+			x = x * p.lacunarity;
+			y = y * p.lacunarity;
+			z = z * p.lacunarity;
+			amp = amp * p.gain;
+		}
+
+		return sum;
+	}
+
+	// Fractal Ridged
+
+	template <Basis B>
+	static F fractalRidged2D(const NoiseParams& p, F x, F y, const OctaveOrigin* origin)
+	{
+		int seed = p.seed;
+		F sum = 0.0f;
+		F amp = p.fractalBounding;
+
+		for (int o = 0; o < p.octaves; o++)
+		{
+			F noise = fastAbs(octave2D<B>(p, origin, o, seed++, x, y));
+			sum = sum + (noise * -2.0f + 1.0f) * amp;
+			amp = amp * lerp(F(1.0f), 1.0f - noise, F(p.weightedStrength));
+
+			x = x * p.lacunarity;
+			y = y * p.lacunarity;
+			amp = amp * p.gain;
+		}
+
+		return sum;
+	}
+
+	template <Basis B>
+	static F fractalRidged3D(const NoiseParams& p, F x, F y, F z, const OctaveOrigin* origin)
+	{
+		int seed = p.seed;
+		F sum = 0.0f;
+		F amp = p.fractalBounding;
+
+		for (int o = 0; o < p.octaves; o++)
+		{
+			F noise = fastAbs(octave3D<B>(p, origin, o, seed++, x, y, z));
+			sum = sum + (noise * -2.0f + 1.0f) * amp;
+			amp = amp * lerp(F(1.0f), 1.0f - noise, F(p.weightedStrength));
+
+			x = x * p.lacunarity;
+			y = y * p.lacunarity;
+			z = z * p.lacunarity;
+			amp = amp * p.gain;
+		}
+
+		return sum;
+	}
+
+	// Fractal PingPong
+
+	template <Basis B>
+	static F fractalPingPong2D(const NoiseParams& p, F x, F y, const OctaveOrigin* origin)
+	{
+		int seed = p.seed;
+		F sum = 0.0f;
+		F amp = p.fractalBounding;
+
+		for (int o = 0; o < p.octaves; o++)
+		{
+			F noise = pingPong((octave2D<B>(p, origin, o, seed++, x, y) + 1.0f) * p.pingPongStrength);
+			sum = sum + (noise - 0.5f) * 2.0f * amp;
+			amp = amp * lerp(F(1.0f), noise, F(p.weightedStrength));
+
+			x = x * p.lacunarity;
+			y = y * p.lacunarity;
+			amp = amp * p.gain;
+		}
+
+		return sum;
+	}
+
+	template <Basis B>
+	static F fractalPingPong3D(const NoiseParams& p, F x, F y, F z, const OctaveOrigin* origin)
+	{
+		int seed = p.seed;
+		F sum = 0.0f;
+		F amp = p.fractalBounding;
+
+		for (int o = 0; o < p.octaves; o++)
+		{
+			F noise = pingPong((octave3D<B>(p, origin, o, seed++, x, y, z) + 1.0f) * p.pingPongStrength);
+			sum = sum + (noise - 0.5f) * 2.0f * amp;
+			amp = amp * lerp(F(1.0f), noise, F(p.weightedStrength));
+
+			x = x * p.lacunarity;
+			y = y * p.lacunarity;
+			z = z * p.lacunarity;
+			amp = amp * p.gain;
+		}
+
+		return sum;
+	}
+
+	template <Basis B, Fractal Fr>
+	static F fractal2D(const NoiseParams& p, F x, F y, const OctaveOrigin* origin = nullptr)
+	{
+		switch (Fr)
+		{
+		case Fractal::FBm:
+			return fractalFBm2D<B>(p, x, y, origin);
+		case Fractal::Ridged:
+			return fractalRidged2D<B>(p, x, y, origin);
+		case Fractal::PingPong:
+			return fractalPingPong2D<B>(p, x, y, origin);
+		default:
+			return octave2D<B>(p, origin, 0, p.seed, x, y);
+		}
+	}
+
+	template <Basis B, Fractal Fr>
+	static F fractal3D(const NoiseParams& p, F x, F y, F z, const OctaveOrigin* origin = nullptr)
+	{
+		switch (Fr)
+		{
+		case Fractal::FBm:
+			return fractalFBm3D<B>(p, x, y, z, origin);
+		case Fractal::Ridged:
+			return fractalRidged3D<B>(p, x, y, z, origin);
+		case Fractal::PingPong:
+			return fractalPingPong3D<B>(p, x, y, z, origin);
+		default:
+			return octave3D<B>(p, origin, 0, p.seed, x, y, z);
+		}
+	}
+
+	// Coordinate transforms, frequency already applied
+
+	static void transformNoiseCoordinate(Basis basis, F& x, F& y)
+	{
+		if (basis == Basis::OpenSimplex2 || basis == Basis::OpenSimplex2S)
+		{
+			const float SQRT3 = (float)1.7320508075688772935274463415059;
+			const float F2 = 0.5f * (SQRT3 - 1);
+			F t = (x + y) * F2;
+			x = x + t;
+			y = y + t;
+		}
+	}
+
+	static void transformNoiseCoordinate(Transform3D transform, F& x, F& y, F& z)
+	{
+		switch (transform)
+		{
+		case Transform3D::ImproveXYPlanes:
+		{
+			F xy = x + y;
+			F s2 = xy * -(float)0.211324865405187;
+			z = z * (float)0.577350269189626;
+			x = x + (s2 - z);
+			y = y + s2 - z;
+			z = z + xy * (float)0.577350269189626;
+		}
+		break;
+		case Transform3D::ImproveXZPlanes:
+		{
+			F xz = x + z;
+			F s2 = xz * -(float)0.211324865405187;
+			y = y * (float)0.577350269189626;
+			x = x + (s2 - y);
+			z = z + (s2 - y);
+			y = y + xz * (float)0.577350269189626;
+		}
+		break;
+		case Transform3D::DefaultOpenSimplex2:
+		{
+			const float R3 = (float)(2.0 / 3.0);
+			F r = (x + y + z) * R3; // Rotation, not skew
+			x = r - x;
+			y = r - y;
+			z = r - z;
+		}
+		break;
+		default:
+			break;
+		}
+	}
+
+	// Domain Warp
+	//
+	// Ports of FastNoiseLite::DomainWarp(x, y). Amplitude and frequency schedules are scalar like
+	// in the original; a corner outside the kernel radius adds +0 where the scalar code skips it,
+	// which leaves the sum unchanged.
+
+	static void warpGradOut(const NoiseParams& p, int seed, I xPrimed, I yPrimed, F& xo, F& yo)
+	{
+		I h = hash(seed, xPrimed, yPrimed) & I(255 << 1);
+
+		xo = gather(p.randVecs2D, h);
+		yo = gather(p.randVecs2D, h | I(1));
+	}
+
+	static void warpGradDual(const NoiseParams& p, int seed, I xPrimed, I yPrimed, F xd, F yd, F& xo, F& yo)
+	{
+		I h = hash(seed, xPrimed, yPrimed);
+		I index1 = h & I(127 << 1);
+		I index2 = (h >> 7) & I(255 << 1);
+
+		F value = xd * gather(p.gradients2D, index1) + yd * gather(p.gradients2D, index1 | I(1));
+
+		xo = value * gather(p.randVecs2D, index2);
+		yo = value * gather(p.randVecs2D, index2 | I(1));
+	}
+
+	template <bool OutGradOnly>
+	static void warpCorner(const NoiseParams& p, int seed, I xPrimed, I yPrimed, F xd, F yd, F a, F& vx, F& vy)
+	{
+		F xo, yo;
+		if (OutGradOnly)
+			warpGradOut(p, seed, xPrimed, yPrimed, xo, yo);
+		else
+			warpGradDual(p, seed, xPrimed, yPrimed, xd, yd, xo, yo);
+
+		M inside = a > F(0.0f);
+		F aaaa = (a * a) * (a * a);
+		vx = vx + select(inside, aaaa * xo, F(0.0f));
+		vy = vy + select(inside, aaaa * yo, F(0.0f));
+	}
+
+	template <bool OutGradOnly>
+	static void singleWarpSimplexGradient(const NoiseParams& p, int seed, float warpAmp, float frequency, F x, F y, F& xr, F& yr)
+	{
+		const float SQRT3 = 1.7320508075688772935274463415059f;
+		const float G2 = (3 - SQRT3) / 6;
+
+		x = x * frequency;
+		y = y * frequency;
+
+		I i = fastFloor(x);
+		I j = fastFloor(y);
+		F xi = x - toFloat(i);
+		F yi = y - toFloat(j);
+
+		F t = (xi + yi) * G2;
+		F x0 = xi - t;
+		F y0 = yi - t;
+
+		i = i * I(PrimeX);
+		j = j * I(PrimeY);
+
+		F vx = 0.0f;
+		F vy = 0.0f;
+
+		F a = F(0.5f) - x0 * x0 - y0 * y0;
+		warpCorner<OutGradOnly>(p, seed, i, j, x0, y0, a, vx, vy);
+
+		F c = F((float)(2 * (1 - 2 * G2) * (1 / G2 - 2))) * t + (F((float)(-2 * (1 - 2 * G2) * (1 - 2 * G2))) + a);
+		F x2 = x0 + (2 * (float)G2 - 1);
+		F y2 = y0 + (2 * (float)G2 - 1);
+		warpCorner<OutGradOnly>(p, seed, i + I(PrimeX), j + I(PrimeY), x2, y2, c, vx, vy);
+
+		M upper = y0 > x0;
+		F x1 = x0 + select(upper, F((float)G2), F((float)G2 - 1));
+		F y1 = y0 + select(upper, F((float)G2 - 1), F((float)G2));
+		I i1 = select(upper, i, i + I(PrimeX));
+		I j1 = select(upper, j + I(PrimeY), j);
+		F b = F(0.5f) - x1 * x1 - y1 * y1;
+		warpCorner<OutGradOnly>(p, seed, i1, j1, x1, y1, b, vx, vy);
+
+		xr = xr + vx * warpAmp;
+		yr = yr + vy * warpAmp;
+	}
+
+	static void singleWarpBasicGrid(const NoiseParams& p, int seed, float warpAmp, float frequency, F x, F y, F& xr, F& yr)
+	{
+		F xf = x * frequency;
+		F yf = y * frequency;
+
+		I x0 = fastFloor(xf);
+		I y0 = fastFloor(yf);
+
+		F xs = interpHermite(xf - toFloat(x0));
+		F ys = interpHermite(yf - toFloat(y0));
+
+		x0 = x0 * I(PrimeX);
+		y0 = y0 * I(PrimeY);
+		I x1 = x0 + I(PrimeX);
+		I y1 = y0 + I(PrimeY);
+
+		I hash0 = hash(seed, x0, y0) & I(255 << 1);
+		I hash1 = hash(seed, x1, y0) & I(255 << 1);
+
+		F lx0x = lerp(gather(p.randVecs2D, hash0), gather(p.randVecs2D, hash1), xs);
+		F ly0x = lerp(gather(p.randVecs2D, hash0 | I(1)), gather(p.randVecs2D, hash1 | I(1)), xs);
+
+		hash0 = hash(seed, x0, y1) & I(255 << 1);
+		hash1 = hash(seed, x1, y1) & I(255 << 1);
+
+		F lx1x = lerp(gather(p.randVecs2D, hash0), gather(p.randVecs2D, hash1), xs);
+		F ly1x = lerp(gather(p.randVecs2D, hash0 | I(1)), gather(p.randVecs2D, hash1 | I(1)), xs);
+
+		xr = xr + lerp(lx0x, lx1x, ys) * warpAmp;
+		yr = yr + lerp(ly0x, ly1x, ys) * warpAmp;
+	}
+
+	static void singleWarp(const NoiseParams& p, int seed, float amp, float freq, F x, F y, F& xr, F& yr)
+	{
+		switch (p.warpType)
+		{
+		case DomainWarp::OpenSimplex2Reduced:
+			singleWarpSimplexGradient<true>(p, seed, amp * 16.0f, freq, x, y, xr, yr);
+			break;
+		case DomainWarp::BasicGrid:
+			singleWarpBasicGrid(p, seed, amp, freq, x, y, xr, yr);
+			break;
+		default:
+			singleWarpSimplexGradient<false>(p, seed, amp * 38.283687591552734375f, freq, x, y, xr, yr);
+			break;
+		}
+	}
+
+	static void transformWarpCoordinate(const NoiseParams& p, F& x, F& y)
+	{
+		// both simplex warps use the OpenSimplex2 skew, the grid warp none
+		if (p.warpType != DomainWarp::BasicGrid)
+			transformNoiseCoordinate(Basis::OpenSimplex2, x, y);
+	}
+
+	static void domainWarp(const NoiseParams& p, F& x, F& y)
+	{
+		int seed = p.seed;
+		float amp = p.warpAmp * p.fractalBounding;
+		float freq = p.frequency;
+
+		switch (p.warpFractal)
+		{
+		case WarpFractal::Progressive:
+			for (int o = 0; o < p.octaves; o++)
+			{
+				F xs = x;
+				F ys = y;
+				transformWarpCoordinate(p, xs, ys);
+
+				singleWarp(p, seed, amp, freq, xs, ys, x, y);
+
+				seed++;
+				amp *= p.gain;
+				freq *= p.lacunarity;
+			}
+			break;
+		case WarpFractal::Independent:
+		{
+			F xs = x;
+			F ys = y;
+			transformWarpCoordinate(p, xs, ys);
+
+			for (int o = 0; o < p.octaves; o++)
+			{
+				singleWarp(p, seed, amp, freq, xs, ys, x, y);
+
+				seed++;
+				amp *= p.gain;
+				freq *= p.lacunarity;
+			}
+		}
+		break;
+		default:
+		{
+			F xs = x;
+			F ys = y;
+			transformWarpCoordinate(p, xs, ys);
+
+			singleWarp(p, seed, amp, freq, xs, ys, x, y);
+		}
+		break;
+		}
+	}
+
+	// Uniform Grid
+
+	template <Basis B, Fractal Fr>
+	static void uniformGrid2DFixed(const NoiseParams& p, const OctaveOrigin* origin, float* noiseOut, int xStart, int yStart, int xSize, int ySize, float step)
+	{
+		for (int yi = 0; yi < ySize; yi++)
+		{
+			F yCoord = (float)(yStart + yi) * step * p.frequency;
+
+			for (int xi = 0; xi < xSize; xi += V::Lanes)
+			{
+				F x = toFloat(I(xStart + xi) + V::iota()) * step * p.frequency;
+				F y = yCoord;
+				transformNoiseCoordinate(B, x, y);
+
+				F noise = fractal2D<B, Fr>(p, x, y, origin);
+
+				if (xSize - xi >= V::Lanes)
+					store(noiseOut + xi, noise);
+				else
+					storePartial(noiseOut + xi, noise, xSize - xi);
+			}
+			noiseOut += xSize;
+		}
+	}
+
+	template <Basis B, Fractal Fr>
+	static void uniformGrid3DFixed(const NoiseParams& p, const OctaveOrigin* origin, float* noiseOut, int xStart, int yStart, int zStart, int xSize, int ySize, int zSize, float step)
+	{
+		for (int zi = 0; zi < zSize; zi++)
+		{
+			F zCoord = (float)(zStart + zi) * step * p.frequency;
+
+			for (int yi = 0; yi < ySize; yi++)
+			{
+				F yCoord = (float)(yStart + yi) * step * p.frequency;
+
+				for (int xi = 0; xi < xSize; xi += V::Lanes)
+				{
+					F x = toFloat(I(xStart + xi) + V::iota()) * step * p.frequency;
+					F y = yCoord;
+					F z = zCoord;
+					transformNoiseCoordinate(p.transform3D, x, y, z);
+
+					F noise = fractal3D<B, Fr>(p, x, y, z, origin);
+
+					if (xSize - xi >= V::Lanes)
+						store(noiseOut + xi, noise);
+					else
+						storePartial(noiseOut + xi, noise, xSize - xi);
+				}
+				noiseOut += xSize;
+			}
+		}
+	}
+
+	template <Basis B>
+	static void uniformGrid2DBasis(const NoiseParams& p, const OctaveOrigin* origin, float* noiseOut, int xStart, int yStart, int xSize, int ySize, float step)
+	{
+		switch (p.fractal)
+		{
+		case Fractal::FBm:
+			uniformGrid2DFixed<B, Fractal::FBm>(p, origin, noiseOut, xStart, yStart, xSize, ySize, step);
+			break;
+		case Fractal::Ridged:
+			uniformGrid2DFixed<B, Fractal::Ridged>(p, origin, noiseOut, xStart, yStart, xSize, ySize, step);
+			break;
+		case Fractal::PingPong:
+			uniformGrid2DFixed<B, Fractal::PingPong>(p, origin, noiseOut, xStart, yStart, xSize, ySize, step);
+			break;
+		default:
+			uniformGrid2DFixed<B, Fractal::None>(p, origin, noiseOut, xStart, yStart, xSize, ySize, step);
+			break;
+		}
+	}
+
+	template <Basis B>
+	static void uniformGrid3DBasis(const NoiseParams& p, const OctaveOrigin* origin, float* noiseOut, int xStart, int yStart, int zStart, int xSize, int ySize, int zSize, float step)
+	{
+		switch (p.fractal)
+		{
+		case Fractal::FBm:
+			uniformGrid3DFixed<B, Fractal::FBm>(p, origin, noiseOut, xStart, yStart, zStart, xSize, ySize, zSize, step);
+			break;
+		case Fractal::Ridged:
+			uniformGrid3DFixed<B, Fractal::Ridged>(p, origin, noiseOut, xStart, yStart, zStart, xSize, ySize, zSize, step);
+			break;
+		case Fractal::PingPong:
+			uniformGrid3DFixed<B, Fractal::PingPong>(p, origin, noiseOut, xStart, yStart, zStart, xSize, ySize, zSize, step);
+			break;
+		default:
+			uniformGrid3DFixed<B, Fractal::None>(p, origin, noiseOut, xStart, yStart, zStart, xSize, ySize, zSize, step);
+			break;
+		}
+	}
+
+	// Domain warped sampling, plain sampling at the given positions without a warp
+
+	template <Basis B, Fractal Fr>
+	static void warpNoise2DFixed(const NoiseParams* warp, const NoiseParams& p, const float* xIn, const float* yIn, float* noiseOut, int count)
+	{
+		for (int i = 0; i < count; i += V::Lanes)
+		{
+			bool full = count - i >= V::Lanes;
+			F x = full ? load(xIn + i) : loadPartial(xIn + i, count - i);
+			F y = full ? load(yIn + i) : loadPartial(yIn + i, count - i);
+
+			if (warp)
+				domainWarp(*warp, x, y);
+
+			x = x * p.frequency;
+			y = y * p.frequency;
+			transformNoiseCoordinate(B, x, y);
+
+			F noise = fractal2D<B, Fr>(p, x, y);
+
+			if (full)
+				store(noiseOut + i, noise);
+			else
+				storePartial(noiseOut + i, noise, count - i);
+		}
+	}
+
+	template <Basis B>
+	static void warpNoise2DBasis(const NoiseParams* warp, const NoiseParams& p, const float* xIn, const float* yIn, float* noiseOut, int count)
+	{
+		switch (p.fractal)
+		{
+		case Fractal::FBm:
+			warpNoise2DFixed<B, Fractal::FBm>(warp, p, xIn, yIn, noiseOut, count);
+			break;
+		case Fractal::Ridged:
+			warpNoise2DFixed<B, Fractal::Ridged>(warp, p, xIn, yIn, noiseOut, count);
+			break;
+		case Fractal::PingPong:
+			warpNoise2DFixed<B, Fractal::PingPong>(warp, p, xIn, yIn, noiseOut, count);
+			break;
+		default:
+			warpNoise2DFixed<B, Fractal::None>(warp, p, xIn, yIn, noiseOut, count);
+			break;
+		}
+	}
+
+	static void warpNoise2D(const NoiseParams* warp, const NoiseParams& p, const float* xIn, const float* yIn, float* noiseOut, int count)
+	{
+		switch (p.basis)
+		{
+		case Basis::OpenSimplex2S:
+			warpNoise2DBasis<Basis::OpenSimplex2S>(warp, p, xIn, yIn, noiseOut, count);
+			break;
+		case Basis::Cellular:
+			warpNoise2DBasis<Basis::Cellular>(warp, p, xIn, yIn, noiseOut, count);
+			break;
+		case Basis::Perlin:
+			warpNoise2DBasis<Basis::Perlin>(warp, p, xIn, yIn, noiseOut, count);
+			break;
+		case Basis::ValueCubic:
+			warpNoise2DBasis<Basis::ValueCubic>(warp, p, xIn, yIn, noiseOut, count);
+			break;
+		case Basis::Value:
+			warpNoise2DBasis<Basis::Value>(warp, p, xIn, yIn, noiseOut, count);
+			break;
+		default:
+			warpNoise2DBasis<Basis::OpenSimplex2>(warp, p, xIn, yIn, noiseOut, count);
+			break;
+		}
+	}
+
+	// Positions moved by the warp in place, FastNoiseLite::DomainWarp(x, y) on a batch
+	static void domainWarp2D(const NoiseParams& warp, float* x, float* y, int count)
+	{
+		for (int i = 0; i < count; i += V::Lanes)
+		{
+			bool full = count - i >= V::Lanes;
+			F xv = full ? load(x + i) : loadPartial(x + i, count - i);
+			F yv = full ? load(y + i) : loadPartial(y + i, count - i);
+
+			domainWarp(warp, xv, yv);
+
+			if (full)
+			{
+				store(x + i, xv);
+				store(y + i, yv);
+			}
+			else
+			{
+				storePartial(x + i, xv, count - i);
+				storePartial(y + i, yv, count - i);
+			}
+		}
+	}
+
+	// Octave layers
+
+	// Unweighted single noise of every octave, the fractal loop without the sum
+	template <Basis B>
+	static void octaveLayers2DBasis(const NoiseParams& p, float* layersOut, size_t layerStride, int firstOctave, int octaveCount,
+									int xStart, int yStart, int xSize, int ySize, float step)
+	{
+		for (int yi = 0; yi < ySize; yi++)
+		{
+			F yCoord = (float)(yStart + yi) * step * p.frequency;
+
+			for (int xi = 0; xi < xSize; xi += V::Lanes)
+			{
+				F x = toFloat(I(xStart + xi) + V::iota()) * step * p.frequency;
+				F y = yCoord;
+				transformNoiseCoordinate(B, x, y);
+
+				for (int o = 0; o < firstOctave + octaveCount; o++)
+				{
+					if (o >= firstOctave)
+					{
+						F noise = single2D<B>(p, p.seed + o, x, y);
+						float* out = layersOut + size_t(o - firstOctave) * layerStride + xi;
+
+						if (xSize - xi >= V::Lanes)
+							store(out, noise);
+						else
+							storePartial(out, noise, xSize - xi);
+					}
+
+					x = x * p.lacunarity;
+					y = y * p.lacunarity;
+				}
+			}
+			layersOut += xSize;
+		}
+	}
+
+	// Same operation order as the scalar 2D fractal loops, layer o holds the single noise of octave o
+	template <Fractal Fr>
+	static void combineOctavesFixed(const NoiseParams& p, const float* layers, size_t layerStride, float* noiseOut, int count)
+	{
+		for (int i = 0; i < count; i += V::Lanes)
+		{
+			bool full = count - i >= V::Lanes;
+			F sum = 0.0f;
+			F amp = p.fractalBounding;
+
+			for (int o = 0; o < (Fr == Fractal::None ? 1 : p.octaves); o++)
+			{
+				const float* layer = layers + size_t(o) * layerStride + i;
+				F noise = full ? load(layer) : loadPartial(layer, count - i);
+
+				switch (Fr)
+				{
+				case Fractal::FBm:
+					sum = sum + noise * amp;
+					amp = amp * lerp(F(1.0f), min(noise + 1.0f, F(2.0f)) * 0.5f, F(p.weightedStrength));
+					break;
+				case Fractal::Ridged:
+					noise = fastAbs(noise);
+					sum = sum + (noise * -2.0f + 1.0f) * amp;
+					amp = amp * lerp(F(1.0f), 1.0f - noise, F(p.weightedStrength));
+					break;
+				case Fractal::PingPong:
+					noise = pingPong((noise + 1.0f) * p.pingPongStrength);
+					sum = sum + (noise - 0.5f) * 2.0f * amp;
+					amp = amp * lerp(F(1.0f), noise, F(p.weightedStrength));
+					break;
+				default:
+					sum = noise;
+					break;
+				}
+
+				amp = amp * p.gain;
+			}
+
+			if (full)
+				store(noiseOut + i, sum);
+			else
+				storePartial(noiseOut + i, sum, count - i);
+		}
+	}
+
+	// Bicubic upsampling
+
+	// out(x, y) interpolates coarse at column ((x + xPhase) >> shift) + 1, row ((y + yPhase) >> shift) + 1, the
+	// low bits being the phase between samples. weights holds the 4 Catmull-Rom taps of each phase. rows is
+	// scratch for the coarseHeight horizontally interpolated rows, xSize floats each. Lanes past xSize gather
+	// up to Lanes floats beyond the last coarse row, which the caller keeps readable.
+	// Horizontal runs on the coarse rows only, the full resolution vertical pass needs no gathers.
+	static void upsampleBicubic(const float* coarse, int coarseWidth, int coarseHeight, const float* weights, int shift, int xPhase, int yPhase,
+								float* out, int xSize, int ySize, float* rows)
+	{
+		const int mask = (1 << shift) - 1;
+
+		for (int j = 0; j < coarseHeight; j++)
+		{
+			const float* src = coarse + size_t(j) * size_t(coarseWidth);
+			float* dst = rows + size_t(j) * size_t(xSize);
+
+			for (int x = 0; x < xSize; x += V::Lanes)
+			{
+				I gx = I(x + xPhase) + V::iota();
+				I c = gx >> shift;
+				I tap = (gx & I(mask)) << 2;
+
+				F v = gather(src, c) * gather(weights, tap) + gather(src, c + I(1)) * gather(weights, tap + I(1)) +
+					gather(src, c + I(2)) * gather(weights, tap + I(2)) + gather(src, c + I(3)) * gather(weights, tap + I(3));
+
+				if (xSize - x >= V::Lanes)
+					store(dst + x, v);
+				else
+					storePartial(dst + x, v, xSize - x);
+			}
+		}
+
+		for (int y = 0; y < ySize; y++)
+		{
+			const int gy = y + yPhase;
+			const float* w = weights + (gy & mask) * 4;
+			const float* r0 = rows + size_t(gy >> shift) * size_t(xSize);
+			const float* r1 = r0 + xSize;
+			const float* r2 = r1 + xSize;
+			const float* r3 = r2 + xSize;
+
+			for (int x = 0; x < xSize; x += V::Lanes)
+			{
+				bool full = xSize - x >= V::Lanes;
+				F v0 = full ? load(r0 + x) : loadPartial(r0 + x, xSize - x);
+				F v1 = full ? load(r1 + x) : loadPartial(r1 + x, xSize - x);
+				F v2 = full ? load(r2 + x) : loadPartial(r2 + x, xSize - x);
+				F v3 = full ? load(r3 + x) : loadPartial(r3 + x, xSize - x);
+				F v = v0 * w[0] + v1 * w[1] + v2 * w[2] + v3 * w[3];
+
+				if (full)
+					store(out + x, v);
+				else
+					storePartial(out + x, v, xSize - x);
+			}
+			out += xSize;
+		}
+	}
+
+	// Min / max / average pyramid
+
+	// dst texel x covers src columns 2x and 2x + 1, the last one of an odd width also 2x + 2; rows the same way.
+	// Every source row is read once for all three channels.
+	static void reduceMinMaxAvg(const float* srcMin, const float* srcMax, const float* srcAvg, int srcWidth, int srcHeight,
+								float* dstMin, float* dstMax, float* dstAvg, int yBegin, int yEnd)
+	{
+		const int dstWidth = srcWidth > 1 ? srcWidth / 2 : 1;
+		const int dstHeight = srcHeight > 1 ? srcHeight / 2 : 1;
+		// columns reducing exactly two source columns
+		const int pairs = (srcWidth & 1) ? dstWidth - 1 : dstWidth;
+
+		for (int y = yBegin; y < yEnd; y++)
+		{
+			const size_t first = size_t(2 * y) * size_t(srcWidth);
+			const int rows = y == dstHeight - 1 ? srcHeight - 2 * y : 2;
+			const float scale = 1.0f / float(2 * rows);
+			float* outMin = dstMin + size_t(y) * size_t(dstWidth);
+			float* outMax = dstMax + size_t(y) * size_t(dstWidth);
+			float* outAvg = dstAvg + size_t(y) * size_t(dstWidth);
+
+			int x = 0;
+			for (; x + V::Lanes <= pairs; x += V::Lanes)
+			{
+				const size_t column = first + size_t(2 * x);
+				F minLo = load(srcMin + column);
+				F minHi = load(srcMin + column + V::Lanes);
+				F maxLo = load(srcMax + column);
+				F maxHi = load(srcMax + column + V::Lanes);
+				F sumLo = load(srcAvg + column);
+				F sumHi = load(srcAvg + column + V::Lanes);
+
+				for (int r = 1; r < rows; r++)
+				{
+					const size_t offset = column + size_t(r) * size_t(srcWidth);
+					minLo = min(minLo, load(srcMin + offset));
+					minHi = min(minHi, load(srcMin + offset + V::Lanes));
+					maxLo = max(maxLo, load(srcMax + offset));
+					maxHi = max(maxHi, load(srcMax + offset + V::Lanes));
+					sumLo = sumLo + load(srcAvg + offset);
+					sumHi = sumHi + load(srcAvg + offset + V::Lanes);
+				}
+
+				store(outMin + x, min(evens(minLo, minHi), odds(minLo, minHi)));
+				store(outMax + x, max(evens(maxLo, maxHi), odds(maxLo, maxHi)));
+				store(outAvg + x, (evens(sumLo, sumHi) + odds(sumLo, sumHi)) * scale);
+			}
+
+			for (; x < dstWidth; x++)
+			{
+				const int columns = x == dstWidth - 1 ? srcWidth - 2 * x : 2;
+				float lo = INFINITY;
+				float hi = -INFINITY;
+				float sum = 0.0f;
+
+				for (int c = 0; c < columns; c++)
+				{
+					const size_t column = first + size_t(2 * x + c);
+					float columnMin = srcMin[column];
+					float columnMax = srcMax[column];
+					float columnSum = srcAvg[column];
+					for (int r = 1; r < rows; r++)
+					{
+						const size_t offset = column + size_t(r) * size_t(srcWidth);
+						columnMin = srcMin[offset] < columnMin ? srcMin[offset] : columnMin;
+						columnMax = srcMax[offset] > columnMax ? srcMax[offset] : columnMax;
+						columnSum += srcAvg[offset];
+					}
+					lo = columnMin < lo ? columnMin : lo;
+					hi = columnMax > hi ? columnMax : hi;
+					sum = c == 0 ? columnSum : sum + columnSum;
+				}
+
+				outMin[x] = lo;
+				outMax[x] = hi;
+				outAvg[x] = sum * (1.0f / float(columns * rows));
+			}
+		}
+	}
+
+	static void octaveLayers2D(const NoiseParams& p, float* layersOut, size_t layerStride, int firstOctave, int octaveCount,
+							   int xStart, int yStart, int xSize, int ySize, float step)
+	{
+		switch (p.basis)
+		{
+		case Basis::OpenSimplex2S:
+			octaveLayers2DBasis<Basis::OpenSimplex2S>(p, layersOut, layerStride, firstOctave, octaveCount, xStart, yStart, xSize, ySize, step);
+			break;
+		case Basis::Cellular:
+			octaveLayers2DBasis<Basis::Cellular>(p, layersOut, layerStride, firstOctave, octaveCount, xStart, yStart, xSize, ySize, step);
+			break;
+		case Basis::Perlin:
+			octaveLayers2DBasis<Basis::Perlin>(p, layersOut, layerStride, firstOctave, octaveCount, xStart, yStart, xSize, ySize, step);
+			break;
+		case Basis::ValueCubic:
+			octaveLayers2DBasis<Basis::ValueCubic>(p, layersOut, layerStride, firstOctave, octaveCount, xStart, yStart, xSize, ySize, step);
+			break;
+		case Basis::Value:
+			octaveLayers2DBasis<Basis::Value>(p, layersOut, layerStride, firstOctave, octaveCount, xStart, yStart, xSize, ySize, step);
+			break;
+		default:
+			octaveLayers2DBasis<Basis::OpenSimplex2>(p, layersOut, layerStride, firstOctave, octaveCount, xStart, yStart, xSize, ySize, step);
+			break;
+		}
+	}
+
+	static void combineOctaves(const NoiseParams& p, const float* layers, size_t layerStride, float* noiseOut, int count)
+	{
+		switch (p.fractal)
+		{
+		case Fractal::FBm:
+			combineOctavesFixed<Fractal::FBm>(p, layers, layerStride, noiseOut, count);
+			break;
+		case Fractal::Ridged:
+			combineOctavesFixed<Fractal::Ridged>(p, layers, layerStride, noiseOut, count);
+			break;
+		case Fractal::PingPong:
+			combineOctavesFixed<Fractal::PingPong>(p, layers, layerStride, noiseOut, count);
+			break;
+		default:
+			combineOctavesFixed<Fractal::None>(p, layers, layerStride, noiseOut, count);
+			break;
+		}
+	}
+
+	static void uniformGrid2D(const NoiseParams& p, const OctaveOrigin* origin, float* noiseOut, int xStart, int yStart, int xSize, int ySize, float step)
+	{
+		switch (p.basis)
+		{
+		case Basis::OpenSimplex2S:
+			uniformGrid2DBasis<Basis::OpenSimplex2S>(p, origin, noiseOut, xStart, yStart, xSize, ySize, step);
+			break;
+		case Basis::Cellular:
+			uniformGrid2DBasis<Basis::Cellular>(p, origin, noiseOut, xStart, yStart, xSize, ySize, step);
+			break;
+		case Basis::Perlin:
+			uniformGrid2DBasis<Basis::Perlin>(p, origin, noiseOut, xStart, yStart, xSize, ySize, step);
+			break;
+		case Basis::ValueCubic:
+			uniformGrid2DBasis<Basis::ValueCubic>(p, origin, noiseOut, xStart, yStart, xSize, ySize, step);
+			break;
+		case Basis::Value:
+			uniformGrid2DBasis<Basis::Value>(p, origin, noiseOut, xStart, yStart, xSize, ySize, step);
+			break;
+		default:
+			uniformGrid2DBasis<Basis::OpenSimplex2>(p, origin, noiseOut, xStart, yStart, xSize, ySize, step);
+			break;
+		}
+	}
+
+	static void uniformGrid3D(const NoiseParams& p, const OctaveOrigin* origin, float* noiseOut, int xStart, int yStart, int zStart, int xSize, int ySize, int zSize, float step)
+	{
+		switch (p.basis)
+		{
+		case Basis::OpenSimplex2S:
+			uniformGrid3DBasis<Basis::OpenSimplex2S>(p, origin, noiseOut, xStart, yStart, zStart, xSize, ySize, zSize, step);
+			break;
+		case Basis::Cellular:
+			uniformGrid3DBasis<Basis::Cellular>(p, origin, noiseOut, xStart, yStart, zStart, xSize, ySize, zSize, step);
+			break;
+		case Basis::Perlin:
+			uniformGrid3DBasis<Basis::Perlin>(p, origin, noiseOut, xStart, yStart, zStart, xSize, ySize, zSize, step);
+			break;
+		case Basis::ValueCubic:
+			uniformGrid3DBasis<Basis::ValueCubic>(p, origin, noiseOut, xStart, yStart, zStart, xSize, ySize, zSize, step);
+			break;
+		case Basis::Value:
+			uniformGrid3DBasis<Basis::Value>(p, origin, noiseOut, xStart, yStart, zStart, xSize, ySize, zSize, step);
+			break;
+		default:
+			uniformGrid3DBasis<Basis::OpenSimplex2>(p, origin, noiseOut, xStart, yStart, zStart, xSize, ySize, zSize, step);
+			break;
+		}
+	}
+};
+
+} // end unnamed namespace
+} // end namespace detail
+} // end namespace noise
@@ -0,0 +1,122 @@
+#include "fast_noise_simd_internal.h"
+#include <cmath>
+#include <cstdint>
+
+namespace noise
+{
+namespace detail
+{
+namespace
+{
+
+// One lane wrapper with the semantics of the SSE4.1 and AVX2 instructions the other units use: integer
+// arithmetic wraps, truncate() returns INT_MIN out of range and min / max return b for unordered inputs.
+// Compiled with the baseline flags like FastNoiseLite, so results match the vector tables bit for bit.
+
+struct Float1
+{
+	float v;
+	Float1() = default;
+	Float1(float f) : v(f) {}
+};
+
+struct Int1
+{
+	int32_t v;
+	Int1() = default;
+	Int1(int32_t i) : v(i) {}
+};
+
+struct Mask1
+{
+	bool v;
+	Mask1(bool v) : v(v) {}
+};
+
+inline Float1 operator+(Float1 a, Float1 b) { return a.v + b.v; }
+inline Float1 operator-(Float1 a, Float1 b) { return a.v - b.v; }
+inline Float1 operator*(Float1 a, Float1 b) { return a.v * b.v; }
+inline Float1 operator/(Float1 a, Float1 b) { return a.v / b.v; }
+inline Float1 operator-(Float1 a) { return -a.v; }
+
+inline Mask1 operator<(Float1 a, Float1 b) { return a.v < b.v; }
+inline Mask1 operator<=(Float1 a, Float1 b) { return a.v <= b.v; }
+inline Mask1 operator>(Float1 a, Float1 b) { return a.v > b.v; }
+inline Mask1 operator>=(Float1 a, Float1 b) { return a.v >= b.v; }
+
+inline Int1 operator+(Int1 a, Int1 b) { return int32_t(uint32_t(a.v) + uint32_t(b.v)); }
+inline Int1 operator-(Int1 a, Int1 b) { return int32_t(uint32_t(a.v) - uint32_t(b.v)); }
+inline Int1 operator*(Int1 a, Int1 b) { return int32_t(uint32_t(a.v) * uint32_t(b.v)); }
+inline Int1 operator&(Int1 a, Int1 b) { return a.v & b.v; }
+inline Int1 operator|(Int1 a, Int1 b) { return a.v | b.v; }
+inline Int1 operator^(Int1 a, Int1 b) { return a.v ^ b.v; }
+inline Int1 operator~(Int1 a) { return ~a.v; }
+inline Int1 operator>>(Int1 a, int n) { return a.v >> n; }
+inline Int1 operator<<(Int1 a, int n) { return int32_t(uint32_t(a.v) << n); }
+
+inline Mask1 operator&(Mask1 a, Mask1 b) { return a.v && b.v; }
+inline Mask1 operator|(Mask1 a, Mask1 b) { return a.v || b.v; }
+inline Mask1 andNot(Mask1 a, Mask1 b) { return !a.v && b.v; }
+inline bool any(Mask1 m) { return m.v; }
+
+inline Float1 select(Mask1 m, Float1 a, Float1 b) { return m.v ? a : b; }
+inline Mask1 select(Mask1 m, Mask1 a, Mask1 b) { return m.v ? a : b; }
+inline Int1 select(Mask1 m, Int1 a, Int1 b) { return m.v ? a : b; }
+
+inline Float1 min(Float1 a, Float1 b) { return a.v < b.v ? a : b; }
+inline Float1 max(Float1 a, Float1 b) { return a.v > b.v ? a : b; }
+inline Float1 sqrt(Float1 f) { return std::sqrt(f.v); }
+inline Float1 toFloat(Int1 i) { return float(i.v); }
+inline Int1 truncate(Float1 f) { return f.v > -2147483648.0f && f.v < 2147483648.0f ? int32_t(f.v) : INT32_MIN; }
+inline Int1 maskToInt(Mask1 m) { return m.v ? -1 : 0; }
+
+inline Float1 gather(const float* table, Int1 index) { return table[index.v]; }
+
+inline Float1 evens(Float1 a, Float1) { return a; }
+inline Float1 odds(Float1, Float1 b) { return b; }
+
+inline Float1 load(const float* in) { return *in; }
+inline void store(float* out, Float1 f) { *out = f.v; }
+
+struct Scalar
+{
+	typedef Float1 F;
+	typedef Int1 I;
+	typedef Mask1 M;
+	enum { Lanes = 1 };
+
+	static Int1 iota() { return 0; }
+};
+
+} // end unnamed namespace
+} // end namespace detail
+} // end namespace noise
+
+#include "fast_noise_simd_kernels.h"
+
+namespace noise
+{
+namespace detail
+{
+
+static const KernelTable s_tableScalar =
+{
+	"Scalar",
+	Scalar::Lanes,
+	&Kernels<Scalar>::uniformGrid2D,
+	&Kernels<Scalar>::uniformGrid3D,
+	&Kernels<Scalar>::warpNoise2D,
+	&Kernels<Scalar>::domainWarp2D,
+	&Kernels<Scalar>::octaveLayers2D,
+	&Kernels<Scalar>::combineOctaves,
+	&Kernels<Scalar>::upsampleBicubic,
+	&Kernels<Scalar>::reduceMinMaxAvg
+};
+
+const KernelTable* kernelTableScalar()
+{
+	return &s_tableScalar;
+}
+
+} // end namespace detail
+} // end namespace noise
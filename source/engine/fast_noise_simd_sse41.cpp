@@ -0,0 +1,143 @@
+#include "fast_noise_simd_internal.h"
+
+#if FNL_SIMD_X86 && (defined(__SSE4_1__) || defined(_MSC_VER))
+
+#include <smmintrin.h>
+
+namespace noise
+{
+namespace detail
+{
+namespace
+{
+
+struct Float4
+{
+	__m128 v;
+	Float4() = default;
+	Float4(__m128 v) : v(v) {}
+	Float4(float f) : v(_mm_set1_ps(f)) {}
+};
+
+struct Int4
+{
+	__m128i v;
+	Int4() = default;
+	Int4(__m128i v) : v(v) {}
+	Int4(int i) : v(_mm_set1_epi32(i)) {}
+};
+
+struct Mask4
+{
+	__m128 v;
+	Mask4(__m128 v) : v(v) {}
+};
+
+inline Float4 operator+(Float4 a, Float4 b) { return _mm_add_ps(a.v, b.v); }
+inline Float4 operator-(Float4 a, Float4 b) { return _mm_sub_ps(a.v, b.v); }
+inline Float4 operator*(Float4 a, Float4 b) { return _mm_mul_ps(a.v, b.v); }
+inline Float4 operator/(Float4 a, Float4 b) { return _mm_div_ps(a.v, b.v); }
+inline Float4 operator-(Float4 a) { return _mm_xor_ps(a.v, _mm_set1_ps(-0.0f)); }
+
+inline Mask4 operator<(Float4 a, Float4 b) { return _mm_cmplt_ps(a.v, b.v); }
+inline Mask4 operator<=(Float4 a, Float4 b) { return _mm_cmple_ps(a.v, b.v); }
+inline Mask4 operator>(Float4 a, Float4 b) { return _mm_cmpgt_ps(a.v, b.v); }
+inline Mask4 operator>=(Float4 a, Float4 b) { return _mm_cmpge_ps(a.v, b.v); }
+
+inline Int4 operator+(Int4 a, Int4 b) { return _mm_add_epi32(a.v, b.v); }
+inline Int4 operator-(Int4 a, Int4 b) { return _mm_sub_epi32(a.v, b.v); }
+inline Int4 operator*(Int4 a, Int4 b) { return _mm_mullo_epi32(a.v, b.v); }
+inline Int4 operator&(Int4 a, Int4 b) { return _mm_and_si128(a.v, b.v); }
+inline Int4 operator|(Int4 a, Int4 b) { return _mm_or_si128(a.v, b.v); }
+inline Int4 operator^(Int4 a, Int4 b) { return _mm_xor_si128(a.v, b.v); }
+inline Int4 operator~(Int4 a) { return _mm_xor_si128(a.v, _mm_set1_epi32(-1)); }
+inline Int4 operator>>(Int4 a, int n) { return _mm_srai_epi32(a.v, n); }
+inline Int4 operator<<(Int4 a, int n) { return _mm_slli_epi32(a.v, n); }
+
+inline Mask4 operator&(Mask4 a, Mask4 b) { return _mm_and_ps(a.v, b.v); }
+inline Mask4 operator|(Mask4 a, Mask4 b) { return _mm_or_ps(a.v, b.v); }
+inline Mask4 andNot(Mask4 a, Mask4 b) { return _mm_andnot_ps(a.v, b.v); }
+inline bool any(Mask4 m) { return _mm_movemask_ps(m.v) != 0; }
+
+inline Float4 select(Mask4 m, Float4 a, Float4 b) { return _mm_blendv_ps(b.v, a.v, m.v); }
+inline Mask4 select(Mask4 m, Mask4 a, Mask4 b) { return _mm_blendv_ps(b.v, a.v, m.v); }
+inline Int4 select(Mask4 m, Int4 a, Int4 b) { return _mm_castps_si128(_mm_blendv_ps(_mm_castsi128_ps(b.v), _mm_castsi128_ps(a.v), m.v)); }
+
+inline Float4 min(Float4 a, Float4 b) { return _mm_min_ps(a.v, b.v); }
+inline Float4 max(Float4 a, Float4 b) { return _mm_max_ps(a.v, b.v); }
+inline Float4 sqrt(Float4 f) { return _mm_sqrt_ps(f.v); }
+inline Float4 toFloat(Int4 i) { return _mm_cvtepi32_ps(i.v); }
+inline Int4 truncate(Float4 f) { return _mm_cvttps_epi32(f.v); }
+inline Int4 maskToInt(Mask4 m) { return _mm_castps_si128(m.v); }
+
+inline Float4 gather(const float* table, Int4 index)
+{
+	return _mm_setr_ps(table[_mm_extract_epi32(index.v, 0)], table[_mm_extract_epi32(index.v, 1)],
+					   table[_mm_extract_epi32(index.v, 2)], table[_mm_extract_epi32(index.v, 3)]);
+}
+
+inline Float4 evens(Float4 a, Float4 b) { return _mm_shuffle_ps(a.v, b.v, _MM_SHUFFLE(2, 0, 2, 0)); }
+inline Float4 odds(Float4 a, Float4 b) { return _mm_shuffle_ps(a.v, b.v, _MM_SHUFFLE(3, 1, 3, 1)); }
+
+inline Float4 load(const float* in) { return _mm_loadu_ps(in); }
+inline void store(float* out, Float4 f) { _mm_storeu_ps(out, f.v); }
+
+struct SSE41
+{
+	typedef Float4 F;
+	typedef Int4 I;
+	typedef Mask4 M;
+	enum { Lanes = 4 };
+
+	static Int4 iota() { return _mm_setr_epi32(0, 1, 2, 3); }
+};
+
+} // end unnamed namespace
+} // end namespace detail
+} // end namespace noise
+
+#include "fast_noise_simd_kernels.h"
+
+namespace noise
+{
+namespace detail
+{
+
+static const KernelTable s_tableSSE41 =
+{
+	"SSE4.1",
+	SSE41::Lanes,
+	&Kernels<SSE41>::uniformGrid2D,
+	&Kernels<SSE41>::uniformGrid3D,
+	&Kernels<SSE41>::warpNoise2D,
+	&Kernels<SSE41>::domainWarp2D,
+	&Kernels<SSE41>::octaveLayers2D,
+	&Kernels<SSE41>::combineOctaves,
+	&Kernels<SSE41>::upsampleBicubic,
+	&Kernels<SSE41>::reduceMinMaxAvg
+};
+
+const KernelTable* kernelTableSSE41()
+{
+	return &s_tableSSE41;
+}
+
+} // end namespace detail
+} // end namespace noise
+
+#else
+
+namespace noise
+{
+namespace detail
+{
+
+const KernelTable* kernelTableSSE41()
+{
+	return nullptr;
+}
+
+} // end namespace detail
+} // end namespace noise
+
+#endif
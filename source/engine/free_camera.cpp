@@ -35,6 +35,7 @@ void FreeCamera::setView(const glm::mat4& view)
 	d_matrices.basic.view = view;
 	d_matrices.view_inv = glm::affineInverse(view);
 	d_matrices.update();
+	updateFrustrumPlanes();
 	extractBasisFromViewMatrix();
 
 	//spdlog::info("{}", glm::to_string(d_matrices.basic.view));
@@ -46,6 +47,7 @@ void FreeCamera::setProj(const glm::mat4& proj, ProjType type)
 	d_matrices.basic.proj = proj;
 	d_matrices.proj_inv = glm::inverse(proj);
 	d_matrices.update();
+	updateFrustrumPlanes();
 	extractRange(d_matrices.basic.proj, d_clip.nearVal, d_clip.farVal);
 }
 
@@ -104,6 +106,23 @@ const glm::vec3& FreeCamera::right() const
 	return d_basis.right;
 }
 
+const std::array<glm::vec4, 6>& FreeCamera::frustrumPlanes() const
+{
+	return d_frustrumPlanes;
+}
+
+bool FreeCamera::boxInFrustrum(const glm::vec3& min, const glm::vec3& max) const
+{
+	for (const glm::vec4& plane : d_frustrumPlanes)
+	{
+		// the corner furthest along the plane normal
+		const glm::vec3 corner(plane.x > 0.0f ? max.x : min.x, plane.y > 0.0f ? max.y : min.y, plane.z > 0.0f ? max.z : min.z);
+		if (glm::dot(glm::vec3(plane), corner) + plane.w < 0.0f)
+			return false;
+	}
+	return true;
+}
+
 void FreeCamera::setMovementSpeed(float speed)
 {
 	d_moveSpeed = speed;
@@ -165,8 +184,6 @@ void FreeCamera::handleMouseMotion(float deltaX, float deltaY)
 	auto pitch = glm::rotate(glm::mat4(1.0f), glm::radians(d_anglesDeg.pitch), glm::vec3(1, 0, 0));
 	auto roll = glm::rotate(glm::mat4(1.0f), glm::radians(d_anglesDeg.roll), glm::vec3(0, 0, 1));
 	setView(roll * pitch * yaw * trans);
-
-	// TODO: update frustrum planes
 }
 
 void FreeCamera::handleResizeEvent(int w, int h)
@@ -201,6 +218,20 @@ void FreeCamera::extractBasisFromViewMatrix()
 	//d_basis.eye = tM[3];
 }
 
+void FreeCamera::updateFrustrumPlanes()
+{
+	// Gribb / Hartmann: clip space -w <= x, y, z <= w are sums and differences of the view projection rows
+	const glm::mat4& m = d_matrices.view_proj;
+	const glm::vec4 row0(m[0][0], m[1][0], m[2][0], m[3][0]);
+	const glm::vec4 row1(m[0][1], m[1][1], m[2][1], m[3][1]);
+	const glm::vec4 row2(m[0][2], m[1][2], m[2][2], m[3][2]);
+	const glm::vec4 row3(m[0][3], m[1][3], m[2][3], m[3][3]);
+
+	d_frustrumPlanes = { row3 + row0, row3 - row0, row3 + row1, row3 - row1, row3 + row2, row3 - row2 };
+	for (glm::vec4& plane : d_frustrumPlanes)
+		plane /= glm::length(glm::vec3(plane));
+}
+
 glm::mat4 FreeCamera::buildView(const glm::vec3& r, const glm::vec3& u, const glm::vec3& v, const glm::vec3& eye)
 {
 	glm::mat4 rot(1.0f);
@@ -43,6 +43,11 @@ public:
 	[[nodiscard]] const glm::vec3& up() const;
 	[[nodiscard]] const glm::vec3& right() const;
 
+	// left, right, bottom, top, near, far; normalized, xyz pointing inside
+	[[nodiscard]] const std::array<glm::vec4, 6>& frustrumPlanes() const;
+	// false only if the box lies entirely outside one of the planes, so boxes near the corners may pass
+	[[nodiscard]] bool boxInFrustrum(const glm::vec3& min, const glm::vec3& max) const;
+
 	void setMovementSpeed(float speed);
 	void setPitchSpeed(float speed);
 	void setYawSpeed(float speed);
@@ -97,11 +102,12 @@ private:
 		float farVal = 5000.0f;
 	}d_clip;
 
-	// planes for frustrum
-	//std::array<glm::vec4, 6> d_frustrumPlanes{};
+	// planes for frustrum, world space
+	std::array<glm::vec4, 6> d_frustrumPlanes{};
 
 	// HELPERS
 	void extractBasisFromViewMatrix();
+	void updateFrustrumPlanes();
 	glm::mat4 buildView(const glm::vec3& r, const glm::vec3& u, const glm::vec3& v, const glm::vec3& eye);
 	void extractRange(const glm::mat4& perspectiveProj, float& n, float& f);
 
@@ -0,0 +1,337 @@
+#include "height_pyramid.h"
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+namespace noise
+{
+
+namespace
+{
+
+// Destination rows per work item
+const int RowsPerTask = 32;
+// Smaller levels are reduced on the calling thread, waking the pool costs more
+const size_t MinParallelTexels = 64 * 1024;
+
+// Narrows [t0, t1] to where o + t * d lies in [0, hi]
+bool clipSlab(float o, float d, float hi, float& t0, float& t1)
+{
+	if (d == 0.0f)
+		return o >= 0.0f && o <= hi;
+
+	float ta = (0.0f - o) / d;
+	float tb = (hi - o) / d;
+	if (ta > tb)
+		std::swap(ta, tb);
+	t0 = std::max(t0, ta);
+	t1 = std::min(t1, tb);
+	return t0 <= t1;
+}
+
+// Quad holding coordinate p, a ray moving down from a quad boundary belongs to the quad below it
+int quadIndex(float p, float d, int quads)
+{
+	float f = std::floor(p);
+	int q = int(f);
+	if (d < 0.0f && f == p)
+		q--;
+	return std::min(std::max(q, 0), quads - 1);
+}
+
+// Moller-Trumbore, t of the hit or a negative value
+float intersectTriangle(const glm::vec3& origin, const glm::vec3& dir, const glm::vec3& a, const glm::vec3& b, const glm::vec3& c)
+{
+	const glm::vec3 e1 = b - a;
+	const glm::vec3 e2 = c - a;
+	const glm::vec3 p(dir.y * e2.z - dir.z * e2.y, dir.z * e2.x - dir.x * e2.z, dir.x * e2.y - dir.y * e2.x);
+	const float det = e1.x * p.x + e1.y * p.y + e1.z * p.z;
+	if (std::fabs(det) < 1e-12f)
+		return -1.0f;
+
+	const float inv = 1.0f / det;
+	const glm::vec3 s = origin - a;
+	const float u = (s.x * p.x + s.y * p.y + s.z * p.z) * inv;
+	if (u < 0.0f || u > 1.0f)
+		return -1.0f;
+
+	const glm::vec3 q(s.y * e1.z - s.z * e1.y, s.z * e1.x - s.x * e1.z, s.x * e1.y - s.y * e1.x);
+	const float v = (dir.x * q.x + dir.y * q.y + dir.z * q.z) * inv;
+	if (v < 0.0f || u + v > 1.0f)
+		return -1.0f;
+
+	return (e2.x * q.x + e2.y * q.y + e2.z * q.z) * inv;
+}
+
+} // end unnamed namespace
+
+HeightPyramid::HeightPyramid(SimdLevel level)
+	: d_level(level > detectSimdLevel() ? detectSimdLevel() : level)
+{}
+
+void HeightPyramid::build(const QuantizedHeightmap& map, util::ThreadPool& pool)
+{
+	auto begin = std::chrono::steady_clock::now();
+	allocate(map.width(), map.height());
+
+	const int bands = (map.height() + RowsPerTask - 1) / RowsPerTask;
+	pool.parallelFor(size_t(bands), [&](size_t index, unsigned)
+	{
+		int y = int(index) * RowsPerTask;
+		int end = std::min(y + RowsPerTask, map.height());
+		for (; y < end; ++y)
+			map.decodeRow(y, d_avg.data() + size_t(y) * size_t(map.width()));
+	});
+
+	reduce(pool);
+	d_lastBuildMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+}
+
+void HeightPyramid::build(const float* heights, int width, int height, util::ThreadPool& pool)
+{
+	auto begin = std::chrono::steady_clock::now();
+	allocate(width, height);
+	std::memcpy(d_avg.data(), heights, sizeof(float) * size_t(width) * size_t(height));
+
+	reduce(pool);
+	d_lastBuildMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+}
+
+int HeightPyramid::levels() const
+{
+	return int(d_widths.size());
+}
+
+int HeightPyramid::width(int level) const
+{
+	return d_widths[level];
+}
+
+int HeightPyramid::height(int level) const
+{
+	return d_heights[level];
+}
+
+const float* HeightPyramid::minimum(int level) const
+{
+	return level == 0 ? d_avg.data() : d_min.data() + (d_offsets[level] - d_offsets[1]);
+}
+
+const float* HeightPyramid::maximum(int level) const
+{
+	return level == 0 ? d_avg.data() : d_max.data() + (d_offsets[level] - d_offsets[1]);
+}
+
+const float* HeightPyramid::average(int level) const
+{
+	return d_avg.data() + d_offsets[level];
+}
+
+HeightBounds HeightPyramid::bounds(int level, int x, int y) const
+{
+	assert(x >= 0 && x < width(level) && y >= 0 && y < height(level));
+	const size_t index = size_t(y) * size_t(width(level)) + size_t(x);
+	return HeightBounds{ minimum(level)[index], maximum(level)[index] };
+}
+
+HeightBounds HeightPyramid::regionBounds(int x, int y, int w, int h) const
+{
+	const int x0 = std::max(x, 0);
+	const int y0 = std::max(y, 0);
+	const int x1 = std::min(x + w, width(0));
+	const int y1 = std::min(y + h, height(0));
+	if (x0 >= x1 || y0 >= y1)
+		return HeightBounds{};
+
+	// texels at least as large as the region, it then straddles at most two per axis
+	int level = 0;
+	while (level + 1 < levels() && (1 << level) < std::max(x1 - x0, y1 - y0))
+		level++;
+
+	HeightBounds result{ INFINITY, -INFINITY };
+	const int cx1 = std::min((x1 - 1) >> level, width(level) - 1);
+	const int cy1 = std::min((y1 - 1) >> level, height(level) - 1);
+	for (int cy = std::min(y0 >> level, cy1); cy <= cy1; ++cy)
+	{
+		for (int cx = std::min(x0 >> level, cx1); cx <= cx1; ++cx)
+		{
+			HeightBounds b = bounds(level, cx, cy);
+			result.min = std::min(result.min, b.min);
+			result.max = std::max(result.max, b.max);
+		}
+	}
+	return result;
+}
+
+bool HeightPyramid::raycast(const glm::vec3& origin, const glm::vec3& dir, float maxT, float& t) const
+{
+	const int w = levels() > 0 ? width(0) : 0;
+	const int h = levels() > 0 ? height(0) : 0;
+	if (w < 2 || h < 2)
+		return false;
+
+	float t0 = 0.0f;
+	float t1 = maxT;
+	if (!clipSlab(origin.x, dir.x, float(w - 1), t0, t1) || !clipSlab(origin.z, dir.z, float(h - 1), t0, t1))
+		return false;
+
+	// Walk the quads front to back. A cell the ray stays above for its whole extent is skipped, otherwise the walk
+	// descends into it, and after every step it goes back up one level to take larger steps again.
+	int qx = quadIndex(origin.x + dir.x * t0, dir.x, w - 1);
+	int qz = quadIndex(origin.z + dir.z * t0, dir.z, h - 1);
+	int level = levels() - 1;
+	float tCur = t0;
+
+	for (;;)
+	{
+		const int cx = std::min(qx >> level, width(level) - 1);
+		const int cz = std::min(qz >> level, height(level) - 1);
+		// quads covered by the cell, the last one of a level also takes the odd remainder
+		const int xLo = cx << level;
+		const int zLo = cz << level;
+		const int xHi = cx == width(level) - 1 ? w - 1 : (cx + 1) << level;
+		const int zHi = cz == height(level) - 1 ? h - 1 : (cz + 1) << level;
+
+		const float tx = dir.x > 0.0f ? (float(xHi) - origin.x) / dir.x : dir.x < 0.0f ? (float(xLo) - origin.x) / dir.x : INFINITY;
+		const float tz = dir.z > 0.0f ? (float(zHi) - origin.z) / dir.z : dir.z < 0.0f ? (float(zLo) - origin.z) / dir.z : INFINITY;
+		const float tExit = std::min(std::min(tx, tz), t1);
+
+		const float yLow = std::min(origin.y + dir.y * tCur, origin.y + dir.y * tExit);
+		if (yLow <= cellMax(level, cx, cz))
+		{
+			if (level > 0)
+			{
+				level--;
+				continue;
+			}
+			if (hitQuad(qx, qz, origin, dir, t0, t1, t))
+				return true;
+		}
+
+		if (tExit >= t1)
+			return false;
+
+		// Step into the neighbour, the other axis is taken from the exit point but kept inside this cell
+		const glm::vec3 p = origin + dir * tExit;
+		const int nextX = tx <= tz ? (dir.x > 0.0f ? xHi : xLo - 1) : std::min(std::max(quadIndex(p.x, dir.x, w - 1), xLo), xHi - 1);
+		const int nextZ = tz <= tx ? (dir.z > 0.0f ? zHi : zLo - 1) : std::min(std::max(quadIndex(p.z, dir.z, h - 1), zLo), zHi - 1);
+		if (nextX < 0 || nextX > w - 2 || nextZ < 0 || nextZ > h - 2)
+			return false;
+
+		qx = nextX;
+		qz = nextZ;
+		tCur = tExit;
+		level = std::min(level + 1, levels() - 1);
+	}
+}
+
+SimdLevel HeightPyramid::level() const
+{
+	return d_level;
+}
+
+double HeightPyramid::lastBuildMs() const
+{
+	return d_lastBuildMs;
+}
+
+size_t HeightPyramid::byteSize() const
+{
+	return (d_avg.size() + d_min.size() + d_max.size()) * sizeof(float);
+}
+
+void HeightPyramid::allocate(int width, int height)
+{
+	assert(width > 0 && height > 0);
+	d_widths.clear();
+	d_heights.clear();
+	d_offsets.clear();
+
+	size_t total = 0;
+	for (int level = 0;; ++level)
+	{
+		int w = std::max(1, width >> level);
+		int h = std::max(1, height >> level);
+		d_widths.push_back(w);
+		d_heights.push_back(h);
+		d_offsets.push_back(total);
+		total += size_t(w) * size_t(h);
+		if (w == 1 && h == 1)
+			break;
+	}
+
+	const size_t base = size_t(width) * size_t(height);
+	d_avg.resize(total);
+	d_min.resize(total - base);
+	d_max.resize(total - base);
+}
+
+void HeightPyramid::reduce(util::ThreadPool& pool)
+{
+	for (int level = 1; level < levels(); ++level)
+	{
+		const float* srcMin = minimum(level - 1);
+		const float* srcMax = maximum(level - 1);
+		const float* srcAvg = average(level - 1);
+		float* dstMin = d_min.data() + (d_offsets[level] - d_offsets[1]);
+		float* dstMax = d_max.data() + (d_offsets[level] - d_offsets[1]);
+		float* dstAvg = d_avg.data() + d_offsets[level];
+		const int srcWidth = width(level - 1);
+		const int srcHeight = height(level - 1);
+		const int rows = height(level);
+
+		if (size_t(width(level)) * size_t(rows) < MinParallelTexels)
+		{
+			reduceMinMaxAvg(srcMin, srcMax, srcAvg, srcWidth, srcHeight, dstMin, dstMax, dstAvg, 0, rows, d_level);
+			continue;
+		}
+
+		const int bands = (rows + RowsPerTask - 1) / RowsPerTask;
+		pool.parallelFor(size_t(bands), [&](size_t index, unsigned)
+		{
+			int y = int(index) * RowsPerTask;
+			reduceMinMaxAvg(srcMin, srcMax, srcAvg, srcWidth, srcHeight, dstMin, dstMax, dstAvg, y, std::min(y + RowsPerTask, rows), d_level);
+		});
+	}
+}
+
+float HeightPyramid::cellMax(int level, int cx, int cz) const
+{
+	// quads of the cell reach the first samples of the next cells
+	const int nx = std::min(cx + 1, width(level) - 1);
+	const int nz = std::min(cz + 1, height(level) - 1);
+	const float* top = maximum(level);
+	const size_t row = size_t(cz) * size_t(width(level));
+	const size_t next = size_t(nz) * size_t(width(level));
+	return std::max(std::max(top[row + size_t(cx)], top[row + size_t(nx)]), std::max(top[next + size_t(cx)], top[next + size_t(nx)]));
+}
+
+bool HeightPyramid::hitQuad(int qx, int qz, const glm::vec3& origin, const glm::vec3& dir, float tMin, float tMax, float& t) const
+{
+	const float* heights = average(0);
+	const size_t row = size_t(qz) * size_t(width(0)) + size_t(qx);
+	const size_t next = row + size_t(width(0));
+	const float x = float(qx);
+	const float z = float(qz);
+
+	const glm::vec3 a(x, heights[row], z);
+	const glm::vec3 b(x + 1.0f, heights[row + 1], z);
+	const glm::vec3 c(x, heights[next], z + 1.0f);
+	const glm::vec3 d(x + 1.0f, heights[next + 1], z + 1.0f);
+
+	float best = INFINITY;
+	for (float hit : { intersectTriangle(origin, dir, a, c, d), intersectTriangle(origin, dir, a, d, b) })
+	{
+		if (hit >= tMin && hit <= tMax)
+			best = std::min(best, hit);
+	}
+
+	if (best == INFINITY)
+		return false;
+	t = best;
+	return true;
+}
+
+} // end namespace noise
@@ -0,0 +1,74 @@
+#pragma once
+#include "fast_noise_simd.h"
+#include "quantized_heightmap.h"
+#include "thread_pool.h"
+#include <glm/vec3.hpp>
+#include <vector>
+
+namespace noise
+{
+
+struct HeightBounds
+{
+	float min = 0.0f;
+	float max = 0.0f;
+};
+
+// Min, max and average mip chain of a heightmap, reduced on the CPU with the vector kernels.
+// Level 0 is the decoded heightmap, level l has max(1, width >> l) x max(1, height >> l) texels like a GL
+// mip chain, each covering the 2x2 texels below it (3 at the end of odd sizes). The average levels are
+// meant for the texture mips, min and max are conservative bounds for culling and ray queries.
+class HeightPyramid
+{
+public:
+	explicit HeightPyramid(SimdLevel level = detectSimdLevel());
+	~HeightPyramid() = default;
+	HeightPyramid(const HeightPyramid&) = delete;
+	HeightPyramid(HeightPyramid&&) = delete;
+	void operator=(const HeightPyramid&) = delete;
+	void operator=(HeightPyramid&&) = delete;
+
+	// Rebuilds every level, large levels are split into row bands over the pool
+	void build(const QuantizedHeightmap& map, util::ThreadPool& pool);
+	void build(const float* heights, int width, int height, util::ThreadPool& pool);
+
+	[[nodiscard]] int levels() const;
+	[[nodiscard]] int width(int level) const;
+	[[nodiscard]] int height(int level) const;
+
+	// width(level) * height(level) floats, row major. Level 0 is the same heights for all three.
+	[[nodiscard]] const float* minimum(int level) const;
+	[[nodiscard]] const float* maximum(int level) const;
+	[[nodiscard]] const float* average(int level) const;
+
+	[[nodiscard]] HeightBounds bounds(int level, int x, int y) const;
+	// Conservative bounds of the samples [x, x + w) x [y, y + h), clipped to the map, from at most 2x2 texels
+	[[nodiscard]] HeightBounds regionBounds(int x, int y, int w, int h) const;
+
+	// First hit of origin + t * dir, t in [0, maxT], with the mesh through the level 0 samples: two triangles per
+	// quad, split along the diagonal from (x, z) to (x + 1, z + 1). Sample space: x and z are the column and row,
+	// y the height. Cells the ray passes above are skipped using the max levels.
+	bool raycast(const glm::vec3& origin, const glm::vec3& dir, float maxT, float& t) const;
+
+	[[nodiscard]] SimdLevel level() const;
+	[[nodiscard]] double lastBuildMs() const;
+	[[nodiscard]] size_t byteSize() const;
+
+private:
+	SimdLevel d_level = SimdLevel::Scalar;
+	std::vector<int> d_widths;
+	std::vector<int> d_heights;
+	std::vector<size_t> d_offsets; // of each level in d_avg, min and max planes start at level 1
+	std::vector<float> d_avg;
+	std::vector<float> d_min;
+	std::vector<float> d_max;
+	double d_lastBuildMs = 0.0;
+
+	// HELPERS
+	void allocate(int width, int height);
+	void reduce(util::ThreadPool& pool);
+	float cellMax(int level, int cx, int cz) const;
+	bool hitQuad(int qx, int qz, const glm::vec3& origin, const glm::vec3& dir, float tMin, float tMax, float& t) const;
+};
+
+} // end namespace noise
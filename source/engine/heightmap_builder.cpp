@@ -0,0 +1,157 @@
+#include "heightmap_builder.h"
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <exception>
+
+namespace noise
+{
+
+namespace
+{
+
+// Thrown from the tile callback of a stale build, parallelFor lets the other tiles drain and rethrows it
+struct BuildCancelled
+{};
+
+} // end unnamed namespace
+
+HeightmapBuilder::HeightmapBuilder(util::ThreadPool& pool, int width, int height, HeightFormat format)
+	: d_pool(pool)
+	, d_width(width)
+	, d_height(height)
+	, d_format(format)
+{
+	d_thread = std::thread([this]() { threadLoop(); });
+}
+
+HeightmapBuilder::~HeightmapBuilder()
+{
+	{
+		std::lock_guard<std::mutex> lock(d_mutex);
+		d_stop = true;
+		d_newest++;
+	}
+	d_wake.notify_one();
+	d_thread.join();
+}
+
+uint64_t HeightmapBuilder::request(const HeightmapBuildRequest& request)
+{
+	uint64_t id = 0;
+	{
+		std::lock_guard<std::mutex> lock(d_mutex);
+		if (d_queued || d_running)
+			d_cancelled++;
+		id = ++d_requestId;
+		d_request = request;
+		d_queued = true;
+		d_newest = id;
+	}
+	d_wake.notify_one();
+	return id;
+}
+
+std::unique_ptr<HeightmapBuild> HeightmapBuilder::take()
+{
+	std::lock_guard<std::mutex> lock(d_mutex);
+	return std::move(d_finished);
+}
+
+bool HeightmapBuilder::busy() const
+{
+	std::lock_guard<std::mutex> lock(d_mutex);
+	return d_queued || d_running;
+}
+
+uint64_t HeightmapBuilder::cancelledBuilds() const
+{
+	return d_cancelled;
+}
+
+void HeightmapBuilder::threadLoop()
+{
+	for (;;)
+	{
+		HeightmapBuildRequest request;
+		uint64_t id = 0;
+		{
+			std::unique_lock<std::mutex> lock(d_mutex);
+			d_wake.wait(lock, [this]() { return d_stop || d_queued; });
+			if (d_stop)
+				return;
+
+			request = d_request;
+			id = d_requestId;
+			d_queued = false;
+			d_running = true;
+		}
+
+		std::unique_ptr<HeightmapBuild> result;
+		try
+		{
+			result = build(request, id);
+		}
+		catch (const BuildCancelled&)
+		{
+			// a newer request is queued, or the builder is going away
+		}
+		catch (const std::exception& e)
+		{
+			// dropped like a cancelled build, the heightmap on screen stays
+			spdlog::error("heightmap build {} failed: {}", id, e.what());
+		}
+
+		std::lock_guard<std::mutex> lock(d_mutex);
+		d_running = false;
+		if (result && id == d_requestId)
+			d_finished = std::move(result);
+	}
+}
+
+std::unique_ptr<HeightmapBuild> HeightmapBuilder::build(const HeightmapBuildRequest& request, uint64_t id)
+{
+	auto checkCancelled = [this, id]()
+	{
+		if (d_newest.load(std::memory_order_relaxed) != id)
+			throw BuildCancelled();
+	};
+
+	auto result = std::make_unique<HeightmapBuild>();
+	result->id = id;
+	result->heightmap = std::make_unique<QuantizedHeightmap>(d_width, d_height, d_format);
+	result->pyramid = std::make_unique<HeightPyramid>();
+
+	const SimdLevel level = request.backend == NoiseBackend::Simd ? request.level : SimdLevel::Scalar;
+	if (request.octaveCache)
+	{
+		if (!d_octaveCache || d_octaveCache->level() != std::min(level, detectSimdLevel()))
+			d_octaveCache = std::make_unique<OctaveLayerCache>(level);
+
+		// Tiles of a cancelled call may hold more octaves than the cache counts, the next call regenerates them
+		result->update = result->heightmap->generate(*d_octaveCache, request.settings, d_pool, checkCancelled);
+		result->generator = "octave cache";
+		result->stats = d_octaveCache->stats();
+		result->cachedOctaves = d_octaveCache->cachedOctaves();
+		result->cacheBytes = d_octaveCache->byteSize();
+	}
+	else
+	{
+		if (!d_generator || d_generatorBackend != request.backend || d_generatorLevel != level)
+		{
+			d_generator = createHeightmapGenerator(request.backend, request.settings, level);
+			d_generatorBackend = request.backend;
+			d_generatorLevel = level;
+		}
+		d_generator->settings() = request.settings;
+
+		result->heightmap->generate(*d_generator, d_pool, checkCancelled);
+		result->generator = d_generator->name();
+		result->stats = d_generator->stats();
+	}
+
+	checkCancelled();
+	result->pyramid->build(*result->heightmap, d_pool);
+	return result;
+}
+
+} // end namespace noise
@@ -0,0 +1,93 @@
+#pragma once
+#include "height_pyramid.h"
+#include "heightmap_generator.h"
+#include "octave_layer_cache.h"
+#include "quantized_heightmap.h"
+#include "thread_pool.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace noise
+{
+
+struct HeightmapBuildRequest
+{
+	NoiseBackend backend = NoiseBackend::Simd;
+	SimdLevel level = SimdLevel::Scalar; // only used by NoiseBackend::Simd
+	FastNoiseLite settings;
+	bool octaveCache = false; // generate through an OctaveLayerCache kept across builds
+};
+
+// Everything a finished build hands over, owned by whoever took it
+struct HeightmapBuild
+{
+	uint64_t id = 0;
+	std::unique_ptr<QuantizedHeightmap> heightmap;
+	std::unique_ptr<HeightPyramid> pyramid;
+	std::string generator; // name of the generator or "octave cache"
+	HeightmapStats stats;  // of the generator or cache, accumulated over the builds that used it
+	OctaveLayerCache::Update update = OctaveLayerCache::Update::Rebuilt; // octave cache builds only
+	int cachedOctaves = 0;
+	size_t cacheBytes = 0;
+};
+
+// Builds quantized heightmaps and their pyramids on a thread of its own, fanning the tiles out over the pool,
+// so the render loop only posts requests and picks up results. Requests coalesce: a new one replaces a queued
+// one and cancels the running build, which stops after at most one tile per pool thread. Only the newest
+// finished build is kept for take(), a build that throws is logged and dropped.
+class HeightmapBuilder
+{
+public:
+	HeightmapBuilder(util::ThreadPool& pool, int width, int height, HeightFormat format);
+	// Cancels the running build and waits for it to unwind
+	~HeightmapBuilder();
+	HeightmapBuilder(const HeightmapBuilder&) = delete;
+	HeightmapBuilder(HeightmapBuilder&&) = delete;
+	void operator=(const HeightmapBuilder&) = delete;
+	void operator=(HeightmapBuilder&&) = delete;
+
+	// Settings are copied, returns the id the build will carry
+	uint64_t request(const HeightmapBuildRequest& request);
+	// Newest finished build not taken yet, or null. Never waits for generation.
+	std::unique_ptr<HeightmapBuild> take();
+
+	// A build is queued or running
+	[[nodiscard]] bool busy() const;
+	[[nodiscard]] uint64_t cancelledBuilds() const;
+
+private:
+	util::ThreadPool& d_pool;
+	const int d_width;
+	const int d_height;
+	const HeightFormat d_format;
+
+	mutable std::mutex d_mutex;
+	std::condition_variable d_wake;
+	bool d_stop = false;
+	bool d_queued = false;
+	bool d_running = false;
+	HeightmapBuildRequest d_request;
+	uint64_t d_requestId = 0;
+	std::unique_ptr<HeightmapBuild> d_finished;
+	std::atomic<uint64_t> d_newest{ 0 }; // id of the newest request, builds with an older id stop
+	std::atomic<uint64_t> d_cancelled{ 0 };
+
+	// only touched by the build thread
+	std::unique_ptr<HeightmapGenerator> d_generator;
+	NoiseBackend d_generatorBackend = NoiseBackend::Simd;
+	SimdLevel d_generatorLevel = SimdLevel::Scalar;
+	std::unique_ptr<OctaveLayerCache> d_octaveCache;
+
+	std::thread d_thread;
+
+	// HELPERS
+	void threadLoop();
+	std::unique_ptr<HeightmapBuild> build(const HeightmapBuildRequest& request, uint64_t id);
+};
+
+} // end namespace noise
@@ -0,0 +1,225 @@
+#include "heightmap_generator.h"
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cstring>
+
+namespace noise
+{
+
+namespace
+{
+
+class ScalarHeightmapGenerator : public HeightmapGenerator
+{
+public:
+	explicit ScalarHeightmapGenerator(const FastNoiseLite& settings)
+		: HeightmapGenerator(settings)
+	{}
+
+	NoiseBackend backend() const override
+	{
+		return NoiseBackend::Scalar;
+	}
+
+	std::string name() const override
+	{
+		return "FastNoiseLite";
+	}
+
+protected:
+	void generateImpl(float* noiseOut, int xStart, int yStart, int xSize, int ySize, float step) override
+	{
+		d_settings.GenUniformGrid2D(noiseOut, xStart, yStart, xSize, ySize, step);
+	}
+};
+
+class SimdHeightmapGenerator : public HeightmapGenerator
+{
+public:
+	SimdHeightmapGenerator(const FastNoiseLite& settings, SimdLevel level)
+		: HeightmapGenerator(settings)
+		, d_level(level > detectSimdLevel() ? detectSimdLevel() : level)
+	{}
+
+	NoiseBackend backend() const override
+	{
+		return NoiseBackend::Simd;
+	}
+
+	std::string name() const override
+	{
+		// A level without a vector instruction set silently runs the scalar path, say so
+		SimdLevel used = hasSimdLevel(d_level) ? d_level : SimdLevel::Scalar;
+		return std::string("SIMD (") + simdLevelName(used) + ")";
+	}
+
+protected:
+	void generateImpl(float* noiseOut, int xStart, int yStart, int xSize, int ySize, float step) override
+	{
+		genUniformGrid2D(d_settings, noiseOut, xStart, yStart, xSize, ySize, step, d_level);
+	}
+
+private:
+	SimdLevel d_level = SimdLevel::Scalar;
+};
+
+} // end unnamed namespace
+
+double HeightmapStats::lastSamplesPerSec() const
+{
+	return lastMs > 0.0 ? double(lastSamples) / (lastMs * 1e-3) : 0.0;
+}
+
+double HeightmapStats::avgSamplesPerSec() const
+{
+	return totalMs > 0.0 ? double(totalSamples) / (totalMs * 1e-3) : 0.0;
+}
+
+HeightmapGenerator::HeightmapGenerator(const FastNoiseLite& settings)
+	: d_settings(settings)
+{}
+
+template <class F>
+void HeightmapGenerator::timed(int xSize, int ySize, F&& generateFn)
+{
+	auto begin = std::chrono::steady_clock::now();
+	generateFn();
+	auto end = std::chrono::steady_clock::now();
+
+	d_stats.lastMs = std::chrono::duration<double, std::milli>(end - begin).count();
+	d_stats.lastSamples = uint64_t(xSize) * uint64_t(ySize);
+	d_stats.totalMs += d_stats.lastMs;
+	d_stats.totalSamples += d_stats.lastSamples;
+	d_stats.runs++;
+}
+
+void HeightmapGenerator::generate(float* noiseOut, int xStart, int yStart, int xSize, int ySize, float step)
+{
+	timed(xSize, ySize, [&]()
+	{
+		generateImpl(noiseOut, xStart, yStart, xSize, ySize, step);
+	});
+}
+
+void HeightmapGenerator::generate(util::ThreadPool& pool, float* noiseOut, int xStart, int yStart, int xSize, int ySize, float step)
+{
+	generateTiles(pool, xStart, yStart, xSize, ySize, step, d_tileSize, [noiseOut, xSize](const float* tile, int x, int y, int w, int h)
+	{
+		for (int row = 0; row < h; ++row)
+		{
+			std::memcpy(noiseOut + size_t(y + row) * size_t(xSize) + size_t(x),
+						tile + size_t(row) * size_t(w), sizeof(float) * size_t(w));
+		}
+	});
+}
+
+void HeightmapGenerator::generateTiles(util::ThreadPool& pool, int xStart, int yStart, int xSize, int ySize, float step, int tileSize, const TileCB& cb)
+{
+	assert(tileSize > 0);
+	const int tilesX = (xSize + tileSize - 1) / tileSize;
+	const int tilesY = (ySize + tileSize - 1) / tileSize;
+
+	d_tileScratch.resize(pool.concurrency());
+
+	timed(xSize, ySize, [&]()
+	{
+		pool.parallelFor(size_t(tilesX) * size_t(tilesY), [&](size_t index, unsigned worker)
+		{
+			int tx = int(index % size_t(tilesX)) * tileSize;
+			int ty = int(index / size_t(tilesX)) * tileSize;
+			int w = std::min(tileSize, xSize - tx);
+			int h = std::min(tileSize, ySize - ty);
+
+			std::vector<float>& scratch = d_tileScratch[worker];
+			scratch.resize(size_t(tileSize) * size_t(tileSize));
+			generateImpl(scratch.data(), xStart + tx, yStart + ty, w, h, step);
+
+			cb(scratch.data(), tx, ty, w, h);
+		});
+	});
+}
+
+void HeightmapGenerator::setTileSize(int size)
+{
+	assert(size > 0);
+	d_tileSize = size;
+}
+
+int HeightmapGenerator::tileSize() const
+{
+	return d_tileSize;
+}
+
+FastNoiseLite& HeightmapGenerator::settings()
+{
+	return d_settings;
+}
+
+const FastNoiseLite& HeightmapGenerator::settings() const
+{
+	return d_settings;
+}
+
+const HeightmapStats& HeightmapGenerator::stats() const
+{
+	return d_stats;
+}
+
+void HeightmapGenerator::resetStats()
+{
+	d_stats = HeightmapStats();
+}
+
+std::unique_ptr<HeightmapGenerator> createHeightmapGenerator(NoiseBackend backend, const FastNoiseLite& settings, SimdLevel level)
+{
+	switch (backend)
+	{
+	case NoiseBackend::Simd:
+		return std::make_unique<SimdHeightmapGenerator>(settings, level);
+	default:
+		return std::make_unique<ScalarHeightmapGenerator>(settings);
+	}
+}
+
+bool parseNoiseBackend(const std::string& name, NoiseBackend& backend, SimdLevel& level)
+{
+	if (name == "scalar")
+	{
+		backend = NoiseBackend::Scalar;
+		level = SimdLevel::Scalar;
+	}
+	else if (name == "simd")
+	{
+		backend = NoiseBackend::Simd;
+		level = detectSimdLevel();
+	}
+	else if (name == "sse41")
+	{
+		backend = NoiseBackend::Simd;
+		level = SimdLevel::SSE41;
+	}
+	else if (name == "avx2")
+	{
+		backend = NoiseBackend::Simd;
+		level = SimdLevel::AVX2;
+	}
+	else
+	{
+		return false;
+	}
+	return true;
+}
+
+const char* noiseBackendName(NoiseBackend backend)
+{
+	switch (backend)
+	{
+	case NoiseBackend::Simd:
+		return "simd";
+	default:
+		return "scalar";
+	}
+}
+
+} // end namespace noise
@@ -0,0 +1,97 @@
+#pragma once
+#include "fast_noise.h"
+#include "fast_noise_simd.h"
+#include "thread_pool.h"
+#include <functional>
+#include <memory>
+#include <vector>
+#include <string>
+#include <cstdint>
+
+namespace noise
+{
+
+enum class NoiseBackend
+{
+	Scalar, // FastNoiseLite::GenUniformGrid2D
+	Simd    // noise::genUniformGrid2D at the best (or a forced) SimdLevel
+};
+
+struct HeightmapStats
+{
+	double lastMs = 0.0;
+	uint64_t lastSamples = 0;
+	double totalMs = 0.0;
+	uint64_t totalSamples = 0;
+	uint32_t runs = 0;
+
+	[[nodiscard]] double lastSamplesPerSec() const;
+	[[nodiscard]] double avgSamplesPerSec() const;
+};
+
+// Fills 2D heightmaps from a FastNoiseLite configuration. Every backend produces the same
+// values for the same settings (see fast_noise_simd.h for the accuracy contract), they only
+// differ in speed, which is timed on each generate() call.
+class HeightmapGenerator
+{
+public:
+	// tile holds w * h samples, row major, for the area starting at (x, y) relative to xStart, yStart.
+	// It points into per-thread scratch that is reused once the callback returns.
+	using TileCB = std::function<void(const float* tile, int x, int y, int w, int h)>;
+
+	explicit HeightmapGenerator(const FastNoiseLite& settings);
+	virtual ~HeightmapGenerator() = default;
+	HeightmapGenerator(const HeightmapGenerator&) = delete;
+	HeightmapGenerator(HeightmapGenerator&&) = delete;
+	void operator=(const HeightmapGenerator&) = delete;
+	void operator=(HeightmapGenerator&&) = delete;
+
+	// Row major, xSize * ySize floats, sample (x, y) taken at ((xStart + x) * step, (yStart + y) * step)
+	void generate(float* noiseOut, int xStart, int yStart, int xSize, int ySize, float step = 1.0f);
+	// Same area split into tiles generated in parallel. Each sample only depends on its integer
+	// grid position, so the output is bit-identical to generate() for any thread count or order.
+	void generate(util::ThreadPool& pool, float* noiseOut, int xStart, int yStart, int xSize, int ySize, float step = 1.0f);
+	// Parallel generation that hands every tileSize^2 tile to cb instead of writing a float image, cb runs
+	// on pool threads for different tiles at once. Small tiles keep the samples in L1 for consumers that
+	// convert them, e.g. quantization.
+	void generateTiles(util::ThreadPool& pool, int xStart, int yStart, int xSize, int ySize, float step, int tileSize, const TileCB& cb);
+
+	void setTileSize(int size);
+	[[nodiscard]] int tileSize() const;
+
+	[[nodiscard]] virtual NoiseBackend backend() const = 0;
+	// Human readable, includes the instruction set actually used for the current settings
+	[[nodiscard]] virtual std::string name() const = 0;
+
+	FastNoiseLite& settings();
+	[[nodiscard]] const FastNoiseLite& settings() const;
+
+	[[nodiscard]] const HeightmapStats& stats() const;
+	void resetStats();
+
+protected:
+	// Called concurrently for different tiles by the parallel generate(), must not mutate shared state
+	virtual void generateImpl(float* noiseOut, int xStart, int yStart, int xSize, int ySize, float step) = 0;
+
+	FastNoiseLite d_settings;
+
+private:
+	HeightmapStats d_stats;
+	int d_tileSize = 128;
+	std::vector<std::vector<float>> d_tileScratch; // one per pool thread
+
+	// HELPERS
+	template <class F>
+	void timed(int xSize, int ySize, F&& generateFn);
+};
+
+// level is only used by NoiseBackend::Simd and is clamped to detectSimdLevel()
+std::unique_ptr<HeightmapGenerator> createHeightmapGenerator(NoiseBackend backend, const FastNoiseLite& settings,
+															 SimdLevel level = detectSimdLevel());
+
+// Accepts "scalar", "simd", "sse41" and "avx2"; the last two force the SIMD backend to that level.
+// Returns false and leaves the outputs untouched for unknown names.
+bool parseNoiseBackend(const std::string& name, NoiseBackend& backend, SimdLevel& level);
+const char* noiseBackendName(NoiseBackend backend);
+
+} // end namespace noise
@@ -0,0 +1,490 @@
+#include "noise_graph.h"
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <utility>
+
+namespace noise
+{
+
+namespace
+{
+
+// Blocks per parallel work item, enough to amortize the pool wake up
+const int BlocksPerTask = 16;
+
+float evalCurve(const std::vector<CurvePoint>& points, float v)
+{
+	if (v <= points.front().in)
+		return points.front().out;
+	if (v >= points.back().in)
+		return points.back().out;
+
+	size_t i = 1;
+	while (points[i].in < v)
+		i++;
+
+	const CurvePoint& a = points[i - 1];
+	const CurvePoint& b = points[i];
+	const float t = (v - a.in) / (b.in - a.in);
+	return a.out + (b.out - a.out) * t;
+}
+
+} // end unnamed namespace
+
+NoiseGraph::NoiseGraph(SimdLevel level)
+	: d_level(level > detectSimdLevel() ? detectSimdLevel() : level)
+{}
+
+NoiseGraph::Node NoiseGraph::source(const FastNoiseLite& noise)
+{
+	NodeDesc node;
+	node.op = Op::Source;
+	node.noise = int(d_noises.size());
+	d_noises.push_back(noise);
+	return addNode(std::move(node));
+}
+
+NoiseGraph::Node NoiseGraph::constant(float value)
+{
+	NodeDesc node;
+	node.op = Op::Constant;
+	node.p0 = value;
+	return addNode(std::move(node));
+}
+
+NoiseGraph::Node NoiseGraph::add(Node a, Node b)
+{
+	NodeDesc node;
+	node.op = Op::Add;
+	node.a = a;
+	node.b = b;
+	return addNode(std::move(node));
+}
+
+NoiseGraph::Node NoiseGraph::mul(Node a, Node b)
+{
+	NodeDesc node;
+	node.op = Op::Mul;
+	node.a = a;
+	node.b = b;
+	return addNode(std::move(node));
+}
+
+NoiseGraph::Node NoiseGraph::blend(Node a, Node b, Node t)
+{
+	NodeDesc node;
+	node.op = Op::Blend;
+	node.a = a;
+	node.b = b;
+	node.c = t;
+	return addNode(std::move(node));
+}
+
+NoiseGraph::Node NoiseGraph::warp(Node input, const FastNoiseLite& warp)
+{
+	NodeDesc node;
+	node.op = Op::Warp;
+	node.a = input;
+	node.noise = int(d_noises.size());
+	d_noises.push_back(warp);
+	return addNode(std::move(node));
+}
+
+NoiseGraph::Node NoiseGraph::clamp(Node input, float min, float max)
+{
+	NodeDesc node;
+	node.op = Op::Clamp;
+	node.a = input;
+	node.p0 = min;
+	node.p1 = max;
+	return addNode(std::move(node));
+}
+
+NoiseGraph::Node NoiseGraph::curve(Node input, std::vector<CurvePoint> points)
+{
+	assert(!points.empty());
+	std::sort(points.begin(), points.end(), [](const CurvePoint& a, const CurvePoint& b) { return a.in < b.in; });
+
+	NodeDesc node;
+	node.op = Op::Curve;
+	node.a = input;
+	node.points = std::move(points);
+	return addNode(std::move(node));
+}
+
+NoiseGraph::Node NoiseGraph::terrace(Node input, int steps, float smoothness)
+{
+	NodeDesc node;
+	node.op = Op::Terrace;
+	node.a = input;
+	node.p0 = float(std::max(steps, 1));
+	node.p1 = std::min(std::max(smoothness, 0.0f), 1.0f);
+	return addNode(std::move(node));
+}
+
+void NoiseGraph::clear()
+{
+	d_nodes.clear();
+	d_noises.clear();
+	d_program.clear();
+	d_registers = 0;
+	d_scratch.clear();
+}
+
+void NoiseGraph::setOutput(Node output)
+{
+	assert(output >= 0 && output < int(d_nodes.size()));
+
+	// Lower to single assignment form: every instruction writes a new temporary. Nodes are emitted in post
+	// order per position context, so inputs always come first and the output last.
+	std::vector<Instruction> program;
+	std::vector<bool> isPositions; // per temporary
+	std::map<std::pair<Node, int>, int> values; // (node, position temporary) -> value temporary
+	int grid = -1;
+
+	auto newTemp = [&](bool positions)
+	{
+		isPositions.push_back(positions);
+		return int(isPositions.size()) - 1;
+	};
+
+	auto emit = [&](Op op, int dst, int a, int b, int c, int positions, Node node)
+	{
+		Instruction instruction;
+		instruction.op = op;
+		instruction.dst = dst;
+		instruction.a = a;
+		instruction.b = b;
+		instruction.c = c;
+		instruction.positions = positions;
+		instruction.node = node;
+		program.push_back(instruction);
+	};
+
+	// context -1 stands for the grid positions, emitted on first use
+	std::function<int(Node, int)> lower = [&](Node node, int context) -> int
+	{
+		auto found = values.find({node, context});
+		if (found != values.end())
+			return found->second;
+
+		const NodeDesc& desc = d_nodes[node];
+		auto positions = [&]()
+		{
+			if (context >= 0)
+				return context;
+			if (grid < 0)
+			{
+				grid = newTemp(true);
+				emit(Op::Grid, grid, -1, -1, -1, -1, -1);
+			}
+			return grid;
+		};
+
+		int result = -1;
+		switch (desc.op)
+		{
+		case Op::Warp:
+		{
+			const int from = positions();
+			const int warped = newTemp(true);
+			emit(Op::Warp, warped, from, -1, -1, -1, node);
+			result = lower(desc.a, warped);
+			break;
+		}
+		case Op::Source:
+		{
+			const int from = positions();
+			result = newTemp(false);
+			emit(Op::Source, result, -1, -1, -1, from, node);
+			break;
+		}
+		case Op::Constant:
+			result = newTemp(false);
+			emit(Op::Constant, result, -1, -1, -1, -1, node);
+			break;
+		default:
+		{
+			const int a = lower(desc.a, context);
+			const int b = desc.b >= 0 ? lower(desc.b, context) : -1;
+			const int c = desc.c >= 0 ? lower(desc.c, context) : -1;
+			result = newTemp(false);
+			emit(desc.op, result, a, b, c, -1, node);
+			break;
+		}
+		}
+
+		values[{node, context}] = result;
+		return result;
+	};
+
+	const int outputTemp = lower(output, -1);
+	assert(program.back().dst == outputTemp);
+
+	// Register allocation over the linear program: a temporary's register is freed after its last reader, so
+	// elementwise instructions may write over an input that dies with them. The output goes to noiseOut.
+	std::vector<int> lastUse(isPositions.size(), -1);
+	for (int i = 0; i < int(program.size()); i++)
+		for (int temp : {program[i].a, program[i].b, program[i].c, program[i].positions})
+			if (temp >= 0)
+				lastUse[temp] = i;
+
+	std::vector<int> reg(isPositions.size(), -1);
+	std::vector<bool> released(isPositions.size(), false);
+	std::vector<int> freeValues, freePositions;
+	int valueRegisters = 0, positionRegisters = 0;
+
+	for (int i = 0; i < int(program.size()); i++)
+	{
+		const Instruction& instruction = program[i];
+		for (int temp : {instruction.a, instruction.b, instruction.c, instruction.positions})
+		{
+			if (temp >= 0 && lastUse[temp] == i && !released[temp])
+			{
+				(isPositions[temp] ? freePositions : freeValues).push_back(reg[temp]);
+				released[temp] = true;
+			}
+		}
+
+		const int dst = instruction.dst;
+		if (dst == outputTemp)
+			continue;
+
+		std::vector<int>& available = isPositions[dst] ? freePositions : freeValues;
+		int& used = isPositions[dst] ? positionRegisters : valueRegisters;
+		if (available.empty())
+			available.push_back(used++);
+		reg[dst] = available.back();
+		available.pop_back();
+	}
+
+	// Block indices into the register file: values first, then x and y of every position register
+	auto blockIndex = [&](int temp)
+	{
+		if (temp < 0 || temp == outputTemp)
+			return -1;
+		return isPositions[temp] ? valueRegisters + reg[temp] * 2 : reg[temp];
+	};
+
+	for (Instruction& instruction : program)
+	{
+		instruction.dst = blockIndex(instruction.dst);
+		instruction.a = blockIndex(instruction.a);
+		instruction.b = blockIndex(instruction.b);
+		instruction.c = blockIndex(instruction.c);
+		instruction.positions = blockIndex(instruction.positions);
+	}
+
+	d_program = std::move(program);
+	d_registers = valueRegisters + positionRegisters * 2;
+}
+
+void NoiseGraph::generate(float* noiseOut, int xStart, int yStart, int xSize, int ySize, float step)
+{
+	if (d_scratch.empty())
+		d_scratch.resize(1);
+
+	timed(xSize, ySize, [&]()
+	{
+		generateRows(noiseOut, xStart, yStart, xSize, 0, ySize, step, d_scratch[0]);
+	});
+}
+
+void NoiseGraph::generate(util::ThreadPool& pool, float* noiseOut, int xStart, int yStart, int xSize, int ySize, float step)
+{
+	if (d_scratch.size() < pool.concurrency())
+		d_scratch.resize(pool.concurrency());
+
+	const int rowsPerTask = std::max(1, BlocksPerTask * BlockSize / std::max(xSize, 1));
+	const int bands = (ySize + rowsPerTask - 1) / rowsPerTask;
+
+	timed(xSize, ySize, [&]()
+	{
+		pool.parallelFor(size_t(bands), [&](size_t index, unsigned worker)
+		{
+			const int rowBegin = int(index) * rowsPerTask;
+			const int rowEnd = std::min(rowBegin + rowsPerTask, ySize);
+			generateRows(noiseOut, xStart, yStart, xSize, rowBegin, rowEnd, step, d_scratch[worker]);
+		});
+	});
+}
+
+int NoiseGraph::nodeCount() const
+{
+	return int(d_nodes.size());
+}
+
+int NoiseGraph::instructionCount() const
+{
+	return int(d_program.size());
+}
+
+int NoiseGraph::registerCount() const
+{
+	return d_registers;
+}
+
+SimdLevel NoiseGraph::level() const
+{
+	return d_level;
+}
+
+const HeightmapStats& NoiseGraph::stats() const
+{
+	return d_stats;
+}
+
+NoiseGraph::Node NoiseGraph::addNode(NodeDesc node)
+{
+	d_nodes.push_back(std::move(node));
+	return Node(d_nodes.size()) - 1;
+}
+
+void NoiseGraph::run(float* registers, float* noiseOut, int xStart, int yStart, int xSize, size_t first, int count, float step)
+{
+	auto block = [&](int index) { return index < 0 ? noiseOut : registers + size_t(index) * BlockSize; };
+
+	for (const Instruction& instruction : d_program)
+	{
+		float* dst = block(instruction.dst);
+		const NodeDesc& node = instruction.node >= 0 ? d_nodes[instruction.node] : d_nodes.front();
+
+		switch (instruction.op)
+		{
+		case Op::Grid:
+		{
+			float* x = dst;
+			float* y = dst + BlockSize;
+			int column = int(first % size_t(xSize));
+			int row = int(first / size_t(xSize));
+			for (int i = 0; i < count;)
+			{
+				const int run = std::min(count - i, xSize - column);
+				const float yCoord = float(yStart + row) * step;
+				for (int j = 0; j < run; j++, i++)
+				{
+					x[i] = float(xStart + column + j) * step;
+					y[i] = yCoord;
+				}
+				column = 0;
+				row++;
+			}
+			break;
+		}
+		case Op::Warp:
+		{
+			const float* from = block(instruction.a);
+			if (from != dst)
+			{
+				std::memcpy(dst, from, sizeof(float) * count);
+				std::memcpy(dst + BlockSize, from + BlockSize, sizeof(float) * count);
+			}
+			domainWarp2D(d_noises[node.noise], dst, dst + BlockSize, count, d_level);
+			break;
+		}
+		case Op::Source:
+		{
+			const float* positions = block(instruction.positions);
+			genNoise2D(d_noises[node.noise], positions, positions + BlockSize, dst, count, d_level);
+			break;
+		}
+		case Op::Constant:
+			std::fill(dst, dst + count, node.p0);
+			break;
+		case Op::Add:
+		{
+			const float* a = block(instruction.a);
+			const float* b = block(instruction.b);
+			for (int i = 0; i < count; i++)
+				dst[i] = a[i] + b[i];
+			break;
+		}
+		case Op::Mul:
+		{
+			const float* a = block(instruction.a);
+			const float* b = block(instruction.b);
+			for (int i = 0; i < count; i++)
+				dst[i] = a[i] * b[i];
+			break;
+		}
+		case Op::Blend:
+		{
+			const float* a = block(instruction.a);
+			const float* b = block(instruction.b);
+			const float* t = block(instruction.c);
+			for (int i = 0; i < count; i++)
+				dst[i] = a[i] + (b[i] - a[i]) * t[i];
+			break;
+		}
+		case Op::Clamp:
+		{
+			const float* a = block(instruction.a);
+			for (int i = 0; i < count; i++)
+				dst[i] = std::min(std::max(a[i], node.p0), node.p1);
+			break;
+		}
+		case Op::Curve:
+		{
+			const float* a = block(instruction.a);
+			for (int i = 0; i < count; i++)
+				dst[i] = evalCurve(node.points, a[i]);
+			break;
+		}
+		case Op::Terrace:
+		{
+			const float* a = block(instruction.a);
+			const float steps = node.p0;
+			const float smoothness = node.p1;
+			for (int i = 0; i < count; i++)
+			{
+				const float s = (a[i] + 1.0f) * 0.5f * steps;
+				const float k = std::floor(s);
+				float r = 0.0f;
+				if (smoothness > 0.0f)
+				{
+					r = std::min(std::max((s - k - (1.0f - smoothness)) / smoothness, 0.0f), 1.0f);
+					r = r * r * (3.0f - 2.0f * r);
+				}
+				dst[i] = (k + r) / steps * 2.0f - 1.0f;
+			}
+			break;
+		}
+		}
+	}
+}
+
+void NoiseGraph::generateRows(float* noiseOut, int xStart, int yStart, int xSize, int rowBegin, int rowEnd, float step, std::vector<float>& scratch)
+{
+	if (d_program.empty())
+		return;
+
+	scratch.resize(size_t(d_registers) * BlockSize);
+
+	const size_t end = size_t(rowEnd) * size_t(xSize);
+	for (size_t first = size_t(rowBegin) * size_t(xSize); first < end; first += BlockSize)
+	{
+		const int count = int(std::min(end - first, size_t(BlockSize)));
+		run(scratch.data(), noiseOut + first, xStart, yStart, xSize, first, count, step);
+	}
+}
+
+template <class F>
+void NoiseGraph::timed(int xSize, int ySize, F&& generateFn)
+{
+	auto begin = std::chrono::steady_clock::now();
+	generateFn();
+	auto end = std::chrono::steady_clock::now();
+
+	d_stats.lastMs = std::chrono::duration<double, std::milli>(end - begin).count();
+	d_stats.lastSamples = uint64_t(xSize) * uint64_t(ySize);
+	d_stats.totalMs += d_stats.lastMs;
+	d_stats.totalSamples += d_stats.lastSamples;
+	d_stats.runs++;
+}
+
+} // end namespace noise
@@ -0,0 +1,128 @@
+#pragma once
+#include "fast_noise.h"
+#include "fast_noise_simd.h"
+#include "heightmap_generator.h"
+#include "thread_pool.h"
+#include <vector>
+
+namespace noise
+{
+
+struct CurvePoint
+{
+	float in = 0.0f;
+	float out = 0.0f;
+};
+
+// Node graph of FastNoiseLite sources and per sample operations for terrain recipes. setOutput() compiles the
+// nodes reachable from the output into a register program; generation runs the whole program on one block of
+// BlockSize samples before moving to the next, so every intermediate lives in a block sized register (1 KiB)
+// that stays in L1 instead of a full size buffer per node. Registers are reused once their last reader ran.
+//
+// Nodes evaluate at the position of their context: the grid position, or the position moved by every warp
+// node above them. A node reached through different warps is evaluated once per warp context, one reached
+// twice in the same context once. Sources and warps run the vector kernels through genNoise2D and domainWarp2D,
+// so a lone source node matches genUniformGrid2D bit for bit.
+class NoiseGraph
+{
+public:
+	using Node = int;
+
+	static const int BlockSize = 256;
+
+	explicit NoiseGraph(SimdLevel level = detectSimdLevel());
+	~NoiseGraph() = default;
+	NoiseGraph(const NoiseGraph&) = delete;
+	NoiseGraph(NoiseGraph&&) = delete;
+	void operator=(const NoiseGraph&) = delete;
+	void operator=(NoiseGraph&&) = delete;
+
+	// noise.GetNoise at the context position, settings as of this call
+	Node source(const FastNoiseLite& noise);
+	Node constant(float value);
+	Node add(Node a, Node b);
+	Node mul(Node a, Node b);
+	// a + (b - a) * t
+	Node blend(Node a, Node b, Node t);
+	// input evaluated at the context position moved by warp.DomainWarp
+	Node warp(Node input, const FastNoiseLite& warp);
+	Node clamp(Node input, float min, float max);
+	// Piecewise linear through points (sorted by in here), constant beyond the first and last point
+	Node curve(Node input, std::vector<CurvePoint> points);
+	// Maps [-1, 1] onto steps flat levels; the last smoothness (0...1) of every step ramps to the next one
+	Node terrace(Node input, int steps, float smoothness);
+
+	// Drops every node and the program
+	void clear();
+	// Compiles the program that generates output
+	void setOutput(Node output);
+
+	// Row major, xSize * ySize floats, sample (x, y) taken at ((xStart + x) * step, (yStart + y) * step)
+	void generate(float* noiseOut, int xStart, int yStart, int xSize, int ySize, float step = 1.0f);
+	// Same output, bands of rows generated in parallel
+	void generate(util::ThreadPool& pool, float* noiseOut, int xStart, int yStart, int xSize, int ySize, float step = 1.0f);
+
+	[[nodiscard]] int nodeCount() const;
+	[[nodiscard]] int instructionCount() const;
+	// Block registers the program needs, values plus two per position context
+	[[nodiscard]] int registerCount() const;
+	[[nodiscard]] SimdLevel level() const;
+	[[nodiscard]] const HeightmapStats& stats() const;
+
+private:
+	enum class Op
+	{
+		Grid,     // positions of the block
+		Warp,     // positions of a, moved
+		Source,
+		Constant,
+		Add,
+		Mul,
+		Blend,
+		Clamp,
+		Curve,
+		Terrace
+	};
+
+	struct NodeDesc
+	{
+		Op op = Op::Constant;
+		Node a = -1;
+		Node b = -1;
+		Node c = -1;
+		int noise = -1; // index into d_noises for sources and warps
+		float p0 = 0.0f;
+		float p1 = 0.0f;
+		std::vector<CurvePoint> points;
+	};
+
+	// Registers: values are one block of floats, positions two (x then y). dst of the last instruction
+	// is -1, which writes straight to the output.
+	struct Instruction
+	{
+		Op op = Op::Constant;
+		int dst = -1;
+		int a = -1;
+		int b = -1;
+		int c = -1;
+		int positions = -1; // position register sources read
+		int node = -1;
+	};
+
+	SimdLevel d_level = SimdLevel::Scalar;
+	std::vector<NodeDesc> d_nodes;
+	std::vector<FastNoiseLite> d_noises;
+	std::vector<Instruction> d_program;
+	int d_registers = 0;
+	std::vector<std::vector<float>> d_scratch; // register file per pool thread
+	HeightmapStats d_stats;
+
+	// HELPERS
+	Node addNode(NodeDesc node);
+	void run(float* registers, float* noiseOut, int xStart, int yStart, int xSize, size_t first, int count, float step);
+	void generateRows(float* noiseOut, int xStart, int yStart, int xSize, int rowBegin, int rowEnd, float step, std::vector<float>& scratch);
+	template <class F>
+	void timed(int xSize, int ySize, F&& generateFn);
+};
+
+} // end namespace noise
@@ -0,0 +1,115 @@
+#include "octave_layer_cache.h"
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+
+namespace noise
+{
+
+bool OctaveLayerCache::Grid::operator==(const Grid& other) const
+{
+	return xStart == other.xStart && yStart == other.yStart && xSize == other.xSize && ySize == other.ySize &&
+		step == other.step && tileSize == other.tileSize;
+}
+
+OctaveLayerCache::OctaveLayerCache(SimdLevel level)
+	: d_level(level > detectSimdLevel() ? detectSimdLevel() : level)
+{}
+
+OctaveLayerCache::Update OctaveLayerCache::generateTiles(util::ThreadPool& pool, const FastNoiseLite& settings, int xStart, int yStart,
+														 int xSize, int ySize, float step, int tileSize, const HeightmapGenerator::TileCB& cb)
+{
+	assert(tileSize > 0);
+	auto begin = std::chrono::steady_clock::now();
+
+	const Grid grid{ xStart, yStart, xSize, ySize, step, tileSize };
+	const int tilesX = (xSize + tileSize - 1) / tileSize;
+	const int tilesY = (ySize + tileSize - 1) / tileSize;
+	const int octaves = settings.GetOctaveLayerCount();
+
+	Update update = Update::Recombined;
+	if (d_octaves == 0 || !(d_grid == grid) || !sameOctaveLayers(d_settings, settings))
+	{
+		update = Update::Rebuilt;
+		d_octaves = 0;
+		d_grid = grid;
+		d_tileLayers.assign(size_t(tilesX) * size_t(tilesY), std::vector<float>());
+	}
+	else if (octaves > d_octaves)
+	{
+		update = Update::Extended;
+	}
+
+	d_settings = settings;
+	d_tileScratch.resize(pool.concurrency());
+
+	const int firstOctave = d_octaves;
+	const int newOctaves = std::max(0, octaves - d_octaves);
+
+	pool.parallelFor(size_t(tilesX) * size_t(tilesY), [&](size_t index, unsigned worker)
+	{
+		int tx = int(index % size_t(tilesX)) * tileSize;
+		int ty = int(index / size_t(tilesX)) * tileSize;
+		int w = std::min(tileSize, xSize - tx);
+		int h = std::min(tileSize, ySize - ty);
+		const size_t layerSize = size_t(w) * size_t(h);
+
+		// growing keeps the layers already there, they sit octave major in front
+		std::vector<float>& layers = d_tileLayers[index];
+		if (newOctaves > 0)
+		{
+			layers.resize(layerSize * size_t(firstOctave + newOctaves));
+			genOctaveLayers2D(d_settings, layers.data() + layerSize * size_t(firstOctave), layerSize, firstOctave, newOctaves,
+							  xStart + tx, yStart + ty, w, h, step, d_level);
+		}
+
+		std::vector<float>& scratch = d_tileScratch[worker];
+		scratch.resize(size_t(tileSize) * size_t(tileSize));
+		combineOctaveLayers(d_settings, layers.data(), layerSize, scratch.data(), int(layerSize), d_level);
+
+		cb(scratch.data(), tx, ty, w, h);
+	});
+
+	d_octaves += newOctaves;
+
+	auto end = std::chrono::steady_clock::now();
+	d_stats.lastMs = std::chrono::duration<double, std::milli>(end - begin).count();
+	d_stats.lastSamples = uint64_t(xSize) * uint64_t(ySize);
+	d_stats.totalMs += d_stats.lastMs;
+	d_stats.totalSamples += d_stats.lastSamples;
+	d_stats.runs++;
+
+	return update;
+}
+
+void OctaveLayerCache::clear()
+{
+	d_octaves = 0;
+	d_tileLayers.clear();
+	d_tileLayers.shrink_to_fit();
+}
+
+int OctaveLayerCache::cachedOctaves() const
+{
+	return d_octaves;
+}
+
+size_t OctaveLayerCache::byteSize() const
+{
+	size_t bytes = 0;
+	for (const std::vector<float>& layers : d_tileLayers)
+		bytes += layers.size() * sizeof(float);
+	return bytes;
+}
+
+SimdLevel OctaveLayerCache::level() const
+{
+	return d_level;
+}
+
+const HeightmapStats& OctaveLayerCache::stats() const
+{
+	return d_stats;
+}
+
+} // end namespace noise
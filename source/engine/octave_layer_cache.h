@@ -0,0 +1,69 @@
+#pragma once
+#include "fast_noise.h"
+#include "fast_noise_simd.h"
+#include "heightmap_generator.h"
+#include "thread_pool.h"
+#include <vector>
+
+namespace noise
+{
+
+// Keeps the unweighted noise of every fractal octave for each tile of a 2D grid. Edits that only
+// change how octaves are weighted (fractal type, gain, weighted strength, ping pong strength, fewer
+// octaves) recombine the stored layers instead of evaluating noise again, more octaves only generate
+// the missing layers. Output matches HeightmapGenerator::generateTiles for the same settings.
+//
+// Memory is GetOctaveLayerCount() floats per sample, for the largest octave count seen since the last rebuild.
+class OctaveLayerCache
+{
+public:
+	enum class Update
+	{
+		Recombined, // weights only, no noise evaluated
+		Extended,   // octaves added on top of the cached ones
+		Rebuilt     // first call, grid or layer settings changed
+	};
+
+	explicit OctaveLayerCache(SimdLevel level = detectSimdLevel());
+	~OctaveLayerCache() = default;
+	OctaveLayerCache(const OctaveLayerCache&) = delete;
+	OctaveLayerCache(OctaveLayerCache&&) = delete;
+	void operator=(const OctaveLayerCache&) = delete;
+	void operator=(OctaveLayerCache&&) = delete;
+
+	// Same tiling and callback contract as HeightmapGenerator::generateTiles, with settings as of this call.
+	// An exception from cb leaves the cache usable, tiles that were not reached are brought up to date next call.
+	Update generateTiles(util::ThreadPool& pool, const FastNoiseLite& settings, int xStart, int yStart, int xSize, int ySize, float step,
+						 int tileSize, const HeightmapGenerator::TileCB& cb);
+
+	// Drops the layers, the next call rebuilds
+	void clear();
+
+	[[nodiscard]] int cachedOctaves() const;
+	[[nodiscard]] size_t byteSize() const;
+	[[nodiscard]] SimdLevel level() const;
+	[[nodiscard]] const HeightmapStats& stats() const;
+
+private:
+	struct Grid
+	{
+		int xStart = 0;
+		int yStart = 0;
+		int xSize = 0;
+		int ySize = 0;
+		float step = 0.0f;
+		int tileSize = 0;
+
+		bool operator==(const Grid& other) const;
+	};
+
+	SimdLevel d_level = SimdLevel::Scalar;
+	FastNoiseLite d_settings; // layer settings the cache was built with
+	Grid d_grid;
+	int d_octaves = 0;
+	std::vector<std::vector<float>> d_tileLayers; // octave major, w * h floats per layer
+	std::vector<std::vector<float>> d_tileScratch; // one per pool thread
+	HeightmapStats d_stats;
+};
+
+} // end namespace noise
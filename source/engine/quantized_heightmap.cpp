@@ -0,0 +1,336 @@
+#include "quantized_heightmap.h"
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+namespace noise
+{
+
+QuantizedHeightmap::QuantizedHeightmap(int width, int height, HeightFormat format, int tileSize)
+	: d_format(format)
+	, d_width(width)
+	, d_height(height)
+	, d_tileSize(tileSize)
+{
+	assert(width > 0 && height > 0 && tileSize > 0);
+	d_tilesX = (width + tileSize - 1) / tileSize;
+	d_tilesY = (height + tileSize - 1) / tileSize;
+	d_texels.resize(size_t(width) * size_t(height) * bytesPerTexel());
+	d_tiles.resize(size_t(d_tilesX) * size_t(d_tilesY));
+}
+
+void QuantizedHeightmap::generate(HeightmapGenerator& generator, util::ThreadPool& pool, int xStart, int yStart, float step)
+{
+	generate(generator, pool, TileCheckCB(), xStart, yStart, step);
+}
+
+void QuantizedHeightmap::generate(HeightmapGenerator& generator, util::ThreadPool& pool, const TileCheckCB& check, int xStart, int yStart,
+								  float step)
+{
+	generator.generateTiles(pool, xStart, yStart, d_width, d_height, step, d_tileSize,
+							[this, &check](const float* tile, int x, int y, int w, int h)
+	{
+		if (check)
+			check();
+		storeTile(tile, x, y, w, h);
+	});
+}
+
+OctaveLayerCache::Update QuantizedHeightmap::generate(OctaveLayerCache& cache, const FastNoiseLite& settings, util::ThreadPool& pool,
+													  int xStart, int yStart, float step)
+{
+	return generate(cache, settings, pool, TileCheckCB(), xStart, yStart, step);
+}
+
+OctaveLayerCache::Update QuantizedHeightmap::generate(OctaveLayerCache& cache, const FastNoiseLite& settings, util::ThreadPool& pool,
+													  const TileCheckCB& check, int xStart, int yStart, float step)
+{
+	return cache.generateTiles(pool, settings, xStart, yStart, d_width, d_height, step, d_tileSize,
+							   [this, &check](const float* tile, int x, int y, int w, int h)
+	{
+		if (check)
+			check();
+		storeTile(tile, x, y, w, h);
+	});
+}
+
+HeightFormat QuantizedHeightmap::format() const
+{
+	return d_format;
+}
+
+int QuantizedHeightmap::width() const
+{
+	return d_width;
+}
+
+int QuantizedHeightmap::height() const
+{
+	return d_height;
+}
+
+int QuantizedHeightmap::tileSize() const
+{
+	return d_tileSize;
+}
+
+int QuantizedHeightmap::tilesX() const
+{
+	return d_tilesX;
+}
+
+int QuantizedHeightmap::tilesY() const
+{
+	return d_tilesY;
+}
+
+const void* QuantizedHeightmap::data() const
+{
+	return d_texels.data();
+}
+
+size_t QuantizedHeightmap::byteSize() const
+{
+	return d_texels.size();
+}
+
+size_t QuantizedHeightmap::bytesPerTexel() const
+{
+	return heightFormatBytes(d_format);
+}
+
+const std::vector<HeightTileParams>& QuantizedHeightmap::tileParams() const
+{
+	return d_tiles;
+}
+
+float QuantizedHeightmap::height(int x, int y) const
+{
+	assert(x >= 0 && x < d_width && y >= 0 && y < d_height);
+	size_t index = size_t(y) * size_t(d_width) + size_t(x);
+
+	switch (d_format)
+	{
+	case HeightFormat::R16Unorm:
+	{
+		uint16_t texel;
+		std::memcpy(&texel, d_texels.data() + index * sizeof(uint16_t), sizeof(texel));
+		const HeightTileParams& tile = d_tiles[size_t(y / d_tileSize) * size_t(d_tilesX) + size_t(x / d_tileSize)];
+		return tile.min + (float(texel) / 65535.0f) * tile.range;
+	}
+	case HeightFormat::R16F:
+	{
+		uint16_t texel;
+		std::memcpy(&texel, d_texels.data() + index * sizeof(uint16_t), sizeof(texel));
+		return halfToFloat(texel);
+	}
+	default:
+	{
+		float texel;
+		std::memcpy(&texel, d_texels.data() + index * sizeof(float), sizeof(texel));
+		return texel;
+	}
+	}
+}
+
+void QuantizedHeightmap::decodeRow(int y, float* out) const
+{
+	assert(y >= 0 && y < d_height);
+	const uint8_t* row = d_texels.data() + size_t(y) * size_t(d_width) * bytesPerTexel();
+
+	switch (d_format)
+	{
+	case HeightFormat::R16Unorm:
+	{
+		const HeightTileParams* tiles = d_tiles.data() + size_t(y / d_tileSize) * size_t(d_tilesX);
+		for (int x = 0; x < d_width; x += d_tileSize)
+		{
+			const HeightTileParams& tile = tiles[x / d_tileSize];
+			const int end = std::min(x + d_tileSize, d_width);
+			for (int i = x; i < end; ++i)
+			{
+				uint16_t texel;
+				std::memcpy(&texel, row + size_t(i) * sizeof(uint16_t), sizeof(texel));
+				out[i] = tile.min + (float(texel) / 65535.0f) * tile.range;
+			}
+		}
+	}
+	break;
+	case HeightFormat::R16F:
+	{
+		for (int i = 0; i < d_width; ++i)
+		{
+			uint16_t texel;
+			std::memcpy(&texel, row + size_t(i) * sizeof(uint16_t), sizeof(texel));
+			out[i] = halfToFloat(texel);
+		}
+	}
+	break;
+	default:
+		std::memcpy(out, row, sizeof(float) * size_t(d_width));
+		break;
+	}
+}
+
+void QuantizedHeightmap::storeTile(const float* tile, int x, int y, int w, int h)
+{
+	HeightTileParams& params = d_tiles[size_t(y / d_tileSize) * size_t(d_tilesX) + size_t(x / d_tileSize)];
+	params = HeightTileParams{ 0.0f, 1.0f };
+	if (d_format == HeightFormat::R16Unorm)
+	{
+		const auto range = std::minmax_element(tile, tile + size_t(w) * size_t(h));
+		params = heightTileParams(*range.first, *range.second);
+	}
+
+	const size_t texelSize = bytesPerTexel();
+	for (int row = 0; row < h; ++row)
+	{
+		encodeHeights(d_format, params, tile + size_t(row) * size_t(w), w,
+					  d_texels.data() + (size_t(y + row) * size_t(d_width) + size_t(x)) * texelSize);
+	}
+}
+
+bool parseHeightFormat(const std::string& name, HeightFormat& format)
+{
+	if (name == "r32f")
+		format = HeightFormat::R32F;
+	else if (name == "r16")
+		format = HeightFormat::R16Unorm;
+	else if (name == "r16f")
+		format = HeightFormat::R16F;
+	else
+		return false;
+	return true;
+}
+
+const char* heightFormatName(HeightFormat format)
+{
+	switch (format)
+	{
+	case HeightFormat::R16Unorm:
+		return "r16";
+	case HeightFormat::R16F:
+		return "r16f";
+	default:
+		return "r32f";
+	}
+}
+
+size_t heightFormatBytes(HeightFormat format)
+{
+	return format == HeightFormat::R32F ? sizeof(float) : sizeof(uint16_t);
+}
+
+HeightTileParams heightTileParams(float lo, float hi)
+{
+	return HeightTileParams{ lo, hi - lo };
+}
+
+void encodeHeights(HeightFormat format, const HeightTileParams& params, const float* heights, int count, void* texels)
+{
+	switch (format)
+	{
+	case HeightFormat::R16Unorm:
+	{
+		// a flat tile decodes to min whatever the texels hold
+		const float toUnorm = params.range > 0.0f ? 65535.0f / params.range : 0.0f;
+		uint16_t* dst = static_cast<uint16_t*>(texels);
+		for (int i = 0; i < count; ++i)
+		{
+			float q = (heights[i] - params.min) * toUnorm + 0.5f;
+			dst[i] = uint16_t(std::min(q, 65535.0f));
+		}
+	}
+	break;
+	case HeightFormat::R16F:
+	{
+		uint16_t* dst = static_cast<uint16_t*>(texels);
+		for (int i = 0; i < count; ++i)
+			dst[i] = floatToHalf(heights[i]);
+	}
+	break;
+	default:
+		std::memcpy(texels, heights, sizeof(float) * size_t(count));
+		break;
+	}
+}
+
+uint16_t floatToHalf(float value)
+{
+	uint32_t bits;
+	std::memcpy(&bits, &value, sizeof(bits));
+
+	const uint32_t sign = (bits >> 16) & 0x8000u;
+	const uint32_t magnitude = bits & 0x7fffffffu;
+
+	// inf stays inf, nan keeps a quiet mantissa bit
+	if (magnitude >= 0x7f800000u)
+		return uint16_t(sign | 0x7c00u | (magnitude > 0x7f800000u ? 0x200u : 0u));
+
+	// 65520 and up round past the largest half
+	if (magnitude >= 0x477ff000u)
+		return uint16_t(sign | 0x7c00u);
+
+	const uint32_t exponent = magnitude >> 23;
+
+	// below 2^-14 the result is a half subnormal, below 2^-25 it rounds to zero
+	if (exponent < 113)
+	{
+		if (exponent < 102)
+			return uint16_t(sign);
+
+		const uint32_t mantissa = (magnitude & 0x7fffffu) | 0x800000u;
+		const uint32_t shift = 126 - exponent;
+		uint32_t half = mantissa >> shift;
+		const uint32_t rest = mantissa & ((1u << shift) - 1);
+		const uint32_t midpoint = 1u << (shift - 1);
+		if (rest > midpoint || (rest == midpoint && (half & 1)))
+			half++;
+		return uint16_t(sign | half);
+	}
+
+	// rebias the exponent, a mantissa carry correctly bumps it
+	uint32_t half = ((exponent - 112) << 10) | ((magnitude >> 13) & 0x3ffu);
+	const uint32_t rest = magnitude & 0x1fffu;
+	if (rest > 0x1000u || (rest == 0x1000u && (half & 1)))
+		half++;
+	return uint16_t(sign | half);
+}
+
+float halfToFloat(uint16_t value)
+{
+	const uint32_t sign = uint32_t(value & 0x8000u) << 16;
+	const uint32_t exponent = (value >> 10) & 0x1fu;
+	uint32_t mantissa = value & 0x3ffu;
+
+	uint32_t bits;
+	if (exponent == 0x1f)
+	{
+		bits = sign | 0x7f800000u | (mantissa << 13);
+	}
+	else if (exponent != 0)
+	{
+		bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+	}
+	else if (mantissa == 0)
+	{
+		bits = sign;
+	}
+	else
+	{
+		// normalize the subnormal
+		uint32_t e = 113;
+		while (!(mantissa & 0x400u))
+		{
+			mantissa <<= 1;
+			e--;
+		}
+		bits = sign | (e << 23) | ((mantissa & 0x3ffu) << 13);
+	}
+
+	float result;
+	std::memcpy(&result, &bits, sizeof(result));
+	return result;
+}
+
+} // end namespace noise
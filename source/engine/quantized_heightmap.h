@@ -0,0 +1,102 @@
+#pragma once
+#include "heightmap_generator.h"
+#include "octave_layer_cache.h"
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace noise
+{
+
+enum class HeightFormat
+{
+	R32F,     // plain float
+	R16Unorm, // 16 bit per texel, decoded with the tile's min and range
+	R16F      // half float, tile params are identity
+};
+
+// Decoding a R16Unorm texel: min + (texel / 65535) * range, which the GPU gives as min + unorm * range
+struct HeightTileParams
+{
+	float min = 0.0f;
+	float range = 1.0f;
+};
+
+// Heightmap stored in its upload format. Generation quantizes each tile straight out of the
+// generator's per-thread scratch, no float copy of the whole map is ever made.
+//
+// R16Unorm error is half a step of the tile's range, range / 131070, plus float rounding in the decode.
+// R16F keeps 11 significant bits, about 3 decimal digits of the absolute value.
+class QuantizedHeightmap
+{
+public:
+	QuantizedHeightmap(int width, int height, HeightFormat format, int tileSize = 64);
+	~QuantizedHeightmap() = default;
+	QuantizedHeightmap(const QuantizedHeightmap&) = delete;
+	QuantizedHeightmap(QuantizedHeightmap&&) = delete;
+	void operator=(const QuantizedHeightmap&) = delete;
+	void operator=(QuantizedHeightmap&&) = delete;
+
+	// Runs on pool threads before each tile is stored. An exception thrown from it abandons the generation and
+	// is rethrown from generate() once the tiles in flight finished, leaving the texels partly written.
+	using TileCheckCB = std::function<void()>;
+
+	// Samples the same grid as HeightmapGenerator::generate(pool, ...) with xSize, ySize = width, height
+	void generate(HeightmapGenerator& generator, util::ThreadPool& pool, int xStart = 0, int yStart = 0, float step = 1.0f);
+	void generate(HeightmapGenerator& generator, util::ThreadPool& pool, const TileCheckCB& check, int xStart = 0, int yStart = 0,
+				  float step = 1.0f);
+	// Same grid from cached octave layers, only settings that change the layers evaluate noise
+	OctaveLayerCache::Update generate(OctaveLayerCache& cache, const FastNoiseLite& settings, util::ThreadPool& pool,
+									  int xStart = 0, int yStart = 0, float step = 1.0f);
+	OctaveLayerCache::Update generate(OctaveLayerCache& cache, const FastNoiseLite& settings, util::ThreadPool& pool,
+									  const TileCheckCB& check, int xStart = 0, int yStart = 0, float step = 1.0f);
+
+	[[nodiscard]] HeightFormat format() const;
+	[[nodiscard]] int width() const;
+	[[nodiscard]] int height() const;
+	[[nodiscard]] int tileSize() const;
+	[[nodiscard]] int tilesX() const;
+	[[nodiscard]] int tilesY() const;
+
+	// Texels in format(), row major, width() * height() * bytesPerTexel() bytes
+	[[nodiscard]] const void* data() const;
+	[[nodiscard]] size_t byteSize() const;
+	[[nodiscard]] size_t bytesPerTexel() const;
+
+	// tilesX() * tilesY(), row major
+	[[nodiscard]] const std::vector<HeightTileParams>& tileParams() const;
+
+	// CPU side decode, matches what the terrain shader reconstructs
+	[[nodiscard]] float height(int x, int y) const;
+	// width() decoded heights of row y
+	void decodeRow(int y, float* out) const;
+
+private:
+	HeightFormat d_format = HeightFormat::R32F;
+	int d_width = 0;
+	int d_height = 0;
+	int d_tileSize = 64;
+	int d_tilesX = 0;
+	int d_tilesY = 0;
+	std::vector<uint8_t> d_texels;
+	std::vector<HeightTileParams> d_tiles;
+
+	// HELPERS
+	void storeTile(const float* tile, int x, int y, int w, int h);
+};
+
+bool parseHeightFormat(const std::string& name, HeightFormat& format);
+const char* heightFormatName(HeightFormat format);
+size_t heightFormatBytes(HeightFormat format);
+
+// Params R16Unorm texels of heights in [lo, hi] are stored with
+HeightTileParams heightTileParams(float lo, float hi);
+// count heights as texels of format, R16Unorm ones under params; what QuantizedHeightmap stores per tile
+void encodeHeights(HeightFormat format, const HeightTileParams& params, const float* heights, int count, void* texels);
+
+// IEEE 754 binary16, round to nearest even, overflow to infinity
+uint16_t floatToHalf(float value);
+float halfToFloat(uint16_t value);
+
+} // end namespace noise
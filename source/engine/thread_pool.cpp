@@ -0,0 +1,153 @@
+#include "thread_pool.h"
+#include <algorithm>
+#include <exception>
+
+namespace util
+{
+
+namespace
+{
+
+// Shared with the helper tasks of one parallelFor call, helpers may start after the call returned
+struct ForEachState
+{
+	ForEachState(size_t count, const ThreadPool::ForEachCB& cb)
+		: count(count)
+		, cb(cb)
+	{}
+
+	const size_t count;
+	const ThreadPool::ForEachCB& cb;
+
+	std::atomic<size_t> next{ 0 };
+	std::atomic<unsigned> participants{ 0 };
+
+	std::mutex mutex;
+	std::condition_variable finished;
+	size_t done = 0;
+	std::exception_ptr error;
+
+	void run()
+	{
+		// claim an index before touching cb, late helpers see the range exhausted and leave
+		size_t index = next.fetch_add(1);
+		if (index >= count)
+			return;
+
+		unsigned worker = participants.fetch_add(1);
+		size_t processed = 0;
+		std::exception_ptr localError;
+
+		for (; index < count; index = next.fetch_add(1))
+		{
+			if (!localError)
+			{
+				try
+				{
+					cb(index, worker);
+				}
+				catch (...)
+				{
+					localError = std::current_exception();
+				}
+			}
+			processed++;
+		}
+
+		std::lock_guard<std::mutex> lock(mutex);
+		if (localError && !error)
+			error = localError;
+		done += processed;
+		if (done == count)
+			finished.notify_all();
+	}
+};
+
+} // end unnamed namespace
+
+ThreadPool::ThreadPool(unsigned threads)
+{
+	if (threads == 0)
+		threads = std::max(1u, std::thread::hardware_concurrency());
+
+	d_workers.reserve(threads);
+	for (unsigned i = 0; i < threads; ++i)
+	{
+		d_workers.emplace_back([this]() { workerLoop(); });
+	}
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(d_mutex);
+		d_stop = true;
+	}
+	d_wake.notify_all();
+
+	for (std::thread& worker : d_workers)
+	{
+		worker.join();
+	}
+}
+
+unsigned ThreadPool::size() const
+{
+	return (unsigned)d_workers.size();
+}
+
+unsigned ThreadPool::concurrency() const
+{
+	return size() + 1;
+}
+
+void ThreadPool::parallelFor(size_t count, const ForEachCB& cb)
+{
+	if (count == 0)
+		return;
+
+	auto state = std::make_shared<ForEachState>(count, cb);
+
+	size_t helpers = std::min<size_t>(d_workers.size(), count - 1);
+	for (size_t i = 0; i < helpers; ++i)
+	{
+		enqueue([state]() { state->run(); });
+	}
+
+	state->run();
+
+	std::unique_lock<std::mutex> lock(state->mutex);
+	state->finished.wait(lock, [&state]() { return state->done == state->count; });
+
+	if (state->error)
+		std::rethrow_exception(state->error);
+}
+
+void ThreadPool::enqueue(std::function<void()> task)
+{
+	{
+		std::lock_guard<std::mutex> lock(d_mutex);
+		d_tasks.push_back(std::move(task));
+	}
+	d_wake.notify_one();
+}
+
+void ThreadPool::workerLoop()
+{
+	for (;;)
+	{
+		std::function<void()> task;
+		{
+			std::unique_lock<std::mutex> lock(d_mutex);
+			d_wake.wait(lock, [this]() { return d_stop || !d_tasks.empty(); });
+			if (d_stop && d_tasks.empty())
+				return;
+
+			task = std::move(d_tasks.front());
+			d_tasks.pop_front();
+		}
+		task();
+	}
+}
+
+} // end namespace util
@@ -0,0 +1,62 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace util
+{
+
+class ThreadPool
+{
+public:
+	using ForEachCB = std::function<void(size_t index, unsigned worker)>;
+
+	// number of worker threads, 0 uses every hardware thread
+	explicit ThreadPool(unsigned threads = 0);
+	~ThreadPool();
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool(ThreadPool&&) = delete;
+	void operator=(const ThreadPool&) = delete;
+	void operator=(ThreadPool&&) = delete;
+
+	[[nodiscard]] unsigned size() const;
+	// workers plus the thread calling parallelFor, upper bound (exclusive) of the worker argument
+	[[nodiscard]] unsigned concurrency() const;
+
+	template <class F>
+	auto submit(F&& task) -> std::future<decltype(task())>
+	{
+		using R = decltype(task());
+		auto packaged = std::make_shared<std::packaged_task<R()>>(std::forward<F>(task));
+		std::future<R> result = packaged->get_future();
+		enqueue([packaged]() { (*packaged)(); });
+		return result;
+	}
+
+	// Calls cb(index, worker) for every index in [0, count) and blocks until all returned.
+	// The calling thread takes part, so nesting inside pool tasks can't deadlock.
+	// worker is below concurrency() and unique among the threads serving this call, use it
+	// to pick per-thread scratch memory.
+	// The first exception thrown by a callback is rethrown here once the others finished.
+	void parallelFor(size_t count, const ForEachCB& cb);
+
+private:
+	std::vector<std::thread> d_workers;
+	std::deque<std::function<void()>> d_tasks;
+	std::mutex d_mutex;
+	std::condition_variable d_wake;
+	bool d_stop = false;
+
+	// HELPERS
+	void enqueue(std::function<void()> task);
+	void workerLoop();
+};
+
+} // end namespace util
@@ -0,0 +1,476 @@
+#include "toroidal_clipmap.h"
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+
+namespace noise
+{
+
+namespace
+{
+
+// Below this many samples an update generates on the calling thread, waking the pool costs more
+const size_t MinParallelSamples = 16 * 1024;
+
+// Texels along a side of a tile
+const int BoundsTileSize = 16;
+
+// Non-negative x mod size for a power of two size
+int wrap(int x, int size)
+{
+	return x & (size - 1);
+}
+
+// Of tile (tx, ty) of a size x size level
+HeightBounds tileBounds(const float* texels, int size, int tileSize, int tx, int ty)
+{
+	HeightBounds bounds{ INFINITY, -INFINITY };
+	for (int y = ty * tileSize; y < (ty + 1) * tileSize; ++y)
+	{
+		const float* row = texels + size_t(y) * size_t(size) + size_t(tx * tileSize);
+		const auto range = std::minmax_element(row, row + tileSize);
+		bounds.min = std::min(bounds.min, *range.first);
+		bounds.max = std::max(bounds.max, *range.second);
+	}
+	return bounds;
+}
+
+// Texels [x, x + w) x [y, y + h) of a size x size level into out, row major in format. R16Unorm areas are whole
+// tiles, each encoded with its entry of params.
+void encodeTexels(const float* texels, const HeightTileParams* params, int size, int tileSize, HeightFormat format, int x, int y, int w,
+				  int h, uint8_t* out)
+{
+	const size_t texelSize = heightFormatBytes(format);
+	const int tiles = size / tileSize;
+	for (int row = 0; row < h; ++row)
+	{
+		const float* src = texels + size_t(y + row) * size_t(size);
+		uint8_t* dst = out + size_t(row) * size_t(w) * texelSize;
+		if (format != HeightFormat::R16Unorm)
+		{
+			encodeHeights(format, HeightTileParams{}, src + x, w, dst);
+			continue;
+		}
+
+		for (int tx = x; tx < x + w; tx += tileSize)
+		{
+			const HeightTileParams& tile = params[size_t((y + row) / tileSize) * size_t(tiles) + size_t(tx / tileSize)];
+			encodeHeights(format, tile, src + tx, tileSize, dst + size_t(tx - x) * texelSize);
+		}
+	}
+}
+
+} // end unnamed namespace
+
+// Every level generated whole on the pool. Only the pool task touches it until it is done.
+struct ToroidalClipmap::Refill
+{
+	FastNoiseLite noise;
+	std::vector<Window> windows;  // x, y of the target, the rest filled by the task
+	std::vector<uint8_t> encoded; // every layer in the clipmap's format, one after the other
+	std::atomic<bool> cancelled{ false };
+};
+
+ToroidalClipmap::ToroidalClipmap(int size, int levels, HeightFormat format, SimdLevel level)
+	: d_size(size)
+	, d_tileSize(std::min(size, BoundsTileSize))
+	, d_tiles(size / d_tileSize)
+	, d_level(level > detectSimdLevel() ? detectSimdLevel() : level)
+	, d_format(format)
+	, d_windows(size_t(levels))
+{
+	// the windows get their texels from the first refill
+	assert(size >= 8 && (size & (size - 1)) == 0 && levels > 0 && levels < 31);
+}
+
+ToroidalClipmap::~ToroidalClipmap()
+{
+	if (d_refill)
+		d_refill->cancelled = true;
+}
+
+void ToroidalClipmap::setNoise(const FastNoiseLite& noise)
+{
+	d_nextNoise = noise;
+	d_noiseChanged = true;
+}
+
+void ToroidalClipmap::update(util::ThreadPool& pool, double x, double y, const UploadCB& cb)
+{
+	assert((d_noiseChanged || d_refill || ready()) && "setNoise() before the first update()");
+	d_regions.clear();
+	d_lastSamples = 0;
+
+	// the strips below catch the swapped in windows up with the camera
+	swapRefill(cb);
+
+	if (d_noiseChanged)
+	{
+		startRefill(d_nextNoise, pool, x, y);
+		d_noiseChanged = false;
+	}
+	if (!ready())
+		return;
+
+	// a window that moved further than its size keeps nothing, the levels wait for a refill at the new position
+	for (int level = 0; level < levels(); ++level)
+	{
+		const Window& window = d_windows[size_t(level)];
+		if (std::abs(snap(level, x) - window.x) >= d_size || std::abs(snap(level, y) - window.y) >= d_size)
+		{
+			if (!d_refill)
+				startRefill(d_noise, pool, x, y);
+			return;
+		}
+	}
+
+	for (int level = 0; level < levels(); ++level)
+	{
+		Window& window = d_windows[size_t(level)];
+		const int newX = snap(level, x);
+		const int newY = snap(level, y);
+
+		// columns that came in over the full new height, then rows over the columns that stayed
+		if (newX > window.x)
+			addRegion(level, window.x + d_size, newY, newX - window.x, d_size);
+		else if (newX < window.x)
+			addRegion(level, newX, newY, window.x - newX, d_size);
+
+		const int keptX = std::max(newX, window.x);
+		const int keptW = d_size - std::abs(newX - window.x);
+		if (newY > window.y)
+			addRegion(level, keptX, window.y + d_size, keptW, newY - window.y);
+		else if (newY < window.y)
+			addRegion(level, keptX, newY, keptW, window.y - newY);
+
+		window.x = newX;
+		window.y = newY;
+	}
+
+	size_t total = 0;
+	for (Region& region : d_regions)
+	{
+		region.offset = total;
+		total += size_t(region.w) * size_t(region.h);
+	}
+	d_samples.resize(total);
+
+	auto generate = [&](size_t index, unsigned)
+	{
+		const Region& region = d_regions[index];
+		genUniformGrid2D(d_noise, d_samples.data() + region.offset, region.x, region.y, region.w, region.h, float(1 << region.level),
+						 d_level);
+	};
+
+	if (total >= MinParallelSamples)
+	{
+		pool.parallelFor(d_regions.size(), generate);
+	}
+	else
+	{
+		for (size_t i = 0; i < d_regions.size(); ++i)
+			generate(i, 0);
+	}
+
+	// tiles a region touched are rescanned whole, they may hold texels of other regions
+	for (const Region& region : d_regions)
+		storeRegion(region);
+
+	// R16Unorm texels follow their tile's range, which the new samples may have changed: whole tiles go up
+	d_uploads.clear();
+	size_t bytes = 0;
+	for (const Region& region : d_regions)
+	{
+		Upload upload;
+		upload.level = region.level;
+		upload.x = wrap(region.x, d_size);
+		upload.y = wrap(region.y, d_size);
+		upload.w = region.w;
+		upload.h = region.h;
+		if (d_format == HeightFormat::R16Unorm)
+		{
+			upload.w = (upload.x + upload.w + d_tileSize - 1) / d_tileSize * d_tileSize - upload.x / d_tileSize * d_tileSize;
+			upload.h = (upload.y + upload.h + d_tileSize - 1) / d_tileSize * d_tileSize - upload.y / d_tileSize * d_tileSize;
+			upload.x = upload.x / d_tileSize * d_tileSize;
+			upload.y = upload.y / d_tileSize * d_tileSize;
+			if (d_uploads.empty() || d_uploads.back().level != region.level)
+				upload.tileParams = d_windows[size_t(region.level)].params.data();
+		}
+		d_uploads.push_back(upload);
+		bytes += size_t(upload.w) * size_t(upload.h) * heightFormatBytes(d_format);
+	}
+
+	d_encoded.resize(bytes);
+	bytes = 0;
+	for (Upload& upload : d_uploads)
+	{
+		const Window& window = d_windows[size_t(upload.level)];
+		encodeTexels(window.texels.data(), window.params.data(), d_size, d_tileSize, d_format, upload.x, upload.y, upload.w, upload.h,
+					 d_encoded.data() + bytes);
+		upload.texels = d_encoded.data() + bytes;
+		bytes += size_t(upload.w) * size_t(upload.h) * heightFormatBytes(d_format);
+	}
+
+	for (const Upload& upload : d_uploads)
+		cb(upload);
+
+	d_lastSamples = total;
+	d_totalSamples += total;
+}
+
+bool ToroidalClipmap::ready() const
+{
+	return d_windows.front().filled;
+}
+
+bool ToroidalClipmap::refilling() const
+{
+	return d_refill != nullptr;
+}
+
+int ToroidalClipmap::size() const
+{
+	return d_size;
+}
+
+int ToroidalClipmap::levels() const
+{
+	return int(d_windows.size());
+}
+
+HeightFormat ToroidalClipmap::format() const
+{
+	return d_format;
+}
+
+int ToroidalClipmap::tileSize() const
+{
+	return d_tileSize;
+}
+
+int ToroidalClipmap::tiles() const
+{
+	return d_tiles;
+}
+
+int ToroidalClipmap::originX(int level) const
+{
+	return d_windows[size_t(level)].x;
+}
+
+int ToroidalClipmap::originY(int level) const
+{
+	return d_windows[size_t(level)].y;
+}
+
+int ToroidalClipmap::texelX(int level) const
+{
+	return wrap(originX(level), d_size);
+}
+
+int ToroidalClipmap::texelY(int level) const
+{
+	return wrap(originY(level), d_size);
+}
+
+HeightBounds ToroidalClipmap::regionBounds(int level, int x, int y, int w, int h) const
+{
+	const Window& window = d_windows[size_t(level)];
+	const int x0 = std::max(x, window.x);
+	const int y0 = std::max(y, window.y);
+	const int x1 = std::min(x + w, window.x + d_size);
+	const int y1 = std::min(y + h, window.y + d_size);
+	if (!window.filled || x0 >= x1 || y0 >= y1)
+		return HeightBounds{};
+
+	// tiles are in texel space, the region may wrap around the texture edge
+	HeightBounds result{ INFINITY, -INFINITY };
+	const int wx = wrap(x0, d_size);
+	const int wy = wrap(y0, d_size);
+	const int tx0 = wx / d_tileSize;
+	const int ty0 = wy / d_tileSize;
+	const int tilesX = std::min((wx + x1 - x0 - 1) / d_tileSize - tx0 + 1, d_tiles);
+	const int tilesY = std::min((wy + y1 - y0 - 1) / d_tileSize - ty0 + 1, d_tiles);
+	for (int j = 0; j < tilesY; ++j)
+	{
+		for (int i = 0; i < tilesX; ++i)
+		{
+			const HeightBounds& tile = window.tiles[size_t((ty0 + j) % d_tiles) * size_t(d_tiles) + size_t((tx0 + i) % d_tiles)];
+			result.min = std::min(result.min, tile.min);
+			result.max = std::max(result.max, tile.max);
+		}
+	}
+	return result;
+}
+
+uint64_t ToroidalClipmap::lastSamples() const
+{
+	return d_lastSamples;
+}
+
+uint64_t ToroidalClipmap::totalSamples() const
+{
+	return d_totalSamples;
+}
+
+int ToroidalClipmap::snap(int level, double pos) const
+{
+	// same snap as the clipmap geometry, m = size / 4 vertices per block
+	const double spacing = std::ldexp(1.0, level + 1);
+	return 2 * int(std::floor(pos / spacing)) - (d_size / 2 - 2);
+}
+
+void ToroidalClipmap::swapRefill(const UploadCB& cb)
+{
+	if (!d_refill || d_refillDone.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+		return;
+	d_refillDone.get();
+
+	Refill& refill = *d_refill;
+	const size_t layerBytes = size_t(d_size) * size_t(d_size) * heightFormatBytes(d_format);
+	for (int level = 0; level < levels(); ++level)
+	{
+		Window& window = d_windows[size_t(level)];
+		window = std::move(refill.windows[size_t(level)]);
+
+		Upload upload;
+		upload.level = level;
+		upload.w = d_size;
+		upload.h = d_size;
+		upload.texels = refill.encoded.data() + size_t(level) * layerBytes;
+		if (d_format == HeightFormat::R16Unorm)
+			upload.tileParams = window.params.data();
+		cb(upload);
+	}
+
+	d_noise = refill.noise;
+	d_totalSamples += uint64_t(levels()) * uint64_t(d_size) * uint64_t(d_size);
+	d_refill.reset();
+}
+
+void ToroidalClipmap::startRefill(const FastNoiseLite& noise, util::ThreadPool& pool, double x, double y)
+{
+	// one in flight is for older noise or windows, it stops at its next band of tiles
+	if (d_refill)
+		d_refill->cancelled = true;
+
+	d_refill = std::make_shared<Refill>();
+	d_refill->noise = noise;
+	d_refill->windows.resize(size_t(levels()));
+	for (int level = 0; level < levels(); ++level)
+	{
+		Window& window = d_refill->windows[size_t(level)];
+		window.x = snap(level, x);
+		window.y = snap(level, y);
+		window.filled = true;
+	}
+
+	// the task sees nothing of this, so a cancelled one may run past the clipmap's lifetime
+	const std::shared_ptr<Refill> refill = d_refill;
+	const int size = d_size;
+	const int tileSize = d_tileSize;
+	const int tiles = d_tiles;
+	const HeightFormat format = d_format;
+	const SimdLevel simdLevel = d_level;
+	d_refillDone = pool.submit([refill, &pool, size, tileSize, tiles, format, simdLevel]()
+	{
+		const size_t layerBytes = size_t(size) * size_t(size) * heightFormatBytes(format);
+		refill->encoded.resize(refill->windows.size() * layerBytes);
+		for (Window& window : refill->windows)
+		{
+			window.texels.resize(size_t(size) * size_t(size));
+			window.tiles.resize(size_t(tiles) * size_t(tiles));
+			window.params.resize(window.tiles.size());
+		}
+
+		// a band is a row of tiles of one level: generated, scanned and encoded in one go
+		pool.parallelFor(refill->windows.size() * size_t(tiles), [&](size_t index, unsigned)
+		{
+			if (refill->cancelled)
+				return;
+
+			const int level = int(index / size_t(tiles));
+			const int band = int(index % size_t(tiles));
+			Window& window = refill->windows[size_t(level)];
+			const int texelX = wrap(window.x, size);
+			const int texelY = wrap(window.y, size);
+			for (int ty = band * tileSize; ty < (band + 1) * tileSize; ++ty)
+			{
+				// texel row ty holds grid row y, split where the columns wrap around
+				const int y = window.y + wrap(ty - texelY, size);
+				float* row = window.texels.data() + size_t(ty) * size_t(size);
+				genUniformGrid2D(refill->noise, row + texelX, window.x, y, size - texelX, 1, float(1 << level), simdLevel);
+				if (texelX > 0)
+					genUniformGrid2D(refill->noise, row, window.x + size - texelX, y, texelX, 1, float(1 << level), simdLevel);
+			}
+
+			for (int tx = 0; tx < tiles; ++tx)
+			{
+				const size_t tile = size_t(band) * size_t(tiles) + size_t(tx);
+				window.tiles[tile] = tileBounds(window.texels.data(), size, tileSize, tx, band);
+				window.params[tile] = heightTileParams(window.tiles[tile].min, window.tiles[tile].max);
+			}
+
+			const size_t rowBytes = size_t(size) * heightFormatBytes(format);
+			encodeTexels(window.texels.data(), window.params.data(), size, tileSize, format, 0, band * tileSize, size, tileSize,
+						 refill->encoded.data() + size_t(level) * layerBytes + size_t(band * tileSize) * rowBytes);
+		});
+	});
+}
+
+void ToroidalClipmap::addRegion(int level, int x, int y, int w, int h)
+{
+	// split where the area wraps around the texture edge, each piece uploads as one rectangle
+	const int splitX = d_size - wrap(x, d_size);
+	const int splitY = d_size - wrap(y, d_size);
+
+	for (int py = 0; py < h;)
+	{
+		const int ph = py == 0 ? std::min(h, splitY) : h - py;
+		for (int px = 0; px < w;)
+		{
+			const int pw = px == 0 ? std::min(w, splitX) : w - px;
+
+			Region region;
+			region.level = level;
+			region.x = x + px;
+			region.y = y + py;
+			region.w = pw;
+			region.h = ph;
+			d_regions.push_back(region);
+
+			px += pw;
+		}
+		py += ph;
+	}
+}
+
+void ToroidalClipmap::storeRegion(const Region& region)
+{
+	Window& window = d_windows[size_t(region.level)];
+	const int tx = wrap(region.x, d_size);
+	const int ty = wrap(region.y, d_size);
+	const float* samples = d_samples.data() + region.offset;
+	for (int row = 0; row < region.h; ++row)
+	{
+		std::copy(samples + size_t(row) * size_t(region.w), samples + size_t(row + 1) * size_t(region.w),
+				  window.texels.begin() + ptrdiff_t(size_t(ty + row) * size_t(d_size) + size_t(tx)));
+	}
+
+	for (int y = ty / d_tileSize; y <= (ty + region.h - 1) / d_tileSize; ++y)
+	{
+		for (int x = tx / d_tileSize; x <= (tx + region.w - 1) / d_tileSize; ++x)
+			updateTileBounds(window, x, y);
+	}
+}
+
+void ToroidalClipmap::updateTileBounds(Window& window, int tx, int ty)
+{
+	const size_t tile = size_t(ty) * size_t(d_tiles) + size_t(tx);
+	window.tiles[tile] = tileBounds(window.texels.data(), d_size, d_tileSize, tx, ty);
+	window.params[tile] = heightTileParams(window.tiles[tile].min, window.tiles[tile].max);
+}
+
+} // end namespace noise
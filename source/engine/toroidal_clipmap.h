@@ -0,0 +1,138 @@
+#pragma once
+#include "fast_noise.h"
+#include "fast_noise_simd.h"
+#include "height_pyramid.h"
+#include "quantized_heightmap.h"
+#include "thread_pool.h"
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <vector>
+
+namespace noise
+{
+
+// CPU side of toroidally addressed geometry clipmap textures. Level l keeps a size x size window of noise samples
+// at spacing 2^l (in finest grid units) around the camera, sample (gx, gy) of the level grid lives in texel
+// (gx mod size, gy mod size). Moving the window never moves texels, only the L of rows and columns that came into
+// view is generated and handed out for upload, so the cost follows camera speed, not the window size.
+//
+// size is the clipmap's dim_n + 1, a power of two. The windows snap like the clipmap geometry: the lower corner of
+// level l sits on an even level grid index, the camera in the middle, and the window covers all of its vertices.
+//
+// Uploads are encoded in a HeightFormat. R16Unorm texels are stored with the min and range of their tileSize()^2
+// tile of texels, so an upload grows to whole tiles and carries the level's tile params along.
+//
+// Filling levels whole (the first time, after setNoise(), after a jump further than a window) is left to a refill
+// on the pool that covers every level and is swapped in all at once, update() itself only generates strips.
+class ToroidalClipmap
+{
+public:
+	// Texels [x, x + w) x [y, y + h) of a level texture, never crossing its edge. texels is w * h of format(), row
+	// major. tileParams is set on the first upload of a level with R16Unorm, the level's tiles()^2 row major, both
+	// valid until the next update().
+	struct Upload
+	{
+		int level = 0;
+		int x = 0;
+		int y = 0;
+		int w = 0;
+		int h = 0;
+		const void* texels = nullptr;
+		const HeightTileParams* tileParams = nullptr;
+	};
+
+	using UploadCB = std::function<void(const Upload& upload)>;
+
+	ToroidalClipmap(int size, int levels, HeightFormat format, SimdLevel level = detectSimdLevel());
+	// Cancels a refill in flight without waiting for it
+	~ToroidalClipmap();
+	ToroidalClipmap(const ToroidalClipmap&) = delete;
+	ToroidalClipmap(ToroidalClipmap&&) = delete;
+	void operator=(const ToroidalClipmap&) = delete;
+	void operator=(ToroidalClipmap&&) = delete;
+
+	// Noise the levels are generated from, copied. The next update() starts a refill with it, until that is swapped
+	// in the levels keep following the camera with the previous noise. Required before the first update().
+	void setNoise(const FastNoiseLite& noise);
+	// Moves every window to the camera at finest grid position (x, y) and generates the strips that entered on the
+	// calling thread. Swaps in a refill that finished, and starts one when a window would have to be filled whole;
+	// the windows stay where they are until it is swapped in. Never waits for the pool.
+	void update(util::ThreadPool& pool, double x, double y, const UploadCB& cb);
+	// Every level holds samples, which takes the first refill
+	[[nodiscard]] bool ready() const;
+	// A refill is generating on the pool
+	[[nodiscard]] bool refilling() const;
+
+	[[nodiscard]] int size() const;
+	[[nodiscard]] int levels() const;
+	[[nodiscard]] HeightFormat format() const;
+	// Texels along a side of a bounds and R16Unorm tile, and tiles along a side of a level
+	[[nodiscard]] int tileSize() const;
+	[[nodiscard]] int tiles() const;
+	// Lower corner of the window, in grid units of the level
+	[[nodiscard]] int originX(int level) const;
+	[[nodiscard]] int originY(int level) const;
+	// Texel of the window's lower corner, where the toroidal addressing starts
+	[[nodiscard]] int texelX(int level) const;
+	[[nodiscard]] int texelY(int level) const;
+	// Conservative bounds of the samples [x, x + w) x [y, y + h) of a level grid, clipped to the window. Kept per
+	// tile of texels and refreshed for the tiles an update() writes, so the query reads a handful of tiles.
+	[[nodiscard]] HeightBounds regionBounds(int level, int x, int y, int w, int h) const;
+	// Samples the last update() generated on the calling thread, and every one since construction including refills
+	[[nodiscard]] uint64_t lastSamples() const;
+	[[nodiscard]] uint64_t totalSamples() const;
+
+private:
+	struct Window
+	{
+		int x = 0;
+		int y = 0;
+		bool filled = false;
+		std::vector<float> texels;            // the level texture's heights, size * size
+		std::vector<HeightBounds> tiles;      // of each tile of texels
+		std::vector<HeightTileParams> params; // R16Unorm encoding of each tile
+	};
+
+	// Level grid area to generate, already split at the texture edges
+	struct Region
+	{
+		int level = 0;
+		int x = 0;
+		int y = 0;
+		int w = 0;
+		int h = 0;
+		size_t offset = 0; // into d_samples
+	};
+
+	struct Refill;
+
+	int d_size = 0;
+	int d_tileSize = 0; // texels along a bounds tile
+	int d_tiles = 0;    // bounds tiles along a side
+	SimdLevel d_level = SimdLevel::Scalar;
+	HeightFormat d_format = HeightFormat::R32F;
+	std::vector<Window> d_windows;
+	std::vector<Region> d_regions;
+	std::vector<float> d_samples;
+	std::vector<Upload> d_uploads;
+	std::vector<uint8_t> d_encoded; // texels of d_uploads
+	FastNoiseLite d_noise;          // of the samples in the windows
+	FastNoiseLite d_nextNoise;      // of setNoise(), for the next refill
+	bool d_noiseChanged = false;
+	std::shared_ptr<Refill> d_refill; // shared with the pool task, which outlives it when cancelled
+	std::future<void> d_refillDone;
+	uint64_t d_lastSamples = 0;
+	uint64_t d_totalSamples = 0;
+
+	// HELPERS
+	int snap(int level, double pos) const;
+	void swapRefill(const UploadCB& cb);
+	void startRefill(const FastNoiseLite& noise, util::ThreadPool& pool, double x, double y);
+	void addRegion(int level, int x, int y, int w, int h);
+	void storeRegion(const Region& region);
+	void updateTileBounds(Window& window, int tx, int ty);
+};
+
+} // end namespace noise
@@ -0,0 +1,120 @@
+#include "volume_generator.h"
+#include <algorithm>
+#include <cassert>
+#include <future>
+
+namespace noise
+{
+
+namespace
+{
+
+// Rows per work item, keeps the pool busy when a batch has fewer slices than threads
+const int RowsPerTask = 16;
+
+} // end unnamed namespace
+
+VolumeGenerator::VolumeGenerator(const FastNoiseLite& settings, SimdLevel level)
+	: d_settings(settings)
+	, d_level(level > detectSimdLevel() ? detectSimdLevel() : level)
+{}
+
+void VolumeGenerator::generate(util::ThreadPool& pool, float* noiseOut, int xStart, int yStart, int zStart, int xSize, int ySize, int zSize, float step)
+{
+	fillSlices(pool, noiseOut, xStart, yStart, zStart, xSize, ySize, zSize, step);
+}
+
+void VolumeGenerator::generateSlices(util::ThreadPool& pool, int xStart, int yStart, int zStart, int xSize, int ySize, int zSize, float step,
+									 const SliceCB& cb)
+{
+	if (zSize <= 0)
+		return;
+
+	const size_t sliceSize = size_t(xSize) * size_t(ySize);
+	const int budget = d_sliceBudget > 0 ? d_sliceBudget : int(2 * pool.concurrency());
+	const int batch = std::max(1, budget / 2);
+
+	d_sliceBuffers.resize(sliceSize * size_t(batch) * 2);
+	float* buffers[2] = { d_sliceBuffers.data(), d_sliceBuffers.data() + sliceSize * size_t(batch) };
+
+	auto fill = [&](float* out, int z)
+	{
+		int count = std::min(batch, zSize - z);
+		int zFirst = zStart + z;
+		return pool.submit([this, &pool, out, xStart, yStart, zFirst, xSize, ySize, count, step]()
+		{
+			fillSlices(pool, out, xStart, yStart, zFirst, xSize, ySize, count, step);
+		});
+	};
+
+	std::future<void> pending = fill(buffers[0], 0);
+	int current = 0;
+
+	for (int z = 0; z < zSize; z += batch)
+	{
+		pending.get();
+
+		// start on the next batch before handing out this one
+		if (z + batch < zSize)
+			pending = fill(buffers[current ^ 1], z + batch);
+
+		try
+		{
+			int count = std::min(batch, zSize - z);
+			for (int i = 0; i < count; ++i)
+				cb(buffers[current] + sliceSize * size_t(i), z + i);
+		}
+		catch (...)
+		{
+			if (pending.valid())
+				pending.wait();
+			throw;
+		}
+
+		current ^= 1;
+	}
+}
+
+void VolumeGenerator::fillSlices(util::ThreadPool& pool, float* out, int xStart, int yStart, int zStart, int xSize, int ySize, int zCount, float step)
+{
+	const size_t sliceSize = size_t(xSize) * size_t(ySize);
+	const int bands = (ySize + RowsPerTask - 1) / RowsPerTask;
+
+	pool.parallelFor(size_t(zCount) * size_t(bands), [&](size_t index, unsigned)
+	{
+		int z = int(index / size_t(bands));
+		int y = int(index % size_t(bands)) * RowsPerTask;
+		int rows = std::min(RowsPerTask, ySize - y);
+
+		float* dst = out + sliceSize * size_t(z) + size_t(y) * size_t(xSize);
+		genUniformGrid3D(d_settings, dst, xStart, yStart + y, zStart + z, xSize, rows, 1, step, d_level);
+	});
+}
+
+void VolumeGenerator::setSliceBudget(int slices)
+{
+	assert(slices == 0 || slices >= 2);
+	d_sliceBudget = slices;
+}
+
+int VolumeGenerator::sliceBudget() const
+{
+	return d_sliceBudget;
+}
+
+FastNoiseLite& VolumeGenerator::settings()
+{
+	return d_settings;
+}
+
+const FastNoiseLite& VolumeGenerator::settings() const
+{
+	return d_settings;
+}
+
+SimdLevel VolumeGenerator::level() const
+{
+	return d_level;
+}
+
+} // end namespace noise
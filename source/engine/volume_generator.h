@@ -0,0 +1,55 @@
+#pragma once
+#include "fast_noise.h"
+#include "fast_noise_simd.h"
+#include "thread_pool.h"
+#include <functional>
+#include <vector>
+
+namespace noise
+{
+
+// Fills 3D density chunks (caves, overhangs, clouds) from a FastNoiseLite configuration with the
+// vector kernels on a thread pool. Every sample only depends on its integer grid position, so the
+// output matches FastNoiseLite::GenUniformGrid3D for any thread count, slice order or budget.
+class VolumeGenerator
+{
+public:
+	// slice holds xSize * ySize samples, row major, for grid layer z (relative to zStart).
+	// It is only valid until the callback returns.
+	using SliceCB = std::function<void(const float* slice, int z)>;
+
+	explicit VolumeGenerator(const FastNoiseLite& settings, SimdLevel level = detectSimdLevel());
+	~VolumeGenerator() = default;
+	VolumeGenerator(const VolumeGenerator&) = delete;
+	VolumeGenerator(VolumeGenerator&&) = delete;
+	void operator=(const VolumeGenerator&) = delete;
+	void operator=(VolumeGenerator&&) = delete;
+
+	// xSize * ySize * zSize floats, x fastest then y then z, sample taken at ((xStart + x) * step, ...)
+	void generate(util::ThreadPool& pool, float* noiseOut, int xStart, int yStart, int zStart, int xSize, int ySize, int zSize, float step = 1.0f);
+
+	// Hands the slices to cb one at a time in increasing z, on the calling thread. The pool fills the
+	// next batch of slices while cb consumes the current one, at most sliceBudget() slices are resident.
+	// If cb throws, generation stops and the exception propagates once the pool let go of the buffers.
+	void generateSlices(util::ThreadPool& pool, int xStart, int yStart, int zStart, int xSize, int ySize, int zSize, float step,
+						const SliceCB& cb);
+
+	// Resident slices while streaming, at least 2 (one generating, one consumed). 0 picks 2 * pool concurrency.
+	void setSliceBudget(int slices);
+	[[nodiscard]] int sliceBudget() const;
+
+	FastNoiseLite& settings();
+	[[nodiscard]] const FastNoiseLite& settings() const;
+	[[nodiscard]] SimdLevel level() const;
+
+private:
+	FastNoiseLite d_settings;
+	SimdLevel d_level = SimdLevel::Scalar;
+	int d_sliceBudget = 0;
+	std::vector<float> d_sliceBuffers; // two halves of the budget, reused between calls
+
+	// HELPERS
+	void fillSlices(util::ThreadPool& pool, float* out, int xStart, int yStart, int zStart, int xSize, int ySize, int zCount, float step);
+};
+
+} // end namespace noise
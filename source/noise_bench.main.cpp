@@ -0,0 +1,473 @@
+#include <spdlog/spdlog.h>
+#include <Corrade/Utility/Arguments.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#define NOISE_BENCH_X86 1
+#endif
+
+#include "engine/fast_noise.h"
+#include "engine/fast_noise_simd.h"
+#include "engine/thread_pool.h"
+
+// Throughput of every noise type x fractal type x octave count, 2D and 3D, on one thread and on
+// the whole pool, for the scalar path and every vector kernel the CPU runs. 2D also runs domain
+// warped sampling ("2d-warp/...") behind a 3 octave progressive OpenSimplex2 warp.
+//
+// Results are written as JSON, one record per line inside "results" so the compare mode (and
+// diff tools) can read them without a JSON library:
+//   noise_bench --output baseline.json
+//   noise_bench --output current.json --compare baseline.json --threshold 0.1
+// Compare exits with 1 when any configuration got slower than the threshold allows.
+
+namespace
+{
+
+struct BenchConfig
+{
+	int dims = 2;
+	FastNoiseLite::NoiseType noiseType = FastNoiseLite::NoiseType_OpenSimplex2;
+	FastNoiseLite::FractalType fractalType = FastNoiseLite::FractalType_None;
+	int octaves = 1;
+	noise::SimdLevel level = noise::SimdLevel::Scalar;
+	bool threaded = false;
+	bool warped = false; // 2D only, noise::domainWarpNoise2D on the grid positions
+
+	std::string name() const;
+};
+
+struct BenchResult
+{
+	BenchConfig config;
+	unsigned threads = 1;
+	uint64_t samples = 0;
+	double nsPerSample = 0.0;    // median over the repeats
+	double nsPerSampleMin = 0.0;
+
+	double samplesPerSec() const { return nsPerSample > 0.0 ? 1e9 / nsPerSample : 0.0; }
+};
+
+struct BenchOptions
+{
+	int size2D = 256;
+	int size3D = 32;
+	int repeat = 5;
+	std::string filter;
+};
+
+const char* noiseTypeName(FastNoiseLite::NoiseType type)
+{
+	switch (type)
+	{
+	case FastNoiseLite::NoiseType_OpenSimplex2: return "OpenSimplex2";
+	case FastNoiseLite::NoiseType_OpenSimplex2S: return "OpenSimplex2S";
+	case FastNoiseLite::NoiseType_Cellular: return "Cellular";
+	case FastNoiseLite::NoiseType_Perlin: return "Perlin";
+	case FastNoiseLite::NoiseType_ValueCubic: return "ValueCubic";
+	case FastNoiseLite::NoiseType_Value: return "Value";
+	}
+	return "Unknown";
+}
+
+const char* fractalTypeName(FastNoiseLite::FractalType type)
+{
+	switch (type)
+	{
+	case FastNoiseLite::FractalType_FBm: return "FBm";
+	case FastNoiseLite::FractalType_Ridged: return "Ridged";
+	case FastNoiseLite::FractalType_PingPong: return "PingPong";
+	default: return "None";
+	}
+}
+
+std::string BenchConfig::name() const
+{
+	std::ostringstream ss;
+	ss << dims << (warped ? "d-warp/" : "d/") << noiseTypeName(noiseType) << "/" << fractalTypeName(fractalType) << "/o" << octaves
+	   << "/" << noise::simdLevelName(level) << "/" << (threaded ? "mt" : "st");
+	return ss.str();
+}
+
+std::string cpuName()
+{
+#if defined(NOISE_BENCH_X86)
+	unsigned int regs[12] = {};
+#if defined(_MSC_VER)
+	int r[4];
+	__cpuid(r, 0x80000000);
+	if ((unsigned int)r[0] < 0x80000004)
+		return "unknown";
+	for (int i = 0; i < 3; ++i)
+	{
+		__cpuid(r, 0x80000002 + i);
+		for (int j = 0; j < 4; ++j)
+			regs[i * 4 + j] = (unsigned int)r[j];
+	}
+#else
+	if (__get_cpuid_max(0x80000000, nullptr) < 0x80000004)
+		return "unknown";
+	for (unsigned int i = 0; i < 3; ++i)
+		__get_cpuid(0x80000002 + i, &regs[i * 4 + 0], &regs[i * 4 + 1], &regs[i * 4 + 2], &regs[i * 4 + 3]);
+#endif
+	std::string name(reinterpret_cast<const char*>(regs), sizeof(regs));
+	name = name.c_str();
+	name.erase(0, name.find_first_not_of(' '));
+	return name;
+#else
+	return "unknown";
+#endif
+}
+
+std::string compilerName()
+{
+#if defined(__clang__)
+	return std::string("clang ") + __clang_version__;
+#elif defined(__GNUC__)
+	return std::string("gcc ") + __VERSION__;
+#elif defined(_MSC_VER)
+	return "msvc " + std::to_string(_MSC_VER);
+#else
+	return "unknown";
+#endif
+}
+
+std::string jsonEscape(const std::string& text)
+{
+	std::string out;
+	for (char c : text)
+	{
+		if (c == '"' || c == '\\')
+			out += '\\';
+		if ((unsigned char)c >= 0x20)
+			out += c;
+	}
+	return out;
+}
+
+std::vector<BenchConfig> buildConfigs()
+{
+	const FastNoiseLite::NoiseType noiseTypes[] = {
+		FastNoiseLite::NoiseType_OpenSimplex2,
+		FastNoiseLite::NoiseType_OpenSimplex2S,
+		FastNoiseLite::NoiseType_Cellular,
+		FastNoiseLite::NoiseType_Perlin,
+		FastNoiseLite::NoiseType_ValueCubic,
+		FastNoiseLite::NoiseType_Value,
+	};
+	const FastNoiseLite::FractalType fractalTypes[] = {
+		FastNoiseLite::FractalType_None,
+		FastNoiseLite::FractalType_FBm,
+		FastNoiseLite::FractalType_Ridged,
+		FastNoiseLite::FractalType_PingPong,
+	};
+	const int octaveCounts[] = { 3, 5, 8 };
+
+	std::vector<noise::SimdLevel> levels = { noise::SimdLevel::Scalar };
+	for (noise::SimdLevel level : { noise::SimdLevel::SSE41, noise::SimdLevel::AVX2 })
+	{
+		if (level <= noise::detectSimdLevel())
+			levels.push_back(level);
+	}
+
+	std::vector<BenchConfig> configs;
+	for (int dims : { 2, 3 })
+	for (FastNoiseLite::NoiseType noiseType : noiseTypes)
+	for (FastNoiseLite::FractalType fractalType : fractalTypes)
+	for (int octaves : octaveCounts)
+	{
+		// octaves only matter for fractals
+		if (fractalType == FastNoiseLite::FractalType_None && octaves != octaveCounts[0])
+			continue;
+
+		for (bool warped : { false, true })
+		for (noise::SimdLevel level : levels)
+		for (bool threaded : { false, true })
+		{
+			// warp cost is measured on the common terrain setups, not the full matrix
+			if (warped && (dims != 2 || (fractalType != FastNoiseLite::FractalType_None && fractalType != FastNoiseLite::FractalType_FBm)))
+				continue;
+
+			BenchConfig config;
+			config.dims = dims;
+			config.noiseType = noiseType;
+			config.fractalType = fractalType;
+			config.octaves = fractalType == FastNoiseLite::FractalType_None ? 1 : octaves;
+			config.level = level;
+			config.threaded = threaded;
+			config.warped = warped;
+
+			// a level the CPU lacks would only re-measure the scalar path
+			if (level != noise::SimdLevel::Scalar && !noise::hasSimdLevel(level))
+				continue;
+
+			configs.push_back(config);
+		}
+	}
+	return configs;
+}
+
+BenchResult runConfig(const BenchConfig& config, const BenchOptions& options, util::ThreadPool& pool)
+{
+	FastNoiseLite noise;
+	noise.SetNoiseType(config.noiseType);
+	noise.SetFractalType(config.fractalType);
+	noise.SetFractalOctaves(config.octaves);
+
+	const int size = config.dims == 2 ? options.size2D : options.size3D;
+	const int depth = config.dims == 2 ? 1 : size;
+	const size_t slice = size_t(size) * size_t(size);
+	std::vector<float> out(slice * size_t(depth));
+
+	FastNoiseLite warp;
+	warp.SetFractalType(FastNoiseLite::FractalType_DomainWarpProgressive);
+	warp.SetFractalOctaves(3);
+	warp.SetDomainWarpAmp(30.0f);
+
+	std::vector<float> xIn;
+	std::vector<float> yIn;
+	if (config.warped)
+	{
+		xIn.resize(slice);
+		yIn.resize(slice);
+		for (int y = 0; y < size; ++y)
+		{
+			for (int x = 0; x < size; ++x)
+			{
+				xIn[size_t(y) * size_t(size) + size_t(x)] = float(x);
+				yIn[size_t(y) * size_t(size) + size_t(x)] = float(y);
+			}
+		}
+	}
+
+	// rows (2D) or slices (3D) are independent, the threaded run spreads them over the pool
+	auto generate = [&]()
+	{
+		if (config.warped)
+		{
+			if (!config.threaded)
+			{
+				noise::domainWarpNoise2D(warp, noise, xIn.data(), yIn.data(), out.data(), int(slice), config.level);
+				return;
+			}
+			const size_t rows = 16;
+			pool.parallelFor((size_t(size) + rows - 1) / rows, [&](size_t index, unsigned)
+			{
+				size_t begin = index * rows * size_t(size);
+				size_t count = std::min(rows * size_t(size), slice - begin);
+				noise::domainWarpNoise2D(warp, noise, xIn.data() + begin, yIn.data() + begin, out.data() + begin, int(count), config.level);
+			});
+		}
+		else if (config.dims == 2)
+		{
+			if (!config.threaded)
+			{
+				noise::genUniformGrid2D(noise, out.data(), 0, 0, size, size, 1.0f, config.level);
+				return;
+			}
+			const int rows = 16;
+			pool.parallelFor(size_t((size + rows - 1) / rows), [&](size_t index, unsigned)
+			{
+				int y = int(index) * rows;
+				int h = std::min(rows, size - y);
+				noise::genUniformGrid2D(noise, out.data() + size_t(y) * size_t(size), 0, y, size, h, 1.0f, config.level);
+			});
+		}
+		else
+		{
+			if (!config.threaded)
+			{
+				noise::genUniformGrid3D(noise, out.data(), 0, 0, 0, size, size, depth, 1.0f, config.level);
+				return;
+			}
+			pool.parallelFor(size_t(depth), [&](size_t z, unsigned)
+			{
+				noise::genUniformGrid3D(noise, out.data() + z * slice, 0, 0, int(z), size, size, 1, 1.0f, config.level);
+			});
+		}
+	};
+
+	generate(); // warm up caches, page in the output
+
+	std::vector<double> ns;
+	for (int i = 0; i < options.repeat; ++i)
+	{
+		auto begin = std::chrono::steady_clock::now();
+		generate();
+		auto end = std::chrono::steady_clock::now();
+		ns.push_back(std::chrono::duration<double, std::nano>(end - begin).count());
+	}
+	std::sort(ns.begin(), ns.end());
+
+	BenchResult result;
+	result.config = config;
+	result.threads = config.threaded ? pool.concurrency() : 1;
+	result.samples = uint64_t(out.size());
+	result.nsPerSample = ns[ns.size() / 2] / double(result.samples);
+	result.nsPerSampleMin = ns.front() / double(result.samples);
+	return result;
+}
+
+void writeJson(std::ostream& os, const std::vector<BenchResult>& results, const BenchOptions& options, unsigned poolThreads)
+{
+	char date[32] = {};
+	std::time_t now = std::time(nullptr);
+	std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+
+	os << "{\n";
+	os << "\"machine\": {\"cpu\": \"" << jsonEscape(cpuName()) << "\", \"hardware_threads\": " << std::thread::hardware_concurrency()
+	   << ", \"pool_threads\": " << poolThreads << ", \"simd\": \"" << noise::simdLevelName(noise::detectSimdLevel())
+	   << "\", \"compiler\": \"" << jsonEscape(compilerName()) << "\", \"date\": \"" << date << "\"},\n";
+	os << "\"options\": {\"size2d\": " << options.size2D << ", \"size3d\": " << options.size3D << ", \"repeat\": " << options.repeat << "},\n";
+	os << "\"results\": [\n";
+	for (size_t i = 0; i < results.size(); ++i)
+	{
+		const BenchResult& r = results[i];
+		char numbers[160];
+		std::snprintf(numbers, sizeof(numbers), "\"ns_per_sample\": %.4f, \"ns_per_sample_min\": %.4f, \"samples_per_sec\": %.0f",
+					  r.nsPerSample, r.nsPerSampleMin, r.samplesPerSec());
+
+		os << "{\"name\": \"" << r.config.name() << "\", \"dims\": " << r.config.dims << ", \"warp\": " << (r.config.warped ? "true" : "false")
+		   << ", \"noise\": \"" << noiseTypeName(r.config.noiseType) << "\", \"fractal\": \"" << fractalTypeName(r.config.fractalType)
+		   << "\", \"octaves\": " << r.config.octaves << ", \"simd\": \"" << noise::simdLevelName(r.config.level)
+		   << "\", \"threads\": " << r.threads << ", \"samples\": " << r.samples << ", " << numbers << "}"
+		   << (i + 1 < results.size() ? ",\n" : "\n");
+	}
+	os << "]\n}\n";
+}
+
+// Reads "name" -> ns_per_sample from the records written by writeJson, one per line
+bool readBaseline(const std::string& path, std::map<std::string, double>& baseline)
+{
+	std::ifstream file(path);
+	if (!file)
+		return false;
+
+	const std::string nameKey = "\"name\": \"";
+	const std::string nsKey = "\"ns_per_sample\": ";
+
+	std::string line;
+	while (std::getline(file, line))
+	{
+		size_t name = line.find(nameKey);
+		size_t ns = line.find(nsKey);
+		if (name == std::string::npos || ns == std::string::npos)
+			continue;
+
+		name += nameKey.size();
+		size_t nameEnd = line.find('"', name);
+		if (nameEnd == std::string::npos)
+			continue;
+
+		baseline[line.substr(name, nameEnd - name)] = std::strtod(line.c_str() + ns + nsKey.size(), nullptr);
+	}
+	return true;
+}
+
+// Returns the number of regressions
+int compare(const std::vector<BenchResult>& results, const std::map<std::string, double>& baseline, double threshold)
+{
+	int regressions = 0;
+	int improvements = 0;
+	int matched = 0;
+
+	for (const BenchResult& r : results)
+	{
+		auto it = baseline.find(r.config.name());
+		if (it == baseline.end() || it->second <= 0.0)
+			continue;
+
+		matched++;
+		double ratio = r.nsPerSample / it->second;
+		if (ratio > 1.0 + threshold)
+		{
+			regressions++;
+			spdlog::warn("REGRESSION {:<48} {:8.2f} -> {:8.2f} ns/sample ({:+.1f}%)", r.config.name(), it->second, r.nsPerSample, (ratio - 1.0) * 100.0);
+		}
+		else if (ratio < 1.0 - threshold)
+		{
+			improvements++;
+			spdlog::info("improved   {:<48} {:8.2f} -> {:8.2f} ns/sample ({:+.1f}%)", r.config.name(), it->second, r.nsPerSample, (ratio - 1.0) * 100.0);
+		}
+	}
+
+	spdlog::info("compared {} of {} configurations: {} regressions, {} improvements (threshold {:.0f}%)",
+				 matched, results.size(), regressions, improvements, threshold * 100.0);
+	return regressions;
+}
+
+} // end unnamed namespace
+
+int main(int argc, char** argv)
+{
+	Corrade::Utility::Arguments args;
+	args.addOption("output", "noise_bench.json").setHelp("output", "JSON result file", "PATH")
+		.addOption("compare").setHelp("compare", "baseline JSON to flag regressions against", "PATH")
+		.addOption("threshold", "0.1").setHelp("threshold", "relative slowdown counted as a regression", "RATIO")
+		.addOption("filter").setHelp("filter", "only run configurations whose name contains this, e.g. 2d/OpenSimplex2/FBm", "TEXT")
+		.addOption("size2d", "256").setHelp("size2d", "2D grid edge in samples", "N")
+		.addOption("size3d", "32").setHelp("size3d", "3D grid edge in samples", "N")
+		.addOption("repeat", "5").setHelp("repeat", "timed runs per configuration, the median is reported", "N")
+		.addOption("threads", "0").setHelp("threads", "pool threads for the multi-threaded runs, 0 for all cores", "N")
+		.setGlobalHelp("FastNoiseLite throughput per noise configuration.")
+		.parse(argc, argv);
+
+	BenchOptions options;
+	options.size2D = std::max(1, args.value<int>("size2d"));
+	options.size3D = std::max(1, args.value<int>("size3d"));
+	options.repeat = std::max(1, args.value<int>("repeat"));
+	options.filter = args.value("filter");
+
+	util::ThreadPool pool(args.value<unsigned>("threads"));
+
+	spdlog::info("cpu: {}, {} hardware threads, simd: {}", cpuName(), std::thread::hardware_concurrency(),
+				 noise::simdLevelName(noise::detectSimdLevel()));
+
+	std::vector<BenchResult> results;
+	for (const BenchConfig& config : buildConfigs())
+	{
+		const std::string name = config.name();
+		if (!options.filter.empty() && name.find(options.filter) == std::string::npos)
+			continue;
+
+		BenchResult result = runConfig(config, options, pool);
+		spdlog::info("{:<48} {:8.2f} ns/sample {:10.2f} Msamples/s", name, result.nsPerSample, result.samplesPerSec() * 1e-6);
+		results.push_back(result);
+	}
+
+	const std::string output = args.value("output");
+	std::ofstream file(output);
+	if (!file)
+	{
+		spdlog::error("cannot write {}", output);
+		return 2;
+	}
+	writeJson(file, results, options, pool.concurrency());
+	spdlog::info("wrote {} results to {}", results.size(), output);
+
+	const std::string baselinePath = args.value("compare");
+	if (baselinePath.empty())
+		return 0;
+
+	std::map<std::string, double> baseline;
+	if (!readBaseline(baselinePath, baseline))
+	{
+		spdlog::error("cannot read baseline {}", baselinePath);
+		return 2;
+	}
+	return compare(results, baseline, args.value<double>("threshold")) > 0 ? 1 : 0;
+}
@@ -1,29 +1,123 @@
+layout(location = 0) in vec2 position; // grid coordinates inside the patch
+layout(location = 1) in vec4 patchInstance; // lower corner of the patch, grid spacing, LOD
 
 uniform mat4 uModelMat;
 uniform mat4 uCamViewProjMat;
 uniform vec3 uCamPos;
 
-uniform float uGridStepSize;
 uniform float uGridHeightBoosts;
-uniform int uGridRez;
-uniform sampler2D elevationMap;
+uniform int uTerrainMode; // 0: clipmap, 1: CDLOD
 
+// 0: float texels (R32F, R16F)
+// 1: R16 unorm, each tile decoded as min + unorm * range from its tile params
+uniform int uElevationFormat;
 
-vec2 toUV()
+// Geometry clipmap patches: the instance holds the patch's grid index in its level, the level's grid spacing in
+// world units and the level. Grid index g lies at world xz = uLevelOrigins[level] + g * spacing. uClipmapSize is
+// the vertex count along one side of a level.
+uniform vec2 uLevelOrigins[16];
+uniform int uClipmapSize;
+
+// Samples, a layer per level, addressed toroidally: grid index g is stored in texel
+// (g + uTextureOffsets[level]) mod size, so moving a level only rewrites the texels that came into view.
+// clipmapTileParams holds the R16 (min, range) of every uClipmapTileSize^2 tile of a layer.
+uniform sampler2DArray elevationMap;
+uniform ivec2 uTextureOffsets[16];
+uniform sampler2DArray clipmapTileParams;
+uniform int uClipmapTileSize;
+
+// CDLOD patches over the heightmap, sample s at world xz = s * uSampleSpacing. Each LOD's vertices morph into the
+// next coarser grid over uMorphRanges[lod] = (start, end) of camera distance. terrainHeights holds the heightmap's
+// texels, heightmapTileParams the R16 (min, range) of every uHeightmapTileSize^2 tile.
+uniform float uSampleSpacing;
+uniform vec2 uMorphRanges[16];
+uniform sampler2D terrainHeights;
+uniform sampler2D heightmapTileParams;
+uniform int uHeightmapTileSize;
+
+
+float elevation(in ivec2 grid, in int level)
+{
+	ivec2 size = textureSize(elevationMap, 0).xy;
+	ivec2 texel = (grid + uTextureOffsets[level]) & (size - 1);
+	float value = texelFetch(elevationMap, ivec3(texel, level), 0).r;
+	if (uElevationFormat == 0)
+		return value;
+
+	vec2 tile = texelFetch(clipmapTileParams, ivec3(texel / uClipmapTileSize, level), 0).rg;
+	return tile.x + value * tile.y;
+}
+
+float heightmapTexel(in ivec2 texel)
+{
+	float value = texelFetch(terrainHeights, texel, 0).r;
+	if (uElevationFormat == 0)
+		return value;
+
+	vec2 tile = texelFetch(heightmapTileParams, texel / uHeightmapTileSize, 0).rg;
+	return tile.x + value * tile.y;
+}
+
+// bilinear over decoded texels, samplePos in samples
+float terrainHeight(in vec2 samplePos)
 {
-	float u = float(gl_VertexID % uGridRez) / float(uGridRez);
-	float v = float(gl_VertexID / uGridRez) / float(uGridRez);
-	return vec2(u, 1.0f - v);
+	ivec2 size = textureSize(terrainHeights, 0);
+	vec2 pos = clamp(samplePos, vec2(0.0f), vec2(size - 1));
+	ivec2 base = min(ivec2(floor(pos)), size - 2);
+	vec2 f = pos - vec2(base);
+
+	float h00 = heightmapTexel(base);
+	float h10 = heightmapTexel(base + ivec2(1, 0));
+	float h01 = heightmapTexel(base + ivec2(0, 1));
+	float h11 = heightmapTexel(base + ivec2(1, 1));
+	return mix(mix(h00, h10, f.x), mix(h01, h11, f.x), f.y);
 }
 
-vec4 terrainGrid(in float height, in float size)
+vec3 clipmapVertex()
 {
-	float x = gl_VertexID % uGridRez * size;
-	float z = gl_VertexID / uGridRez * size;
-	return vec4(x, height, z, 1.0f);
+	int level = int(patchInstance.w);
+	float spacing = patchInstance.z;
+	ivec2 grid = ivec2(patchInstance.xy) + ivec2(position);
+	vec2 xz = uLevelOrigins[level] + vec2(grid) * spacing;
+	float height = elevation(grid, level);
+
+	// Over the outer w grid units of a level the heights blend into the next coarser level, so they match it
+	// exactly on the boundary. Coarse vertices sit on even grid indices, the odd ones lie halfway along its
+	// edges or on the diagonal of its quads.
+	float halfSize = float(uClipmapSize - 1) * 0.5f;
+	float w = float(uClipmapSize) * 0.1f;
+	vec2 fromCamera = abs(xz - uCamPos.xz) / spacing;
+	vec2 blend = clamp((fromCamera - (halfSize - w - 1.0f)) / w, 0.0f, 1.0f);
+	float alpha = max(blend.x, blend.y);
+	if (alpha > 0.0f)
+	{
+		ivec2 odd = grid & 1;
+		float coarse = 0.5f * (elevation(grid - odd, level) + elevation(grid + odd, level));
+		height = mix(height, coarse, alpha);
+	}
+
+	return vec3(xz.x, height * uGridHeightBoosts, xz.y);
+}
+
+vec3 cdlodVertex()
+{
+	vec2 corner = patchInstance.xy;
+	float spacing = patchInstance.z;
+	vec2 range = uMorphRanges[int(patchInstance.w)];
+
+	vec2 samplePos = corner + position * spacing;
+	vec3 world = vec3(samplePos.x * uSampleSpacing, terrainHeight(samplePos) * uGridHeightBoosts, samplePos.y * uSampleSpacing);
+
+	// odd vertices slide onto their even neighbour, at k = 1 the patch is the next LOD's grid and meets its patches
+	float k = clamp((distance(world, uCamPos) - range.x) / (range.y - range.x), 0.0f, 1.0f);
+	vec2 morphed = position - fract(position * 0.5f) * 2.0f * k;
+
+	samplePos = corner + morphed * spacing;
+	return vec3(samplePos.x * uSampleSpacing, terrainHeight(samplePos) * uGridHeightBoosts, samplePos.y * uSampleSpacing);
 }
 
 void main()
 {
-	gl_Position = uCamViewProjMat * uModelMat * terrainGrid(texture(elevationMap, toUV()).r * uGridHeightBoosts, uGridStepSize);
-}
\ No newline at end of file
+	vec3 world = uTerrainMode == 1 ? cdlodVertex() : clipmapVertex();
+	gl_Position = uCamViewProjMat * uModelMat * vec4(world, 1.0f);
+}
@@ -28,18 +28,29 @@
 #include <Magnum/ImageView.h>
 #include <Corrade/Containers/ArrayViewStl.h>
 #include <Magnum/PixelFormat.h>
+#include <Magnum/PixelStorage.h>
 #include <Magnum/GL/TextureFormat.h>
 #include <Magnum/GL/Texture.h>
+#include <Magnum/GL/TextureArray.h>
+#include <Magnum/GL/Context.h>
+#include <Magnum/GL/OpenGL.h>
 #include <Magnum/GL/AbstractShaderProgram.h>
 #include <Magnum/GL/Shader.h>
 #include <Magnum/GL/Version.h>
+#include <Corrade/Utility/Arguments.h>
 
 
 #include "engine/overlay.h"
 #include "engine/free_camera.h"
 #include "engine/debug_draw.h"
 #include "engine/ImGuizmo.h"
-#include "engine/fast_noise.h"
+#include "engine/heightmap_generator.h"
+#include "engine/quantized_heightmap.h"
+#include "engine/octave_layer_cache.h"
+#include "engine/height_pyramid.h"
+#include "engine/heightmap_builder.h"
+#include "engine/toroidal_clipmap.h"
+#include "engine/cdlod_quadtree.h"
 
 namespace Magnum
 {
@@ -47,9 +58,22 @@ namespace Magnum
 namespace Examples
 {
 
+// How terrain.vert places the grid vertices
+enum class TerrainMode : Int
+{
+	Clipmap = 0, // nested rings around the camera over the noise, see Clipmap
+	Cdlod = 1    // quadtree patches over the heightmap, see CdlodTerrain
+};
+
 class TerrainShader : public GL::AbstractShaderProgram
 {
 public:
+	// Per patch: lower corner, grid spacing, LOD. Clipmap patches give the corner in grid units of the level and
+	// the spacing in world units, CDLOD patches both in samples.
+	typedef GL::Attribute<1, Vector4> PatchInstance;
+
+	static constexpr int MaxLods = 16;
+
 	TerrainShader()
 	{
 		MAGNUM_ASSERT_GL_VERSION_SUPPORTED(GL::Version::GL450);
@@ -70,19 +94,33 @@ public:
 
 		d_modelMatrix = uniformLocation("uModelMat");
 		d_viewProjMatrix = uniformLocation("uCamViewProjMat");
-		d_gridRez = uniformLocation("uGridRez");
-		d_gridStepSize = uniformLocation("uGridStepSize");
+		d_levelOrigins = uniformLocation("uLevelOrigins");
+		d_textureOffsets = uniformLocation("uTextureOffsets");
+		d_clipmapSize = uniformLocation("uClipmapSize");
 		d_gridHeightBoost = uniformLocation("uGridHeightBoosts");
 		d_camPosVec3 = uniformLocation("uCamPos");
+		d_terrainMode = uniformLocation("uTerrainMode");
+		d_sampleSpacing = uniformLocation("uSampleSpacing");
+		d_morphRanges = uniformLocation("uMorphRanges");
+		d_elevationFormat = uniformLocation("uElevationFormat");
+		d_clipmapTileSize = uniformLocation("uClipmapTileSize");
+		d_heightmapTileSize = uniformLocation("uHeightmapTileSize");
 
 		setModelMatrix(glm::mat4(1.0f));
 		setViewProjectMatrix(glm::mat4(1.0f));
-		setGridRez(1);
-		setGridStepSize(1.0f);
+		setClipmapSize(1);
 		setGridElevationBoost(10.0f);
 		setCamPos(glm::vec3(0.0f));
+		setMode(TerrainMode::Clipmap);
+		setSampleSpacing(1.0f);
+		setElevationFormat(noise::HeightFormat::R32F);
+		setClipmapTileSize(1);
+		setHeightmapTileSize(1);
 
 		setUniform(uniformLocation("elevationMap"), TextureUnit);
+		setUniform(uniformLocation("terrainHeights"), HeightsUnit);
+		setUniform(uniformLocation("clipmapTileParams"), ClipmapTileParamsUnit);
+		setUniform(uniformLocation("heightmapTileParams"), HeightmapTileParamsUnit);
 	}
 
 	TerrainShader& setModelMatrix(const glm::mat4& model)
@@ -103,15 +141,19 @@ public:
 		return *this;
 	}
 
-	TerrainShader& setGridRez(uint32_t rez)
+	// Per clipmap level, at most MaxLods: world xz of its grid origin, and the texel of the origin in the level's
+	// toroidally addressed elevation layer
+	TerrainShader& setClipmapLevels(const std::vector<Vector2>& origins, const std::vector<Vector2i>& textureOffsets)
 	{
-		setUniform(d_gridRez, int(rez));
+		CORRADE_INTERNAL_ASSERT(origins.size() <= MaxLods && textureOffsets.size() == origins.size());
+		setUniform(d_levelOrigins, Containers::arrayView(origins.data(), origins.size()));
+		setUniform(d_textureOffsets, Containers::arrayView(textureOffsets.data(), textureOffsets.size()));
 		return *this;
 	}
 
-	TerrainShader& setGridStepSize(float size)
+	TerrainShader& setClipmapSize(uint32_t size)
 	{
-		setUniform(d_gridStepSize, size);
+		setUniform(d_clipmapSize, int(size));
 		return *this;
 	}
 
@@ -121,137 +163,585 @@ public:
 		return *this;
 	}
 
-	TerrainShader& bindElevationTexture(GL::Texture2D& texture) {
+	// a layer per clipmap level
+	TerrainShader& bindElevationTexture(GL::Texture2DArray& texture) {
 		texture.bind(TextureUnit);
 		return *this;
 	}
 
+	// R16 unorm texels are decoded per tile in the shader, float formats are fetched as they are
+	TerrainShader& setElevationFormat(noise::HeightFormat format)
+	{
+		setUniform(d_elevationFormat, format == noise::HeightFormat::R16Unorm ? 1 : 0);
+		return *this;
+	}
+
+	// texels along a side of a clipmap tile, and the RG32F (min, range) of each, a layer per level
+	TerrainShader& setClipmapTileSize(int size)
+	{
+		setUniform(d_clipmapTileSize, size);
+		return *this;
+	}
+
+	TerrainShader& bindClipmapTileParams(GL::Texture2DArray& texture) {
+		texture.bind(ClipmapTileParamsUnit);
+		return *this;
+	}
+
+	TerrainShader& setMode(TerrainMode mode)
+	{
+		setUniform(d_terrainMode, Int(mode));
+		return *this;
+	}
+
+	// world units between heightmap samples
+	TerrainShader& setSampleSpacing(float spacing)
+	{
+		setUniform(d_sampleSpacing, spacing);
+		return *this;
+	}
+
+	// start, end world distance of each LOD's morph into the next coarser one, at most MaxLods
+	TerrainShader& setMorphRanges(const std::vector<Vector2>& ranges)
+	{
+		CORRADE_INTERNAL_ASSERT(ranges.size() <= MaxLods);
+		setUniform(d_morphRanges, Containers::arrayView(ranges.data(), ranges.size()));
+		return *this;
+	}
+
+	// the heightmap's texels, R16 unorm ones decoded with the RG32F (min, range) of their tile
+	TerrainShader& bindHeightTexture(GL::Texture2D& texture) {
+		texture.bind(HeightsUnit);
+		return *this;
+	}
+
+	TerrainShader& setHeightmapTileSize(int size)
+	{
+		setUniform(d_heightmapTileSize, size);
+		return *this;
+	}
+
+	TerrainShader& bindHeightmapTileParams(GL::Texture2D& texture) {
+		texture.bind(HeightmapTileParamsUnit);
+		return *this;
+	}
+
 
 private:
 	Int d_modelMatrix = 0;
 	Int d_viewProjMatrix = 0;
 	Int d_camPosVec3 = 0;
-	Int d_gridRez = 0;
-	Int d_gridStepSize = 0;
+	Int d_levelOrigins = 0;
+	Int d_textureOffsets = 0;
+	Int d_clipmapSize = 0;
 	Int d_gridHeightBoost = 0;
-
-	enum : Int { TextureUnit = 0 };
+	Int d_terrainMode = 0;
+	Int d_sampleSpacing = 0;
+	Int d_morphRanges = 0;
+	Int d_elevationFormat = 0;
+	Int d_clipmapTileSize = 0;
+	Int d_heightmapTileSize = 0;
+
+	enum : Int { TextureUnit = 0, HeightsUnit = 1, ClipmapTileParamsUnit = 2, HeightmapTileParamsUnit = 3 };
 };
 
-class Clipmap
+GL::Mesh makeMesh(const std::vector<glm::vec2>& vertices, const std::vector<glm::uint16>& indices)
 {
-public:
-	Clipmap(uint32_t dim_n, uint32_t levels, float stepsize)
-	{
-		typedef GL::Attribute<0, Vector2> Position;
+	typedef GL::Attribute<0, Vector2> Position;
+
+	GL::Buffer vertexBuffer, indexBuffer;
+	vertexBuffer.setData(vertices);
+	indexBuffer.setData(indices);
+
+	GL::Mesh mesh;
+	mesh
+		.addVertexBuffer(std::move(vertexBuffer), 0, Position{})
+		.setIndexBuffer(std::move(indexBuffer), 0, MeshIndexType::UnsignedShort)
+		.setCount(indices.size())
+		.setPrimitive(MeshPrimitive::Triangles);
+	return mesh;
+}
 
-		size_t m = (dim_n + 1) / 4;
+// cols x rows vertices at integer grid positions, two counter clockwise triangles per quad seen from above
+void gridGeometry(size_t cols, size_t rows, std::vector<glm::vec2>& blockV, std::vector<glm::uint16>& blockI)
+{
+	blockV.resize(cols * rows);
+	blockI.resize((rows - 1) * 6 * (cols - 1));
 
+	for (size_t row = 0; row < rows; ++row)
+	{
+		for (size_t col = 0; col < cols; ++col)
 		{
-			// init block
-			std::vector<glm::vec2> blockV;
-			std::vector<glm::uint16> blockI;
-			blockV.resize(m * m);
-			blockI.resize((m - 1) * 6 * (m - 1));
+			blockV[row * cols + col] = glm::vec2(col, row);
+		}
+	}
 
-			for (size_t row = 0; row < m; ++row)
-			{
-				for (size_t col = 0; col < m; ++col)
-				{
-					blockV[row * m + col] = glm::vec2(col, row);
-				}
-			}
+	for (size_t row = 0; row < rows - 1; ++row)
+	{
+		for (size_t col = 0; col < cols - 1; ++col)
+		{
+			size_t id = row * cols + col;
+			size_t id_dy = (row + 1) * cols + col;
+			size_t width = 6 * (cols - 1);
 
-			for (size_t row = 0; row < m - 1; ++row)
-			{
-				for (size_t col = 0; col < m - 1; ++col)
-				{
-					size_t id = row * m + col;
-					size_t id_dy = (row + 1) * m + col;
-					size_t width = 6 * (m - 1);
+			blockI[row * width + col * 6 + 0] = id;
+			blockI[row * width + col * 6 + 1] = id_dy;
+			blockI[row * width + col * 6 + 2] = id_dy + 1;
 
-					blockI[row * width + col * 6 + 0] = id;
-					blockI[row * width + col * 6 + 1] = id_dy;
-					blockI[row * width + col * 6 + 2] = id_dy + 1;
+			blockI[row * width + col * 6 + 3] = id;
+			blockI[row * width + col * 6 + 4] = id_dy + 1;
+			blockI[row * width + col * 6 + 5] = id + 1;
+		}
+	}
+}
 
-					blockI[row * width + col * 6 + 3] = id;
-					blockI[row * width + col * 6 + 4] = id_dy + 1;
-					blockI[row * width + col * 6 + 5] = id + 1;
-				}
-			}
+GL::Mesh gridMesh(size_t cols, size_t rows, uint32_t& triangles)
+{
+	std::vector<glm::vec2> blockV;
+	std::vector<glm::uint16> blockI;
+	gridGeometry(cols, rows, blockV, blockI);
+
+	triangles = uint32_t(blockI.size() / 3);
+	return makeMesh(blockV, blockI);
+}
+
+// Upload and texture formats of the heightmap texel formats
+PixelFormat elevationPixelFormat(noise::HeightFormat format)
+{
+	if (format == noise::HeightFormat::R16Unorm)
+		return PixelFormat::R16Unorm;
+	if (format == noise::HeightFormat::R16F)
+		return PixelFormat::R16F;
+	return PixelFormat::R32F;
+}
+
+GL::TextureFormat elevationTextureFormat(noise::HeightFormat format)
+{
+	if (format == noise::HeightFormat::R16Unorm)
+		return GL::TextureFormat::R16;
+	if (format == noise::HeightFormat::R16F)
+		return GL::TextureFormat::R16F;
+	return GL::TextureFormat::R32F;
+}
+
+class Clipmap
+{
+public:
+	Clipmap(uint32_t dim_n, uint32_t levels, float stepsize, noise::HeightFormat format, noise::SimdLevel simdLevel)
+		: d_n(dim_n)
+		, d_m((dim_n + 1) / 4)
+		, d_levels(levels)
+		, d_stepSize(stepsize)
+		, d_textures(int(dim_n + 1), int(levels), format, simdLevel)
+	{
+		CORRADE_INTERNAL_ASSERT(d_m >= 2 && d_m * 4 == d_n + 1 && d_levels > 0 && d_levels <= TerrainShader::MaxLods);
+
+		// one layer per level; texels never move, the shader wraps the grid position around the level's origin texel
+		const Int size = d_textures.size();
+		d_elevation
+			.setMagnificationFilter(GL::SamplerFilter::Nearest)
+			.setMinificationFilter(GL::SamplerFilter::Nearest, GL::SamplerMipmap::Base)
+			.setWrapping(GL::SamplerWrapping::Repeat)
+			.setStorage(1, elevationTextureFormat(format), { size, size, Int(levels) });
+
+		const Int tiles = d_textures.tiles();
+		d_tileParams
+			.setMagnificationFilter(GL::SamplerFilter::Nearest)
+			.setMinificationFilter(GL::SamplerFilter::Nearest, GL::SamplerMipmap::Base)
+			.setWrapping(GL::SamplerWrapping::Repeat)
+			.setStorage(1, GL::TextureFormat::RG32F, { tiles, tiles, Int(levels) });
+
+		// every patch kind in one vertex and index buffer, the indirect commands pick their ranges
+		std::vector<glm::vec2> vertices;
+		std::vector<glm::uint16> indices;
+		std::vector<glm::vec2> patchV;
+		std::vector<glm::uint16> patchI;
+		auto addKind = [&](PatchKind kind)
+		{
+			PatchRange& range = d_ranges[kind];
+			range.count = GLuint(patchI.size());
+			range.firstIndex = GLuint(indices.size());
+			range.baseVertex = GLint(vertices.size());
+			range.triangles = uint32_t(patchI.size() / 3);
+			vertices.insert(vertices.end(), patchV.begin(), patchV.end());
+			indices.insert(indices.end(), patchI.begin(), patchI.end());
+		};
 
-			GL::Buffer blockVBuffer, blockIBuffer;
-			blockVBuffer.setData(blockV);
-			blockIBuffer.setData(blockI);
+		const size_t m = d_m;
+		const size_t extents[SeamPatch][2] = { { m, m }, { 3, m }, { m, 3 }, { 3, 3 }, { 2, 2 * m + 1 }, { 2 * m, 2 } };
+		for (int kind = 0; kind < SeamPatch; ++kind)
+		{
+			gridGeometry(extents[kind][0], extents[kind][1], patchV, patchI);
+			addKind(PatchKind(kind));
+		}
 
-			d_blockMesh
-				.addVertexBuffer(std::move(blockVBuffer), 0, Position{})
-				.setIndexBuffer(std::move(blockIBuffer), 0, MeshIndexType::UnsignedShort)
-				.setCount(blockI.size())
-				.setPrimitive(MeshPrimitive::Triangles);
+		// (i, i + 1, i + 2) for even i along each side, counter clockwise from the origin
+		const uint32_t quads = d_n - 1;
+		patchV.clear();
+		patchV.reserve(4 * quads);
+		for (uint32_t i = 0; i < quads; ++i) patchV.emplace_back(i, 0);
+		for (uint32_t i = 0; i < quads; ++i) patchV.emplace_back(quads, i);
+		for (uint32_t i = 0; i < quads; ++i) patchV.emplace_back(quads - i, quads);
+		for (uint32_t i = 0; i < quads; ++i) patchV.emplace_back(0, quads - i);
+
+		patchI.clear();
+		for (uint32_t i = 0; i < 4 * quads; i += 2)
+		{
+			patchI.push_back(glm::uint16(i));
+			patchI.push_back(glm::uint16(i + 1));
+			patchI.push_back(glm::uint16((i + 2) % (4 * quads)));
 		}
+		addKind(SeamPatch);
 
-		// init ring fix up
+		d_mesh = makeMesh(vertices, indices);
+		d_mesh.addVertexBufferInstanced(d_instanceBuffer, 1, 0, TerrainShader::PatchInstance{});
+	}
+
+	// Follows the camera, uploading only the strips of elevation that came into view, and the whole levels once a
+	// refill finished on the pool
+	void update(util::ThreadPool& pool, const glm::vec3& camPos)
+	{
+		const noise::HeightFormat format = d_textures.format();
+		d_textures.update(pool, double(camPos.x) / d_stepSize, double(camPos.z) / d_stepSize,
+						  [this, format](const noise::ToroidalClipmap::Upload& upload)
 		{
-			std::vector<glm::vec2> blockV;
-			std::vector<glm::uint16> blockI;
-			blockV.resize(m * 3);
-			blockI.resize((3 - 1) * 6 * (m - 1));
+			// 16 bit rows of odd width are not 4 byte aligned
+			ImageView3D image(PixelStorage{}.setAlignment(1), elevationPixelFormat(format), { upload.w, upload.h, 1 },
+							  { upload.texels, size_t(upload.w) * size_t(upload.h) * noise::heightFormatBytes(format) });
+			d_elevation.setSubImage(0, { upload.x, upload.y, upload.level }, image);
 
-			for (size_t row = 0; row < m; ++row)
+			if (upload.tileParams)
 			{
-				for (size_t col = 0; col < 3; ++col)
-				{
-					blockV[row * 3 + col] = glm::vec2(col, row);
-				}
+				const Int tiles = d_textures.tiles();
+				ImageView3D params(PixelFormat::RG32F, { tiles, tiles, 1 },
+								   { upload.tileParams, size_t(tiles) * size_t(tiles) * sizeof(noise::HeightTileParams) });
+				d_tileParams.setSubImage(0, { 0, 0, upload.level }, params);
 			}
+		});
+	}
 
-			for (size_t row = 0; row < m - 1; ++row)
+	// The levels are refilled with it on the pool, the ones drawn until then keep the previous noise
+	void setNoise(const FastNoiseLite& noise)
+	{
+		d_textures.setNoise(noise);
+	}
+
+	// Every visible patch of every level goes into one instance buffer, grouped by patch kind, and is drawn with a
+	// single glMultiDrawElementsIndirect call of one command per kind. Patches whose box of elevation lies outside
+	// the camera frustum are skipped when culling, heightScale turns elevation into world units.
+	void draw(TerrainShader& shader, const graphics::FreeCamera& camera, float heightScale, bool cull)
+	{
+		d_triangles = 0;
+		d_patches = 0;
+		d_culled = 0;
+		if (!ready())
+			return;
+
+		for (std::vector<glm::vec4>& instances : d_kindInstances)
+			instances.clear();
+		d_levelOrigins.clear();
+		d_textureOffsets.clear();
+
+		// patch starts along one side, in grid units of the level: 4 blocks with the fix-up between the middle two
+		const int b = int(d_m) - 1;
+		const int starts[4] = { 0, b, 2 * b + 2, 3 * b + 2 };
+		const int fixUp = 2 * b;
+		const int m = int(d_m);
+		const int n = int(d_n);
+
+		// origins come from the textures so geometry and elevation always snap alike
+		glm::ivec2 finerOrigin(0);
+		for (uint32_t level = 0; level < d_levels; ++level)
+		{
+			const int l = int(level);
+			const float scale = d_stepSize * float(1u << level);
+			const glm::ivec2 origin(d_textures.originX(l), d_textures.originY(l));
+			d_levelOrigins.emplace_back(float(origin.x) * scale, float(origin.y) * scale);
+			d_textureOffsets.emplace_back(d_textures.texelX(l), d_textures.texelY(l));
+
+			// cols x rows vertices from grid index (x, z) on
+			auto patch = [&](PatchKind kind, int x, int z, int cols, int rows)
 			{
-				for (size_t col = 0; col < 3 - 1; ++col)
+				if (cull)
 				{
-					size_t id = row * 3 + col;
-					size_t id_dy = (row + 1) * 3 + col;
-					size_t width = 6 * (3 - 1);
+					// one sample further on each side, the edge morph averages the neighbours
+					const noise::HeightBounds bounds = d_textures.regionBounds(l, origin.x + x - 1, origin.y + z - 1, cols + 2, rows + 2);
+					const glm::vec2 lo = glm::vec2(origin + glm::ivec2(x, z)) * scale;
+					const glm::vec2 hi = glm::vec2(origin + glm::ivec2(x + cols - 1, z + rows - 1)) * scale;
+					if (!camera.boxInFrustrum(glm::vec3(lo.x, bounds.min * heightScale, lo.y), glm::vec3(hi.x, bounds.max * heightScale, hi.y)))
+					{
+						d_culled++;
+						return;
+					}
+				}
 
-					blockI[row * width + col * 6 + 0] = id;
-					blockI[row * width + col * 6 + 1] = id_dy;
-					blockI[row * width + col * 6 + 2] = id_dy + 1;
+				d_kindInstances[kind].emplace_back(float(x), float(z), scale, float(level));
+				d_triangles += d_ranges[kind].triangles;
+				d_patches++;
+			};
 
-					blockI[row * width + col * 6 + 3] = id;
-					blockI[row * width + col * 6 + 4] = id_dy + 1;
-					blockI[row * width + col * 6 + 5] = id + 1;
+			for (int j = 0; j < 4; ++j)
+			{
+				for (int i = 0; i < 4; ++i)
+				{
+					const bool ring = i == 0 || i == 3 || j == 0 || j == 3;
+					if (ring || level == 0)
+						patch(BlockPatch, starts[i], starts[j], m, m);
 				}
 			}
 
-			GL::Buffer blockVBuffer, blockIBuffer;
-			blockVBuffer.setData(blockV);
-			blockIBuffer.setData(blockI);
+			patch(FixUpPatch, fixUp, starts[0], 3, m);
+			patch(FixUpPatch, fixUp, starts[3], 3, m);
+			patch(FixUpPatchH, starts[0], fixUp, m, 3);
+			patch(FixUpPatchH, starts[3], fixUp, m, 3);
 
-			d_ringFixUpMesh
-				.addVertexBuffer(std::move(blockVBuffer), 0, Position{})
-				.setIndexBuffer(std::move(blockIBuffer), 0, MeshIndexType::UnsignedShort)
-				.setCount(blockI.size())
-				.setPrimitive(MeshPrimitive::Triangles);
+			if (level == 0)
+			{
+				patch(FixUpPatch, fixUp, starts[1], 3, m);
+				patch(FixUpPatch, fixUp, starts[2], 3, m);
+				patch(FixUpPatchH, starts[1], fixUp, m, 3);
+				patch(FixUpPatchH, starts[2], fixUp, m, 3);
+				patch(CenterPatch, fixUp, fixUp, 3, 3);
+			}
+			else
+			{
+				// the finer level covers 2m - 1 of the hole's 2m quads, the trim fills the quad left on each axis.
+				// Finer origins are even, so they halve exactly into this level's grid.
+				const glm::ivec2 shift = finerOrigin / 2 - origin - b;
+				const int trimX = shift.x == 0 ? 3 * b + 1 : b;
+				const int trimZ = shift.y == 0 ? 3 * b + 1 : b;
+				patch(TrimPatch, trimX, b, 2, 2 * m + 1);
+				patch(TrimPatchH, trimX == b ? b + 1 : b, trimZ, 2 * m, 2);
+			}
+
+			if (level + 1 < d_levels)
+				patch(SeamPatch, 0, 0, n, n);
+
+			finerOrigin = origin;
 		}
 
+		d_instances.clear();
+		d_commands.clear();
+		for (int kind = 0; kind < PatchKinds; ++kind)
+		{
+			const std::vector<glm::vec4>& instances = d_kindInstances[kind];
+			if (instances.empty())
+				continue;
+
+			DrawElementsIndirectCommand command;
+			command.count = d_ranges[kind].count;
+			command.instanceCount = GLuint(instances.size());
+			command.firstIndex = d_ranges[kind].firstIndex;
+			command.baseVertex = d_ranges[kind].baseVertex;
+			command.baseInstance = GLuint(d_instances.size());
+			d_commands.push_back(command);
+			d_instances.insert(d_instances.end(), instances.begin(), instances.end());
+		}
 
+		shader
+			.setMode(TerrainMode::Clipmap)
+			.setClipmapSize(d_n)
+			.setClipmapLevels(d_levelOrigins, d_textureOffsets)
+			.setClipmapTileSize(d_textures.tileSize())
+			.bindElevationTexture(d_elevation)
+			.bindClipmapTileParams(d_tileParams);
+		if (d_commands.empty())
+			return;
+
+		d_instanceBuffer.setData(d_instances, GL::BufferUsage::StreamDraw);
+		d_commandBuffer.setData(d_commands, GL::BufferUsage::StreamDraw);
+
+		// Magnum has no indirect draws, hand the state over around the raw call
+		GL::Context::current().resetState(GL::Context::State::EnterExternal);
+		glUseProgram(shader.id());
+		glBindVertexArray(d_mesh.id());
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, d_commandBuffer.id());
+		glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_SHORT, nullptr, GLsizei(d_commands.size()), 0);
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+		glBindVertexArray(0);
+		GL::Context::current().resetState(GL::Context::State::ExitExternal);
 	}
 
-	void draw()
+	[[nodiscard]] uint32_t levels() const { return d_levels; }
+	// Nothing is drawn before the first refill finished
+	[[nodiscard]] bool ready() const { return d_textures.ready(); }
+	[[nodiscard]] bool refilling() const { return d_textures.refilling(); }
+	// Of the last draw(), which issues a single draw call
+	[[nodiscard]] uint32_t triangles() const { return d_triangles; }
+	[[nodiscard]] uint32_t patches() const { return d_patches; }
+	[[nodiscard]] uint32_t culled() const { return d_culled; }
+	// Half the side of the area covered, in world units
+	[[nodiscard]] float radius() const { return float(d_n - 1) * 0.5f * d_stepSize * float(1u << (d_levels - 1)); }
+	// Elevation samples generated on the render thread by the last update(), and all of them including refills
+	[[nodiscard]] uint64_t lastSamples() const { return d_textures.lastSamples(); }
+	[[nodiscard]] uint64_t totalSamples() const { return d_textures.totalSamples(); }
+
+private:
+	enum PatchKind
+	{
+		BlockPatch,  // m x m
+		FixUpPatch,  // 3 x m
+		FixUpPatchH, // m x 3
+		CenterPatch, // 3 x 3, finest level only
+		TrimPatch,   // 2 x (2m + 1)
+		TrimPatchH,  // 2m x 2
+		SeamPatch,   // degenerate triangles along the outer edge
+		PatchKinds
+	};
+
+	struct PatchRange
+	{
+		GLuint count = 0;
+		GLuint firstIndex = 0;
+		GLint baseVertex = 0;
+		uint32_t triangles = 0;
+	};
+
+	// layout fixed by glMultiDrawElementsIndirect
+	struct DrawElementsIndirectCommand
+	{
+		GLuint count = 0;
+		GLuint instanceCount = 0;
+		GLuint firstIndex = 0;
+		GLint baseVertex = 0;
+		GLuint baseInstance = 0;
+	};
+
+	uint32_t d_n = 0;
+	uint32_t d_m = 0;
+	uint32_t d_levels = 0;
+	float d_stepSize = 1.0f;
+
+	noise::ToroidalClipmap d_textures;
+	GL::Texture2DArray d_elevation;  // (dim_n + 1)^2 per level, in the heightmap's format
+	GL::Texture2DArray d_tileParams; // RG32F min, range per tile of d_elevation, R16 only
+
+	PatchRange d_ranges[PatchKinds];
+	GL::Buffer d_instanceBuffer; // before the mesh, which only references it
+	GL::Buffer d_commandBuffer;
+	GL::Mesh d_mesh;
+
+	// rebuilt every draw()
+	std::vector<glm::vec4> d_kindInstances[PatchKinds]; // grid x, z of the patch, level scale, level
+	std::vector<glm::vec4> d_instances;
+	std::vector<DrawElementsIndirectCommand> d_commands;
+	std::vector<Vector2> d_levelOrigins;
+	std::vector<Vector2i> d_textureOffsets;
+
+	uint32_t d_triangles = 0;
+	uint32_t d_patches = 0;
+	uint32_t d_culled = 0;
+};
+
+// CDLOD terrain over the heightmap: one grid patch mesh, drawn once per frame with an instance per selected patch
+class CdlodTerrain
+{
+public:
+	explicit CdlodTerrain(const noise::CdlodSettings& settings)
+		: d_quadtree(settings)
 	{
+		CORRADE_INTERNAL_ASSERT(settings.lodLevels <= TerrainShader::MaxLods);
+
+		const size_t quads = size_t(d_quadtree.patchQuads());
+		d_mesh = gridMesh(quads + 1, quads + 1, d_patchTriangles);
+		d_mesh
+			.addVertexBufferInstanced(d_instanceBuffer, 1, 0, TerrainShader::PatchInstance{})
+			.setInstanceCount(0);
 
+		for (int lod = 0; lod < settings.lodLevels; ++lod)
+		{
+			float start = 0.0f, end = 0.0f;
+			d_quadtree.morphRange(lod, start, end);
+			d_morphRanges.emplace_back(start, end);
+		}
 	}
 
+	// heights and tileParams are the heightmap's texels and R16 tile params. Nodes outside the camera frustum are
+	// dropped during selection when culling.
+	void draw(TerrainShader& shader, const noise::HeightPyramid& pyramid, GL::Texture2D& heights, GL::Texture2D& tileParams,
+			  const graphics::FreeCamera& camera, bool cull)
+	{
+		noise::CdlodQuadtree::VisibleCB visible;
+		if (cull)
+			visible = [&camera](const glm::vec3& min, const glm::vec3& max) { return camera.boxInFrustrum(min, max); };
+		d_quadtree.select(pyramid, camera.pos(), visible);
+
+		d_instances.clear();
+		for (const noise::CdlodPatch& patch : d_quadtree.patches())
+			d_instances.emplace_back(float(patch.x), float(patch.y), float(1 << patch.lod), float(patch.lod));
+		d_instanceBuffer.setData(d_instances, GL::BufferUsage::StreamDraw);
+		d_mesh.setInstanceCount(Int(d_instances.size()));
+
+		shader
+			.setMode(TerrainMode::Cdlod)
+			.setSampleSpacing(d_quadtree.settings().sampleSpacing)
+			.setMorphRanges(d_morphRanges)
+			.bindHeightTexture(heights)
+			.bindHeightmapTileParams(tileParams);
+		if (!d_instances.empty())
+			shader.draw(d_mesh);
+	}
 
+	[[nodiscard]] const noise::CdlodQuadtree& quadtree() const { return d_quadtree; }
+	// Of the last draw()
+	[[nodiscard]] uint32_t patches() const { return uint32_t(d_instances.size()); }
+	[[nodiscard]] uint32_t triangles() const { return patches() * d_patchTriangles; }
 
 private:
-	GL::Mesh d_blockMesh;
-	GL::Mesh d_ringFixUpMesh;
+	noise::CdlodQuadtree d_quadtree;
+	std::vector<Vector2> d_morphRanges;
+	std::vector<glm::vec4> d_instances;
+	GL::Buffer d_instanceBuffer; // before the mesh, which only references it
+	GL::Mesh d_mesh;
+	uint32_t d_patchTriangles = 0;
+};
 
 
+// Mirror of the noise settings edited in the overlay, FastNoiseLite has no getters
+struct TerrainNoiseSettings
+{
+	int seed = 1337;
+	int noiseType = FastNoiseLite::NoiseType_OpenSimplex2;
+	float frequency = 0.01f;
+
+	int fractalType = FastNoiseLite::FractalType_FBm;
+	int octaves = 5;
+	float lacunarity = 2.0f;
+	float gain = 0.6f;
+	float weightedStrength = 0.0f;
+	float pingPongStrength = 2.0f;
+
+	int cellularDistance = FastNoiseLite::CellularDistanceFunction_EuclideanSq;
+	int cellularReturn = FastNoiseLite::CellularReturnType_Distance;
+	float cellularJitter = 1.0f;
+
+	void apply(FastNoiseLite& noise) const
+	{
+		noise.SetSeed(seed);
+		noise.SetNoiseType(FastNoiseLite::NoiseType(noiseType));
+		noise.SetFrequency(frequency);
+
+		noise.SetFractalType(FastNoiseLite::FractalType(fractalType));
+		noise.SetFractalOctaves(octaves);
+		noise.SetFractalLacunarity(lacunarity);
+		noise.SetFractalGain(gain);
+		noise.SetFractalWeightedStrength(weightedStrength);
+		noise.SetFractalPingPongStrength(pingPongStrength);
+
+		noise.SetCellularDistanceFunction(FastNoiseLite::CellularDistanceFunction(cellularDistance));
+		noise.SetCellularReturnType(FastNoiseLite::CellularReturnType(cellularReturn));
+		noise.SetCellularJitter(cellularJitter);
+	}
 };
 
+// One heightmap on the GPU: the CDLOD heights, the overlay preview and the bounds pyramid
+struct ElevationTextures
+{
+	GL::Texture2D map;
+	GL::Texture2D tileParams; // RG32F min, range per heightmap tile
+	GL::Texture2D preview;    // R32F pyramid level 1 average, what the overlay shows of R16 heights
+	GL::Texture2D bounds;     // RG32F min, max mip chain of the decoded heights, from 2x2 texel blocks up
+};
 
 class TerrainExample : public Platform::Application {
 public:
@@ -271,13 +761,54 @@ private:
 	void mouseScrollEvent(MouseScrollEvent& event) override;
 	void textInputEvent(TextInputEvent& event) override;
 
+	void setNoiseBackend(noise::NoiseBackend backend, noise::SimdLevel level);
+	void regenerateHeightmap();
+	void createClipmap();
+	void createCdlod();
+	void initElevationTextures(ElevationTextures& textures);
+	void applyHeightmapBuild(std::unique_ptr<noise::HeightmapBuild> build);
+	void uploadElevation(ElevationTextures& textures);
+	void pickTerrain(const Vector2i& cursor);
+	void drawNoiseBackendUI();
+	void drawNoiseSettingsUI();
+	void drawTerrainUI();
+
 
 	std::shared_ptr<graphics::Overlay> d_overlay;
 	std::shared_ptr<graphics::FreeCamera> d_cam;
 	std::shared_ptr<graphics::DebugDraw> d_dd;
 
-	GL::Texture2D d_elevationMap;
-	GL::Mesh d_terrainMesh;
+	std::unique_ptr<util::ThreadPool> d_threadPool;
+	std::unique_ptr<noise::HeightmapBuilder> d_heightmapBuilder; // after the pool, it builds on the pool's threads
+	std::unique_ptr<noise::HeightmapBuild> d_lastBuild; // generator stats of the heightmap on screen
+	std::unique_ptr<noise::QuantizedHeightmap> d_heightmap;
+	std::unique_ptr<noise::HeightPyramid> d_heightPyramid; // min / max / average mips of d_heightmap, kept for culling and picking
+	noise::NoiseBackend d_noiseBackend = noise::NoiseBackend::Simd;
+	noise::SimdLevel d_noiseLevel = noise::SimdLevel::Scalar; // of the current backend, Scalar for the scalar one
+	bool d_octaveCache = false; // build through an octave cache so fractal edits only recombine
+	int d_heightmapDim = 512;
+	std::vector<float> d_boundsUpload; // min, max pairs of one pyramid level
+
+	uint32_t d_gridRez = 255; // clipmap vertices along one side of a level
+	int d_clipmapLevels = 5;
+	float d_gridStepSize = 1.0f; // finest clipmap spacing, also the world size of a heightmap texel
+	float d_gridHeightBoost = 10.0f;
+	bool d_hasPick = false;
+	glm::vec3 d_pick = glm::vec3(0.0f); // last right click terrain hit, world space
+
+	TerrainNoiseSettings d_noiseSettings;
+	FastNoiseLite d_clipmapNoise; // d_noiseSettings, handed to the clipmaps
+
+	// Finished builds are uploaded to the back textures and swapped in, the front ones stay untouched while
+	// frames in flight may still sample them
+	ElevationTextures d_elevation;
+	ElevationTextures d_elevationBack;
+	TerrainMode d_terrainMode = TerrainMode::Clipmap;
+	bool d_cullTerrain = true; // skip patches outside the view frustum
+	std::unique_ptr<Clipmap> d_clipmap;
+	std::unique_ptr<Clipmap> d_nextClipmap; // takes over from d_clipmap once its levels are filled
+	noise::CdlodSettings d_cdlodSettings;
+	std::unique_ptr<CdlodTerrain> d_cdlod;
 	TerrainShader d_terrainShader;
 };
 
@@ -294,77 +825,62 @@ TerrainExample::TerrainExample(const Arguments& arguments) :
 
 	using namespace Math::Literals;
 
-	// TODO: prepare terrain
-	// Create and configure FastNoise object
-	size_t dim = 512;
-	std::vector<float> noiseData(dim* dim);
-
-	FastNoiseLite noise;
-	noise.SetNoiseType(FastNoiseLite::NoiseType_OpenSimplex2);
-	noise.SetFrequency(0.01f);
-
-	noise.SetFractalType(FastNoiseLite::FractalType::FractalType_FBm);
-	noise.SetFractalOctaves(5);
-	noise.SetFractalLacunarity(2.0f);
-	noise.SetFractalGain(0.6f);
-	noise.SetFractalWeightedStrength(0.0f);
-	noise.SetFractalPingPongStrength(2.0f);
-
-	noise.SetCellularDistanceFunction(FastNoiseLite::CellularDistanceFunction::CellularDistanceFunction_EuclideanSq);
-	noise.SetCellularReturnType(FastNoiseLite::CellularReturnType::CellularReturnType_Distance);
-	noise.SetCellularJitter(1.0);
-
+	Utility::Arguments args;
+	args.addOption("noise-backend", "simd")
+		.setHelp("noise-backend", "heightmap generator: scalar, simd, sse41 or avx2", "NAME")
+		.addOption("noise-threads", "0")
+		.setHelp("noise-threads", "heightmap worker threads, 0 for all cores", "N")
+		.addOption("elevation-format", "r16")
+		.setHelp("elevation-format", "heightmap texel format: r32f, r16 (unorm, per tile range) or r16f", "FORMAT")
+		.addBooleanOption("octave-cache")
+		.setHelp("octave-cache", "keep every octave's noise so gain, weighted strength and octave edits only recombine")
+		.addOption("clipmap-levels", "5")
+		.setHelp("clipmap-levels", "nested terrain rings, each twice the size of the previous one", "N")
+		.addOption("terrain", "clipmap")
+		.setHelp("terrain", "terrain mesh: clipmap (rings around the camera over the noise) or cdlod (quadtree over the heightmap)", "MODE")
+		.addSkippedPrefix("magnum", "engine-specific options")
+		.parse(arguments.argc, arguments.argv);
+
+	noise::NoiseBackend backend = noise::NoiseBackend::Simd;
+	noise::SimdLevel simdLevel = noise::detectSimdLevel();
+	if (!noise::parseNoiseBackend(args.value("noise-backend"), backend, simdLevel))
+	{
+		spdlog::warn("unknown noise backend '{}', using simd", args.value("noise-backend"));
+	}
 
-	int index = 0;
-	for (int y = 0; y < dim; y++)
+	noise::HeightFormat heightFormat = noise::HeightFormat::R16Unorm;
+	if (!noise::parseHeightFormat(args.value("elevation-format"), heightFormat))
 	{
-		for (int x = 0; x < dim; x++)
-		{
-			noiseData[index++] = noise.GetNoise((float)x, (float)y);
-		}
+		spdlog::warn("unknown elevation format '{}', using r16", args.value("elevation-format"));
 	}
 
-	int levels = Math::log2((int)dim) + 1;
-	ImageView2D image(PixelFormat::R32F, { (int)dim, (int)dim }, noiseData);
-	d_elevationMap
-		.setMagnificationFilter(GL::SamplerFilter::Linear)
-		.setMinificationFilter(GL::SamplerFilter::Linear, GL::SamplerMipmap::Linear)
-		.setWrapping(GL::SamplerWrapping::ClampToEdge)
-		.setMaxAnisotropy(GL::Sampler::maxMaxAnisotropy())
-		.setStorage(levels, GL::TextureFormat::R32F, { (int)dim, (int)dim })
-		.setSubImage(0, {}, image)
-		.generateMipmap();
+	d_threadPool = std::make_unique<util::ThreadPool>(args.value<unsigned>("noise-threads"));
 
-	size_t meshres = 255;
-	std::vector<uint32_t> indices((meshres - 1) * 6 * (meshres - 1));
-	for (size_t row = 0; row < meshres - 1; ++row)
-	{
-		for (size_t col = 0; col < meshres - 1; ++col)
-		{
-			size_t id = row * meshres + col;
-			size_t id_dy = (row + 1) * meshres + col;
-			size_t width = 6 * (meshres - 1);
+	size_t dim = d_heightmapDim;
 
-			indices[row * width + col * 6 + 0] = id;
-			indices[row * width + col * 6 + 1] = id_dy;
-			indices[row * width + col * 6 + 2] = id_dy + 1;
+	d_heightmap = std::make_unique<noise::QuantizedHeightmap>((int)dim, (int)dim, heightFormat);
+	d_heightPyramid = std::make_unique<noise::HeightPyramid>();
+	initElevationTextures(d_elevation);
+	initElevationTextures(d_elevationBack);
 
-			indices[row * width + col * 6 + 3] = id;
-			indices[row * width + col * 6 + 4] = id_dy + 1;
-			indices[row * width + col * 6 + 5] = id + 1;
-		}
-	}
+	d_noiseBackend = backend;
+	d_noiseLevel = backend == noise::NoiseBackend::Simd ? simdLevel : noise::SimdLevel::Scalar;
+	d_octaveCache = args.isSet("octave-cache");
+	d_heightmapBuilder = std::make_unique<noise::HeightmapBuilder>(*d_threadPool, (int)dim, (int)dim, heightFormat);
+	regenerateHeightmap();
+
+	d_clipmapLevels = std::max(1, std::min(args.value<int>("clipmap-levels"), 16));
+	createClipmap();
+	createCdlod();
+	if (args.value("terrain") == "cdlod")
+		d_terrainMode = TerrainMode::Cdlod;
+	else if (args.value("terrain") != "clipmap")
+		spdlog::warn("unknown terrain mode '{}', using clipmap", args.value("terrain"));
 
-	GL::Buffer indexBuffer;
-	indexBuffer.setData(indices);
-	d_terrainMesh
-		.setIndexBuffer(std::move(indexBuffer), 0, MeshIndexType::UnsignedInt)
-		.setPrimitive(MeshPrimitive::Triangles)
-		.setCount(indices.size());
 	d_terrainShader
-		.setGridRez(meshres)
-		.setGridStepSize(1.0)
-		.setGridElevationBoost(10.0f);
+		.setGridElevationBoost(d_gridHeightBoost)
+		.setElevationFormat(heightFormat)
+		.setHeightmapTileSize(d_heightmap->tileSize());
 
 	graphics::FreeCameraCreateInfo1 ci;
 	ci.near = 0.1;
@@ -376,11 +892,16 @@ TerrainExample::TerrainExample(const Arguments& arguments) :
 	d_overlay->enableFPSCounter(true);
 	d_overlay->add([this, dim](graphics::Overlay& overlay)
 	{
-		ImGuiIntegration::image(d_elevationMap, { (float)dim, (float)dim });
+		drawNoiseBackendUI();
+		drawNoiseSettingsUI();
+		drawTerrainUI();
+		// R16 texels are only heights with their tile params
+		const bool decoded = d_heightmap->format() != noise::HeightFormat::R16Unorm;
+		ImGuiIntegration::image(decoded ? d_elevation.map : d_elevation.preview, { (float)dim, (float)dim });
 	});
 
 	d_dd = std::make_shared<graphics::DebugDraw>(windowSize().x(), windowSize().y());
-	d_dd->registerDraws([]() {
+	d_dd->registerDraws([this]() {
 
 		const ddMat4x4 transform = { // The identity matrix
 			1.0f, 0.0f, 0.0f, 0.0f,
@@ -391,22 +912,368 @@ TerrainExample::TerrainExample(const Arguments& arguments) :
 
 		ddVec3_In ooo = { 0.0f,0.0f,0.0f };
 		dd::axisTriad(transform, 1.0f, 10.0f);
+
+		if (d_hasPick)
+		{
+			const ddVec3 pick = { d_pick.x, d_pick.y, d_pick.z };
+			dd::cross(pick, 2.0f);
+		}
 	});
 
 }
 
+void TerrainExample::setNoiseBackend(noise::NoiseBackend backend, noise::SimdLevel level)
+{
+	// keep the noise settings, only the way they are evaluated changes
+	d_noiseBackend = backend;
+	d_noiseLevel = backend == noise::NoiseBackend::Simd ? level : noise::SimdLevel::Scalar;
+	regenerateHeightmap();
+	createClipmap();
+}
+
+void TerrainExample::regenerateHeightmap()
+{
+	// returns right away, a build still running for older settings is cancelled
+	noise::HeightmapBuildRequest request;
+	request.backend = d_noiseBackend;
+	request.level = d_noiseLevel;
+	request.octaveCache = d_octaveCache;
+	d_noiseSettings.apply(request.settings);
+	d_heightmapBuilder->request(request);
+
+	d_noiseSettings.apply(d_clipmapNoise);
+	if (d_clipmap)
+		d_clipmap->setNoise(d_clipmapNoise);
+	if (d_nextClipmap)
+		d_nextClipmap->setNoise(d_clipmapNoise);
+}
+
+void TerrainExample::createClipmap()
+{
+	// the levels are filled on the pool, the clipmap on screen stays until then
+	auto clipmap = std::make_unique<Clipmap>(d_gridRez, d_clipmapLevels, d_gridStepSize, d_heightmap->format(), d_noiseLevel);
+	clipmap->setNoise(d_clipmapNoise);
+	if (d_clipmap)
+		d_nextClipmap = std::move(clipmap);
+	else
+		d_clipmap = std::move(clipmap);
+}
+
+void TerrainExample::createCdlod()
+{
+	// ranges are in world units, heights too once boosted
+	d_cdlodSettings.sampleSpacing = d_gridStepSize;
+	d_cdlodSettings.heightScale = d_gridHeightBoost;
+	d_cdlod = std::make_unique<CdlodTerrain>(d_cdlodSettings);
+	// the sliders show the ranges and morph start the quadtree raised to stay crack free
+	d_cdlodSettings = d_cdlod->quadtree().settings();
+}
+
+void TerrainExample::initElevationTextures(ElevationTextures& textures)
+{
+	const int dim = d_heightmapDim;
+	const noise::HeightFormat heightFormat = d_heightmap->format();
+
+	if (heightFormat == noise::HeightFormat::R16Unorm)
+	{
+		// filtering or mips would blend texels of tiles with different ranges
+		textures.map
+			.setMagnificationFilter(GL::SamplerFilter::Nearest)
+			.setMinificationFilter(GL::SamplerFilter::Nearest, GL::SamplerMipmap::Base)
+			.setWrapping(GL::SamplerWrapping::ClampToEdge)
+			.setStorage(1, elevationTextureFormat(heightFormat), { dim, dim });
+
+		textures.preview
+			.setMagnificationFilter(GL::SamplerFilter::Linear)
+			.setMinificationFilter(GL::SamplerFilter::Linear, GL::SamplerMipmap::Base)
+			.setWrapping(GL::SamplerWrapping::ClampToEdge)
+			.setStorage(1, GL::TextureFormat::R32F, { dim / 2, dim / 2 });
+	}
+	else
+	{
+		int levels = Math::log2(dim) + 1;
+		textures.map
+			.setMagnificationFilter(GL::SamplerFilter::Linear)
+			.setMinificationFilter(GL::SamplerFilter::Linear, GL::SamplerMipmap::Linear)
+			.setWrapping(GL::SamplerWrapping::ClampToEdge)
+			.setMaxAnisotropy(GL::Sampler::maxMaxAnisotropy())
+			.setStorage(levels, elevationTextureFormat(heightFormat), { dim, dim });
+	}
+
+	textures.tileParams
+		.setMagnificationFilter(GL::SamplerFilter::Nearest)
+		.setMinificationFilter(GL::SamplerFilter::Nearest, GL::SamplerMipmap::Base)
+		.setWrapping(GL::SamplerWrapping::ClampToEdge)
+		.setStorage(1, GL::TextureFormat::RG32F, { d_heightmap->tilesX(), d_heightmap->tilesY() });
+
+	// min and max don't blend, every level is fetched as is
+	textures.bounds
+		.setMagnificationFilter(GL::SamplerFilter::Nearest)
+		.setMinificationFilter(GL::SamplerFilter::Nearest, GL::SamplerMipmap::Nearest)
+		.setWrapping(GL::SamplerWrapping::ClampToEdge)
+		.setStorage(Math::log2(dim), GL::TextureFormat::RG32F, { dim / 2, dim / 2 });
+}
+
+void TerrainExample::applyHeightmapBuild(std::unique_ptr<noise::HeightmapBuild> build)
+{
+	int dim = d_heightmapDim;
+	if (build->generator == "octave cache")
+	{
+		static const char* const updateNames[] = { "recombined", "extended", "rebuilt" };
+		spdlog::info("heightmap {}x{} {} {} from {} cached octaves on {} threads: {:.2f} ms, {} KiB of layers",
+					 dim, dim, noise::heightFormatName(build->heightmap->format()), updateNames[(int)build->update], build->cachedOctaves,
+					 d_threadPool->concurrency(), build->stats.lastMs, build->cacheBytes / 1024);
+	}
+	else
+	{
+		spdlog::info("heightmap {}x{} {} by {} on {} threads: {:.2f} ms, {:.1f} Msamples/s, {} KiB",
+					 dim, dim, noise::heightFormatName(build->heightmap->format()), build->generator, d_threadPool->concurrency(),
+					 build->stats.lastMs, build->stats.lastSamplesPerSec() * 1e-6, build->heightmap->byteSize() / 1024);
+	}
+	spdlog::info("height pyramid {} levels: {:.2f} ms, {} KiB, {} stale builds cancelled so far", build->pyramid->levels(),
+				 build->pyramid->lastBuildMs(), build->pyramid->byteSize() / 1024, d_heightmapBuilder->cancelledBuilds());
+
+	d_heightmap = std::move(build->heightmap);
+	d_heightPyramid = std::move(build->pyramid);
+	d_lastBuild = std::move(build);
+
+	uploadElevation(d_elevationBack);
+	std::swap(d_elevation, d_elevationBack);
+}
+
+void TerrainExample::uploadElevation(ElevationTextures& textures)
+{
+	int dim = d_heightmapDim;
+
+	// 16 bit rows of odd width are not 4 byte aligned
+	ImageView2D image(PixelStorage{}.setAlignment(1), elevationPixelFormat(d_heightmap->format()), { dim, dim },
+					  { d_heightmap->data(), d_heightmap->byteSize() });
+	textures.map.setSubImage(0, {}, image);
+
+	const std::vector<noise::HeightTileParams>& tiles = d_heightmap->tileParams();
+	ImageView2D tileImage(PixelFormat::RG32F, { d_heightmap->tilesX(), d_heightmap->tilesY() },
+						  { tiles.data(), tiles.size() * sizeof(noise::HeightTileParams) });
+	textures.tileParams.setSubImage(0, {}, tileImage);
+
+	const noise::HeightPyramid& pyramid = *d_heightPyramid;
+	// pyramid level l goes to bounds level l - 1, the heights themselves are not repeated there
+	for (int level = 1; level < pyramid.levels(); ++level)
+	{
+		const Vector2i size{ pyramid.width(level), pyramid.height(level) };
+		const size_t count = size_t(size.x()) * size_t(size.y());
+
+		// R16 texels are decoded per tile, the elevation map has no mips to replace generateMipmap() with
+		ImageView2D average(PixelStorage{}.setAlignment(1), PixelFormat::R32F, size,
+							{ pyramid.average(level), count * sizeof(float) });
+		if (d_heightmap->format() != noise::HeightFormat::R16Unorm)
+			textures.map.setSubImage(level, {}, average);
+		else if (level == 1)
+			textures.preview.setSubImage(0, {}, average);
+
+		const float* lo = pyramid.minimum(level);
+		const float* hi = pyramid.maximum(level);
+		d_boundsUpload.resize(count * 2);
+		for (size_t i = 0; i < count; ++i)
+		{
+			d_boundsUpload[i * 2 + 0] = lo[i];
+			d_boundsUpload[i * 2 + 1] = hi[i];
+		}
+
+		ImageView2D bounds(PixelFormat::RG32F, size, { d_boundsUpload.data(), d_boundsUpload.size() * sizeof(float) });
+		textures.bounds.setSubImage(level - 1, {}, bounds);
+	}
+}
+
+void TerrainExample::pickTerrain(const Vector2i& cursor)
+{
+	// cursor ray between the near and far plane, t in [0, 1]
+	const Vector2i window = windowSize();
+	const glm::vec2 ndc(2.0f * float(cursor.x()) / float(window.x()) - 1.0f, 1.0f - 2.0f * float(cursor.y()) / float(window.y()));
+	glm::vec4 nearPoint = d_cam->viewProjInv() * glm::vec4(ndc, -1.0f, 1.0f);
+	glm::vec4 farPoint = d_cam->viewProjInv() * glm::vec4(ndc, 1.0f, 1.0f);
+	const glm::vec3 origin = glm::vec3(nearPoint) / nearPoint.w;
+	const glm::vec3 dir = glm::vec3(farPoint) / farPoint.w - origin;
+
+	// World to heightmap samples: the clipmap puts noise sample (x, y) at world (x, z) = (x, y) * d_gridStepSize, so
+	// hits are found over the heightmap's [0, d_heightmapDim) samples of the terrain
+	const glm::vec3 scale(1.0f / d_gridStepSize, 1.0f / d_gridHeightBoost, 1.0f / d_gridStepSize);
+
+	float t = 0.0f;
+	d_hasPick = d_heightPyramid->raycast(origin * scale, dir * scale, 1.0f, t);
+	if (d_hasPick)
+	{
+		d_pick = origin + dir * t;
+		spdlog::info("terrain hit at ({:.2f}, {:.2f}, {:.2f})", d_pick.x, d_pick.y, d_pick.z);
+	}
+}
+
+void TerrainExample::drawNoiseBackendUI()
+{
+	struct Choice
+	{
+		const char* label;
+		noise::NoiseBackend backend;
+		noise::SimdLevel level;
+	};
+
+	static const Choice choices[] = {
+		{ "scalar", noise::NoiseBackend::Scalar, noise::SimdLevel::Scalar },
+		{ "sse4.1", noise::NoiseBackend::Simd, noise::SimdLevel::SSE41 },
+		{ "avx2", noise::NoiseBackend::Simd, noise::SimdLevel::AVX2 },
+	};
+
+	const char* current = choices[0].label;
+	for (const Choice& choice : choices)
+	{
+		if (choice.backend == d_noiseBackend && choice.level == d_noiseLevel)
+			current = choice.label;
+	}
+
+	if (ImGui::BeginCombo("noise backend", current))
+	{
+		for (const Choice& choice : choices)
+		{
+			// levels the cpu can't run would silently clamp, don't offer them
+			if (choice.level > noise::detectSimdLevel())
+				continue;
+
+			if (ImGui::Selectable(choice.label))
+				setNoiseBackend(choice.backend, choice.level);
+		}
+		ImGui::EndCombo();
+	}
+
+	if (ImGui::Button("regenerate"))
+		regenerateHeightmap();
+
+	ImGui::Text("%u threads, %d px tiles, %s, %zu KiB", d_threadPool->concurrency(), d_heightmap->tileSize(),
+				noise::heightFormatName(d_heightmap->format()), d_heightmap->byteSize() / 1024);
+	ImGui::Text("%s, %llu stale builds cancelled", d_heightmapBuilder->busy() ? "regenerating" : "up to date",
+				(unsigned long long)d_heightmapBuilder->cancelledBuilds());
+	if (!d_lastBuild)
+		return;
+
+	const noise::HeightmapStats& stats = d_lastBuild->stats;
+	ImGui::Text("%s", d_lastBuild->generator.c_str());
+	ImGui::Text("last %.2f ms, %.1f Msamples/s", stats.lastMs, stats.lastSamplesPerSec() * 1e-6);
+	ImGui::Text("avg %.1f Msamples/s over %u runs", stats.avgSamplesPerSec() * 1e-6, stats.runs);
+}
+
+void TerrainExample::drawNoiseSettingsUI()
+{
+	static const char* const noiseTypes[] = { "OpenSimplex2", "OpenSimplex2S", "Cellular", "Perlin", "ValueCubic", "Value" };
+	// the domain warp fractals only apply to DomainWarp()
+	static const char* const fractalTypes[] = { "none", "FBm", "ridged", "ping pong" };
+	static const char* const distanceFunctions[] = { "euclidean", "euclidean sq", "manhattan", "hybrid" };
+	static const char* const returnTypes[] = { "cell value", "distance", "distance 2", "distance 2 add", "distance 2 sub",
+											   "distance 2 mul", "distance 2 div" };
+
+	// no regeneration needed, the heightmap is the same either way
+	ImGui::Checkbox("octave cache", &d_octaveCache);
+
+	// every edit posts a build, the ones a drag makes before the last are cancelled
+	TerrainNoiseSettings& settings = d_noiseSettings;
+	bool changed = false;
+
+	changed |= ImGui::InputInt("seed", &settings.seed);
+	changed |= ImGui::Combo("noise type", &settings.noiseType, noiseTypes, IM_ARRAYSIZE(noiseTypes));
+	changed |= ImGui::SliderFloat("frequency", &settings.frequency, 0.001f, 0.1f, "%.4f");
+
+	changed |= ImGui::Combo("fractal type", &settings.fractalType, fractalTypes, IM_ARRAYSIZE(fractalTypes));
+	if (settings.fractalType != FastNoiseLite::FractalType_None)
+	{
+		changed |= ImGui::SliderInt("octaves", &settings.octaves, 1, 10);
+		changed |= ImGui::SliderFloat("lacunarity", &settings.lacunarity, 1.0f, 4.0f);
+		changed |= ImGui::SliderFloat("gain", &settings.gain, 0.0f, 1.0f);
+		changed |= ImGui::SliderFloat("weighted strength", &settings.weightedStrength, 0.0f, 1.0f);
+		if (settings.fractalType == FastNoiseLite::FractalType_PingPong)
+			changed |= ImGui::SliderFloat("ping pong strength", &settings.pingPongStrength, 0.0f, 4.0f);
+	}
+
+	if (settings.noiseType == FastNoiseLite::NoiseType_Cellular)
+	{
+		changed |= ImGui::Combo("distance function", &settings.cellularDistance, distanceFunctions, IM_ARRAYSIZE(distanceFunctions));
+		changed |= ImGui::Combo("return type", &settings.cellularReturn, returnTypes, IM_ARRAYSIZE(returnTypes));
+		changed |= ImGui::SliderFloat("jitter", &settings.cellularJitter, 0.0f, 1.0f);
+	}
+
+	if (changed)
+		regenerateHeightmap();
+
+	if (d_lastBuild && d_lastBuild->generator == "octave cache")
+	{
+		ImGui::Text("%d octaves cached, %zu KiB, last %.2f ms", d_lastBuild->cachedOctaves, d_lastBuild->cacheBytes / 1024,
+					d_lastBuild->stats.lastMs);
+	}
+}
+
+void TerrainExample::drawTerrainUI()
+{
+	static const char* const modes[] = { "clipmap", "cdlod" };
+	int mode = int(d_terrainMode);
+	if (ImGui::Combo("terrain", &mode, modes, IM_ARRAYSIZE(modes)))
+		d_terrainMode = TerrainMode(mode);
+	ImGui::Checkbox("frustum culling", &d_cullTerrain);
+
+	if (d_terrainMode == TerrainMode::Clipmap)
+	{
+		if (ImGui::SliderInt("clipmap levels", &d_clipmapLevels, 1, 12))
+			createClipmap();
+
+		// fixed per level, however far the terrain reaches
+		ImGui::Text("%u triangles in %u patches, %u culled, 1 draw call", d_clipmap->triangles(), d_clipmap->patches(), d_clipmap->culled());
+		ImGui::Text("%.0f units radius", d_clipmap->radius());
+		// follows camera speed, full levels are refilled on the pool
+		ImGui::Text("%llu samples generated last frame, %.1f M total", (unsigned long long)d_clipmap->lastSamples(),
+					double(d_clipmap->totalSamples()) * 1e-6);
+		ImGui::Text("%s", d_nextClipmap || d_clipmap->refilling() ? "refilling levels" : "levels up to date");
+		return;
+	}
+
+	bool changed = false;
+	changed |= ImGui::SliderInt("lod levels", &d_cdlodSettings.lodLevels, 1, 10);
+	changed |= ImGui::SliderFloat("lod 0 range", &d_cdlodSettings.firstRange, 16.0f, 512.0f, "%.0f");
+	changed |= ImGui::SliderFloat("morph start", &d_cdlodSettings.morphStart, 0.0f, 0.95f);
+	if (changed)
+		createCdlod();
+
+	// density falls with distance, the last range is the view distance
+	const noise::CdlodQuadtree& quadtree = d_cdlod->quadtree();
+	ImGui::Text("%u triangles in %u patches, 1 draw call, %d nodes visited", d_cdlod->triangles(), d_cdlod->patches(),
+				quadtree.visitedNodes());
+	ImGui::Text("%d nodes and patches culled", quadtree.culledNodes());
+	ImGui::Text("%.0f units view distance", quadtree.range(quadtree.settings().lodLevels - 1));
+}
+
 void TerrainExample::drawEvent() {
 
+	// never waits, a build still running keeps the current heightmap on screen
+	if (std::unique_ptr<noise::HeightmapBuild> build = d_heightmapBuilder->take())
+		applyHeightmapBuild(std::move(build));
+
 	GL::defaultFramebuffer.clear(GL::FramebufferClear::Color | GL::FramebufferClear::Depth);
 	GL::defaultFramebuffer.clearColor(Magnum::Color4(0, 0, 0, 0));
 
-	// TODO: render terrain
+	if (d_terrainMode == TerrainMode::Clipmap)
+	{
+		// never waits, the levels a refill has not delivered yet stay as they are
+		d_clipmap->update(*d_threadPool, d_cam->pos());
+		if (d_nextClipmap)
+		{
+			d_nextClipmap->update(*d_threadPool, d_cam->pos());
+			if (d_nextClipmap->ready())
+				d_clipmap = std::move(d_nextClipmap);
+		}
+	}
+
 	GL::Renderer::setPolygonMode(GL::Renderer::PolygonMode::Line);
 	d_terrainShader
 		.setViewProjectMatrix(d_cam->viewProj())
-		.bindElevationTexture(d_elevationMap)
-		.setCamPos(d_cam->pos())
-		.draw(d_terrainMesh);
+		.setCamPos(d_cam->pos());
+	if (d_terrainMode == TerrainMode::Clipmap)
+		d_clipmap->draw(d_terrainShader, *d_cam, d_gridHeightBoost, d_cullTerrain);
+	else
+		d_cdlod->draw(d_terrainShader, *d_heightPyramid, d_elevation.map, d_elevation.tileParams, *d_cam, d_cullTerrain);
 	GL::Renderer::setPolygonMode(GL::Renderer::PolygonMode::Fill);
 
 	d_dd->updateMVP(d_cam->viewProj());
@@ -452,6 +1319,11 @@ void TerrainExample::keyReleaseEvent(KeyEvent& event)
 void TerrainExample::mousePressEvent(MouseEvent& event)
 {
 	if (d_overlay->imGuiCtx().handleMousePressEvent(event)) return;
+
+	if (event.button() == MouseEvent::Button::Right)
+	{
+		pickTerrain(event.position());
+	}
 }
 
 void TerrainExample::mouseReleaseEvent(MouseEvent& event)